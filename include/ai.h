@@ -0,0 +1,62 @@
+// 경로: include/ai.h
+// 역할: AI 수 선택(오프닝 북 → 즉시 5목/막기 → 위협 공간 탐색 → 후보 평가) 선언.
+//       현재 판(board.c)을 보고 me 쪽이 둘 수를 고르므로 서버(PVAI)와 자기 대국 도구(selfplay)가 함께 씀.
+//       난이도(탐색 예산)와 평가 가중치는 따로 넘겨, 같은 탐색으로 가중치만 바꿔 비교할 수 있음.
+
+#ifndef AI_H
+#define AI_H
+
+// AI 난이도 (MODE의 다섯 번째 값, 생략하면 AI_LEVEL_DEFAULT)
+// 레벨마다 위협 공간 탐색의 깊이/노드 상한, 한 수의 시간 예산, 레벨 전체의 CPU 할당량이 정해짐
+// - 할당량: 서버가 일정 시간 창마다 그 레벨의 AI 수 계산에 쓸 수 있는 CPU 시간(ms)
+#define AI_LEVEL_MIN        1
+#define AI_LEVEL_MAX        4
+#define AI_LEVEL_DEFAULT    3
+
+typedef struct ai_level {
+    const char *name;
+    int  vcf_depth;      // VCF 깊이 (0이면 위협 공간 탐색 안 함)
+    long vcf_nodes;
+    int  vct_depth;      // VCT 깊이 (0이면 VCT 안 함)
+    long vct_nodes;
+    int  defense_tries;  // 상대의 필승 수순을 막을 수 후보 수 (평가 점수 순)
+    long defense_nodes;  // 후보마다 다시 확인하는 탐색 노드 상한
+    int  time_ms;        // 한 수의 시간 예산
+    int  quota_ms;       // 창마다 레벨 전체 CPU 할당량
+    int  ponder_moves;   // 사람 차례에 미리 응수를 계산해 둘 사람의 예상 수 (0이면 안 함)
+} ai_level_t;
+
+extern const ai_level_t ai_levels[AI_LEVEL_MAX + 1];
+
+// 후보 평가 가중치
+typedef struct ai_eval {
+    int pattern[8];      // 패턴 종류별 점수 (pattern.h의 PAT_* 순서, 5목은 따로 처리)
+    int combo_four;      // 4-4 또는 4-3이 함께 생길 때 가산
+    int combo_three;     // 열린 3이 둘 생길 때 가산
+    int block_pct;       // 상대 패턴을 막는 점수 비율 (%)
+    int center;          // 중앙에서 거리 제곱당 감점
+    int near;            // 상대 마지막 수에서 거리 제곱당 감점
+} ai_eval_t;
+
+extern const ai_eval_t ai_eval_default;
+
+// "키=값,키=값" 형식으로 base의 가중치 일부를 바꿈 (성공 1, 모르는 키나 형식 오류 0)
+// 키: two open_two three open_three four open_four combo_four combo_three block center near
+int ai_eval_parse(ai_eval_t *e, const char *spec);
+
+// me 쪽 후보 수 생성 (기존 돌 근처의 빈칸, me에게 금수인 칸 제외, 빈 판이면 중앙 한 곳)
+// 반환: 후보 수
+int ai_candidates(int me, int cand[][2], int max);
+
+// me가 (x,y)에 둔다고 가정했을 때의 점수 ((hx,hy): 상대의 마지막 수, 없으면 -1)
+int ai_evaluate_cell(const ai_eval_t *E, int me, int x, int y, int hx, int hy);
+
+// me 쪽 후보를 ai_evaluate_cell 점수(상대 마지막 수 없이) 내림차순으로 최대 max개 골라
+// out[k] = (x, y, 점수)로 기록. 반환: 기록한 수
+int ai_rank_moves(const ai_eval_t *E, int me, int out[][3], int max);
+
+// me가 둘 수 선택 (탐색 예산은 난이도 L, 후보 평가는 가중치 E)
+void ai_choose_move(const ai_level_t *L, const ai_eval_t *E, int me, int hx, int hy,
+                    int *out_x, int *out_y);
+
+#endif
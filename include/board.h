@@ -4,7 +4,41 @@
 #ifndef BOARD_H
 #define BOARD_H
 
-#define BOARD_SIZE 15
+#include <stdint.h>
+
+#define BOARD_SIZE 15   // 기본 판 크기 (15x15 오목)
+#define BOARD_MAX  19   // 지원하는 가장 큰 판 크기 (배열 크기 기준)
+#define WIN_LEN    5    // 기본 승리 조건 (5목)
+
+// 판 크기/승리 조건 변형 (게임마다 선택)
+// 각 변형의 판정 커널은 board.c에서 크기와 길이를 상수로 둔 채 매크로로 따로 생성됨
+#define VARIANT_GOMOKU15 0   // 15x15, 5목 (기본)
+#define VARIANT_GOMOKU19 1   // 19x19, 5목
+#define VARIANT_CONNECT6 2   // 19x19, 6목
+#define VARIANT_COUNT    3
+
+// 규칙 (5목 변형에서만 렌주 선택 가능)
+#define RULE_FREESTYLE 0   // 자유룰: 누구나 5목 이상이면 승리, 금수 없음
+#define RULE_RENJU     1   // 렌주룰: 흑(P1)은 장목/4-4/3-3 금수, 정확히 5목만 승리
+
+// 판 크기와 승리 조건에 맞는 변형 번호 (지원하지 않으면 -1)
+int board_find_variant(int size, int win_len);
+
+// 변형 선택 (다음 init_board부터가 아니라 즉시 적용되므로 init_board와 함께 호출)
+// 성공:1, 잘못된 번호:0
+int board_set_variant(int variant);
+
+// 현재 변형 정보
+int board_get_variant();
+int board_get_size();
+int board_get_win_len();
+
+// 규칙 선택 (성공:1, 현재 변형에서 쓸 수 없는 규칙:0)
+int board_set_rule(int rule);
+
+// 변형 variant에서 rule을 쓸 수 있으면 1 (판을 바꾸기 전에 검사할 때)
+int board_rule_ok(int variant, int rule);
+int board_get_rule();
 
 // 오목판 초기화
 void init_board();
@@ -15,11 +49,64 @@ void print_board();
 // 돌 두기 (성공:1, 실패:0)
 int place_stone(int x, int y, int player);
 
-// 승리 판정 (해당 player가 5목이면 1, 아니면 0)
+// 마지막 수 무르기 (탐색용, 성공:1, 둔 수가 없으면 0)
+int board_undo();
+
+// 승리 판정 (해당 player가 승리 길이 이상 연속이면 1, 아니면 0)
 int check_win(int player);
 
+// (x,y) 빈칸에 player가 둔다고 가정했을 때 네 방향 중 가장 긴 연속 길이
+int board_longest_if(int x, int y, int player);
+
+// (x,y)에 player가 둔다고 가정했을 때 방향 dir(0:가로 1:세로 2:↘ 3:↗)의 라인 윈도우 인덱스
+// (pattern.h의 표를 조회하는 데 사용)
+unsigned board_line_index(int x, int y, int dir, int player);
+
+// (x,y)에 player가 둔다고 가정했을 때 네 방향의 패턴 (player에게 적용되는 규칙의 표 사용)
+void board_line_patterns(int x, int y, int player, unsigned char out[4]);
+
+// (x,y) 근처(game.h의 GAME_NEAR_DIST칸 이내)에 돌이 있으면 1 (AI 후보 칸, 수마다 갱신되므로 조회만 함)
+int board_is_near(int x, int y);
+
+// 렌주 금수 여부 (렌주룰의 흑만 해당, 그 외에는 항상 0)
+int board_is_forbidden(int x, int y, int player);
+
+// 판 전체 위협 스캔 결과 (칸마다 방향 비트, bit d = 방향 d(0:가로 1:세로 2:↘ 3:↗))
+// - five: 그 빈칸에 두면 해당 방향으로 5목 이상이 되는 방향
+// - four: 5목은 아니지만 해당 방향으로 4(한 수 더 두면 5목)가 되는 방향
+// 돌이 있는 칸은 0. 규칙은 항상 "5목 이상 승리" 기준 (렌주 흑의 장목/금수는 따로 확인)
+typedef struct threat_map {
+    unsigned char five[BOARD_MAX][BOARD_MAX];   // [y][x]
+    unsigned char four[BOARD_MAX][BOARD_MAX];   // [y][x]
+} threat_map_t;
+
+// 스캔 커널 (기본값은 CPU가 지원하는 가장 빠른 것)
+#define THREAT_IMPL_SCALAR 0
+#define THREAT_IMPL_SSE2   1
+#define THREAT_IMPL_AVX2   2
+
+// player 기준 판 전체 위협 스캔 (5목 변형에서만 지원: 성공 1, 그 외 0)
+int board_threat_scan(int player, threat_map_t *out);
+
+// 스캔 커널 강제 선택 (검증/벤치마크용, 이 CPU에서 못 쓰면 0) 및 현재 커널 조회
+int board_threat_set_impl(int impl);
+int board_threat_get_impl();
+
 //get info about stone
 int get_stone(int x, int y);
 
-#endif
+// 보드 스냅샷 (x가 행인 순서로 칸 값을 cells[size*size]에 복사)
+// 클라이언트의 my_board[x][y]와 같은 순서. 복사한 칸 수 반환
+int board_snapshot(int *cells);
+
+// 현재 국면 해시 (돌 배치 + 변형 + 규칙, 빌드/실행과 무관하게 항상 같은 값)
+// init_board 이후에만 유효. 오프닝 북 조회 키로 사용
+uint64_t board_hash();
+
+// 지금까지 놓인 수의 개수 (init_board 시 0)
+int board_move_count();
 
+// idx번째(0부터) 수의 좌표와 플레이어 조회 (성공:1, 범위 밖:0)
+int board_get_move(int idx, int *x, int *y, int *player);
+
+#endif
@@ -0,0 +1,47 @@
+// 경로: include/book.h
+// 역할: 오프닝 북(국면 해시 → 추천 수) 파일 형식과 조회 함수 선언.
+//       파일은 해시 순으로 정렬된 고정 크기 항목 배열이라 mmap 후 이진 탐색만 하면 됨.
+//       읽기 전용 공유 매핑이므로 여러 서버 프로세스가 같은 페이지 캐시를 함께 씀.
+//       북 파일은 tools/build_book이 기록된 게임(-r 게임 기록 파일)으로 만듦.
+
+#ifndef BOOK_H
+#define BOOK_H
+
+#include <stdint.h>
+
+#define BOOK_MAGIC   "OMOKBOOK"
+#define BOOK_VERSION 1
+
+// 파일 머리 (16바이트)
+typedef struct book_header {
+    char     magic[8];     // BOOK_MAGIC (NUL 없이 8바이트)
+    uint32_t version;      // BOOK_VERSION
+    uint32_t count;        // 항목 수
+} book_header_t;
+
+// 항목 (16바이트, hash 오름차순, 같은 hash는 하나만)
+typedef struct book_entry {
+    uint64_t hash;         // board_hash() 값
+    uint8_t  x, y;         // 추천 수
+    uint16_t reserved;
+    uint32_t weight;       // 기록에서 이 수를 둔 쪽이 이긴 횟수 (빌드 시 선택 기준)
+} book_entry_t;
+
+// 게임 기록 형식 (서버 -r 옵션으로 남기고 build_book이 읽음, 한 줄에 한 게임)
+//   GAME <판 크기> <승리 길이> <규칙> <승자(0: 무승부)> <x>,<y> <x>,<y> ...
+// 수는 P1부터 번갈아 둔 순서
+#define BOOK_RECORD_PREFIX "GAME"
+
+// 북 파일 열기 (성공:1, 실패:0). 이미 열려 있으면 닫고 다시 엶
+int book_open(const char *path);
+
+// 북 닫기
+void book_close();
+
+// 열린 북의 항목 수 (열려 있지 않으면 0)
+int book_size();
+
+// hash에 해당하는 추천 수 조회 (있으면 1)
+int book_lookup(uint64_t hash, int *x, int *y);
+
+#endif
@@ -0,0 +1,96 @@
+// 경로: include/client.h
+// 역할: 화면 없는 클라이언트 라이브러리 선언 (client.c, client2.c, 봇 도구가 함께 사용함).
+//       - 연결 하나 = client_t 하나 (전역 상태가 없어 한 프로세스에서 수천 개를 돌릴 수 있음)
+//       - 소켓은 비블로킹: 받은 바이트는 누적 파서가 줄 단위로 나누고, 보낼 줄은 연결별 버퍼에 쌓음
+//       - 줄마다 로컬 보드 미러(판, 턴, 수순, 승자)를 먼저 고친 뒤 콜백을 부름 (MOVE는 칸 하나만 O(1))
+//       - 호출하는 쪽이 poll 루프를 가짐: client_pollfds로 기다릴 fd를 받고, 깨어나면 client_handle
+//       - client_request_shm을 부르면 "SHM"을 보내고 SHM_OK에 딸려 온 fd로 공유 메모리 링에 붙음
+//         (shmring.h). 서버가 SHM_OFF를 보내면 그 뒤로는 다시 소켓으로 주고받음
+
+#ifndef CLIENT_H
+#define CLIENT_H
+
+#include <poll.h>
+#include "board.h"
+#include "shmring.h"
+
+#define CLIENT_SOCK_PATH "/tmp/omok.sock"
+#define CLIENT_LINE_MAX  512          // 받는 줄 하나의 최대 길이 (19x19 SYNC 줄까지)
+#define CLIENT_INBUF     4096         // 소켓에서 한 번에 읽는 양 + 덜 끝난 줄
+#define CLIENT_OUTBUF    1024         // 아직 못 보낸 명령 (넘치면 client_send가 0)
+#define CLIENT_POLLFDS   2            // 연결 하나가 기다리는 fd 수 (소켓 + 공유 메모리 eventfd)
+
+// 연결 상태
+#define CLIENT_CLOSED     0
+#define CLIENT_CONNECTING 1
+#define CLIENT_OPEN       2
+
+typedef struct client client_t;
+
+// 이벤트 콜백 (필요 없는 것은 NULL). 모두 보드 미러를 고친 뒤에 불림
+typedef struct client_callbacks {
+    void (*on_move)(client_t *c, int player, int x, int y);   // MOVE (x: 행, y: 열)
+    void (*on_turn)(client_t *c, int player);                 // TURN
+    void (*on_game_over)(client_t *c, int winner);            // GAME_OVER (승자를 모르면 0)
+    void (*on_line)(client_t *c, const char *line);           // 모든 줄 (개행 제거, 위 콜백 다음)
+} client_callbacks_t;
+
+struct client {
+    int  fd;
+    int  state;                                   // CLIENT_*
+
+    // 로컬 보드 미러 (서버가 보낸 줄만으로 유지)
+    int  board[BOARD_MAX][BOARD_MAX];             // [행][열], 0: 빈칸 1: P1 2: P2
+    int  size, win_len, rule;                     // VARIANT
+    int  player_id;                               // OK PLAYER<n> (0: 아직 없음)
+    int  turn;                                    // 현재 턴인 플레이어
+    int  move_count;                              // 반영한 수의 개수 (SYNC <n> 요청에 사용)
+    int  last_x, last_y;                          // 마지막 수 (없으면 -1)
+    int  game_over, winner;
+    int  spectating;                              // SPECTATING 수신
+    char token[32];                               // TOKEN (RESUME에 사용)
+
+    // 누적 파서 / 송신 버퍼
+    char in[CLIENT_INBUF];
+    int  in_len;
+    int  in_skip;                                 // 너무 긴 줄을 개행까지 버리는 중
+    char out[CLIENT_OUTBUF];
+    int  out_len;
+
+    // 공유 메모리 전송
+    shm_chan_t shm;
+    int  shm_on;
+    int  shm_fds[SHM_FDS];                        // SHM_OK와 함께 받은 fd (붙기 전까지, 없으면 -1)
+
+    const client_callbacks_t *cb;
+    void *user;                                   // 호출하는 쪽 데이터 (봇 상태 등)
+};
+
+// 구조체 초기화 (연결하지 않음). cb는 여러 연결이 함께 써도 됨
+void client_init(client_t *c, const client_callbacks_t *cb, void *user);
+
+// path로 비블로킹 연결 시작. 성공(또는 진행 중): 1, 실패: 0 (errno 유지)
+int client_connect(client_t *c, const char *path);
+
+// 연결을 닫음 (보드 미러와 토큰은 남겨 둠: 다시 연결해 RESUME할 수 있도록)
+void client_close(client_t *c);
+
+// printf 형식으로 명령 한 줄을 보냄 (개행은 호출하는 쪽이 붙임). 버퍼가 넘치면 0
+int client_send(client_t *c, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+// 공유 메모리 전송 요청 ("SHM"). 실패 응답(ERR SHM_UNAVAILABLE)이면 소켓을 계속 씀
+int client_request_shm(client_t *c);
+
+// 이 연결이 기다릴 fd를 p[0..]에 채움 (최대 CLIENT_POLLFDS개). 반환: 채운 수
+// 공유 메모리를 쓰는 중이면 여기서 상대에게 깨워 달라고 표시하므로, 채운 뒤에는
+// client_pending이 0일 때만 잠들고 깨어나면 반드시 client_handle을 부를 것
+int client_pollfds(client_t *c, struct pollfd *p);
+
+// 잠들지 말고 바로 처리할 데이터가 있는지 (공유 메모리 링, 시스템 호출 없음)
+int client_pending(const client_t *c);
+
+// poll 결과 처리: 받은 줄을 모두 파싱해 콜백을 부르고 밀린 명령을 보냄
+// p, n은 client_pollfds로 채운 그대로. 반환: 연결 유지 1, 끊김 0 (이미 닫힌 상태)
+int client_handle(client_t *c, const struct pollfd *p, int n);
+
+#endif
@@ -0,0 +1,47 @@
+// 경로: include/evalcache.h
+// 역할: 국면 분석(ANALYZE) 결과 캐시 선언.
+//       - 키는 국면 해시(board_hash: 돌 배치 + 변형 + 규칙)에 마지막 수를 섞은 값,
+//         값은 상위 후보 수와 점수
+//       - 키의 윗비트로 샤드를 고르고, 샤드마다 고정 크기 항목 배열 + 해시 버킷 + LRU 리스트를 둠
+//         (샤드가 가득 차면 그 샤드에서 가장 오래 안 쓴 항목을 덮어씀, 전체 메모리는 고정)
+//       - 많은 관전자가 같은 판의 같은 국면을 물어도 계산은 한 번, 나머지는 조회 한 번
+
+#ifndef EVALCACHE_H
+#define EVALCACHE_H
+
+#include <stdint.h>
+
+#define EVALCACHE_SHARD_BITS  4
+#define EVALCACHE_SHARDS      (1 << EVALCACHE_SHARD_BITS)   // 16
+#define EVALCACHE_PER_SHARD   256                           // 샤드당 항목 수 (전체 4096)
+#define EVALCACHE_BUCKETS     512                           // 샤드당 해시 버킷 수 (2의 거듭제곱)
+
+#define ANALYSIS_TOP_MAX 10   // 한 국면에 저장하는 후보 수 (요청한 N이 더 작으면 앞에서 자름)
+
+// 한 국면의 분석 결과
+typedef struct analysis {
+    int player;                       // 둘 차례 (1 또는 2)
+    int best_x, best_y;               // 위협 공간 탐색까지 한 AI의 선택
+    int count;                        // moves의 개수
+    int moves[ANALYSIS_TOP_MAX][3];   // (x, y, 평가 점수), 점수 내림차순
+} analysis_t;
+
+typedef struct evalcache_stats {
+    long hits;
+    long misses;
+    long evictions;                   // 가득 찬 샤드에서 밀려난 항목 수
+    int  entries;                     // 지금 들어 있는 항목 수
+} evalcache_stats_t;
+
+// 캐시를 비움 (처음 쓰기 전에 한 번)
+void evalcache_init();
+
+// key의 결과가 있으면 out에 복사하고 가장 최근 사용으로 옮김 (있으면 1)
+int evalcache_get(uint64_t key, analysis_t *out);
+
+// key의 결과를 저장 (이미 있으면 덮어씀, 샤드가 가득 차면 가장 오래 안 쓴 항목을 내보냄)
+void evalcache_put(uint64_t key, const analysis_t *a);
+
+void evalcache_get_stats(evalcache_stats_t *out);
+
+#endif
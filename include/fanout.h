@@ -0,0 +1,67 @@
+// 경로: include/fanout.h
+// 역할: 여러 수신자에게 같은 이벤트를 보내기 위한 공유 메시지 버퍼와
+//       연결별 송신 큐(비동기 write) 선언.
+
+#ifndef FANOUT_H
+#define FANOUT_H
+
+#include <stddef.h>
+#include <sys/uio.h>
+#include "pool.h"
+
+// 한 번만 직렬화된 이벤트 메시지 (참조 카운트로 여러 큐가 공유)
+typedef struct msgbuf {
+    int    refcnt;   // 이 버퍼를 참조하는 큐/호출자 수
+    int    cls;      // 크기 등급 (MSGBUF_CLASSES이면 풀 밖에서 malloc한 큰 버퍼)
+    size_t len;      // data 길이 (strlen은 생성 시 한 번만)
+    char   data[];   // 메시지 본문 (개행 포함)
+} msgbuf_t;
+
+// 크기 등급별 슬랩 풀 (본문 64 / 256 / 1024바이트까지, 더 크면 malloc)
+#define MSGBUF_CLASSES 3
+
+// 버퍼 생성 (refcnt = 1), 실패 시 NULL
+msgbuf_t *msgbuf_new(const char *data, size_t len);
+
+// printf 형식으로 버퍼 생성
+msgbuf_t *msgbuf_printf(const char *fmt, ...);
+
+// 참조 증가 / 감소 (0이 되면 해제)
+msgbuf_t *msgbuf_ref(msgbuf_t *m);
+void msgbuf_unref(msgbuf_t *m);
+
+// 크기 등급 k(0..MSGBUF_CLASSES-1)의 풀 (사용량 조회용)
+const pool_t *msgbuf_pool(int k);
+
+// 연결 하나의 송신 큐 크기 (이 이상 밀리면 느린 수신자로 보고 끊음)
+#define OUTQ_MAX 64
+
+// 연결별 송신 큐 (공유 버퍼 포인터의 원형 큐)
+typedef struct outq {
+    msgbuf_t *items[OUTQ_MAX];
+    int    head;     // 다음에 보낼 항목 인덱스
+    int    count;    // 큐에 쌓인 항목 수
+    size_t off;      // head 항목에서 이미 보낸 바이트 수
+} outq_t;
+
+// 큐 초기화 / 남은 항목 모두 해제
+void outq_init(outq_t *q);
+void outq_clear(outq_t *q);
+
+// 큐에 버퍼 추가 (참조 증가). 성공:1, 큐가 가득 참:0
+int outq_push(outq_t *q, msgbuf_t *m);
+
+// 큐에 쌓인 내용을 iov[OUTQ_MAX]에 채움 (첫 항목은 이미 보낸 부분 제외). 반환: iovec 수
+int outq_iov(const outq_t *q, struct iovec *iov);
+
+// 앞에서부터 n바이트를 보낸 것으로 처리 (다 보낸 버퍼는 참조 해제)
+void outq_consume(outq_t *q, size_t n);
+
+// 비블로킹 fd로 가능한 만큼 전송 (writev 한 번)
+// 반환: 남은 항목 수, 치명적 에러 시 -1
+int outq_flush(outq_t *q, int fd);
+
+// 보낼 데이터가 남아 있는지 여부
+int outq_pending(const outq_t *q);
+
+#endif
@@ -0,0 +1,67 @@
+// 경로: include/game.h
+// 역할: 한 판의 전체 상태(돌, 수순, 해시, 라인 워드, 후보 칸, 위협 스캔 격자)를 담는 구조체와
+//       수 두기/무르기 선언.
+//       - 모든 버퍼가 구조체 안에 고정 크기로 들어 있어 탐색 중 힙 할당이나 판 복사가 없음
+//       - game_make_move / game_unmake_move가 바뀐 칸 주변만 고치므로 둘 다 판 크기와 무관한 비용
+//       - board.h의 함수들은 "현재 상태"(기본은 board.c 안의 상태 하나)에 대해 동작하며,
+//         board_bind로 다른 상태를 현재 상태로 바꿀 수 있음
+
+#ifndef GAME_H
+#define GAME_H
+
+#include <stdint.h>
+#include "board.h"
+#include "pattern.h"
+#include "threat.h"
+
+// 방향별 라인 워드 개수: 한 방향의 줄 수 (대각선 기준 19 * 2 - 1)
+#define GAME_LINE_COUNT (BOARD_MAX * 2 - 1)
+
+// 후보 칸 거리: 돌에서 이 거리(칸) 이내의 빈칸이 후보
+#define GAME_NEAR_DIST 2
+
+typedef struct game_state {
+    int variant;                                  // VARIANT_*
+    int rule;                                     // RULE_*
+    int size;                                     // 판 크기 (variant에서 정해짐)
+
+    int cells[BOARD_MAX][BOARD_MAX];              // [y][x], 0: 빈칸 1: P1 2: P2
+    int move_hist[BOARD_MAX * BOARD_MAX][3];      // 수순 (x, y, player)
+    int move_count;
+
+    // 국면 해시 (돌 부분만, 변형/규칙은 game_hash에서 더함)
+    uint64_t stones_hash;
+
+    // 방향별 라인 워드: 한 줄을 칸당 2비트(0:빈칸 1:P1 2:P2 3:판 밖)로 묶은 64비트 정수
+    // - 줄 안의 위치 p(가로/대각선은 x, 세로는 y)가 비트 [2(p+PAT_HALF), +1]에 있고
+    //   양 끝 PAT_HALF칸과 판 밖 칸은 3으로 채워 둠
+    // - 수마다 네 워드만 갱신하므로 라인 윈도우 인덱스(패턴 표 조회)는 시프트와 마스크로 바로 나옴
+    //   (5목/4/3 같은 패턴 개수는 따로 세어 두지 않고, 필요한 칸에서 이 워드로 표를 조회)
+    uint64_t lines[4][GAME_LINE_COUNT];
+
+    // 칸마다 GAME_NEAR_DIST 이내에 있는 돌 수 (0보다 크면 후보 칸)
+    unsigned char near[BOARD_MAX][BOARD_MAX];
+
+    // 플레이어별 위협 스캔 격자 ([player - 1], 수마다 한 칸씩 갱신해 스캔 때 판을 펼치지 않음)
+    threat_grid_t grid[2];
+} game_state_t;
+
+// 빈 판으로 초기화 (지원하지 않는 변형/규칙이면 0)
+int game_init(game_state_t *g, int variant, int rule);
+
+// 수 두기 (판 밖이거나 돌이 있으면 0)
+int game_make_move(game_state_t *g, int x, int y, int player);
+
+// 마지막 수 무르기 (둔 수가 없으면 0)
+int game_unmake_move(game_state_t *g);
+
+// 국면 해시 (돌 배치 + 변형 + 규칙)
+uint64_t game_hash(const game_state_t *g);
+
+// board.h 함수들이 사용할 현재 상태 지정 (NULL이면 board.c의 기본 상태)
+void board_bind(game_state_t *g);
+
+// 현재 상태
+game_state_t *board_state();
+
+#endif
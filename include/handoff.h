@@ -0,0 +1,34 @@
+// 경로: include/handoff.h
+// 역할: 무중단 바이너리 교체(핫 재시작)용 프로세스 간 인계 도구 선언.
+//       - 옛 데몬이 새 바이너리를 fork + exec로 띄우고 둘 사이의 제어 소켓(socketpair)으로
+//         상태 바이트열과 열린 fd(듣기 소켓, 플레이어/관전자 연결)를 SCM_RIGHTS로 넘김
+//       - 새 프로세스는 원래 명령줄 뒤에 붙은 "-H <제어 소켓 fd>"로 인계 모드임을 앎
+//       - 연결 자체는 커널에 그대로 남아 있으므로 클라이언트는 재접속하지 않음
+
+#ifndef HANDOFF_H
+#define HANDOFF_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#define HANDOFF_OPT "-H"
+#define HANDOFF_FDS_PER_MSG 64     // 메시지 하나에 싣는 fd 수 (커널 상한 SCM_MAX_FD 253 이내)
+#define HANDOFF_TIMEOUT_MS 5000    // 새 프로세스의 준비 완료 응답을 기다리는 시간
+
+// 새 바이너리 실행: argv(이전 "-H <fd>"는 뺌) 뒤에 "-H <fd>"를 붙여 argv[0]을 exec
+// 자식은 exec 전에 제어 소켓과 표준 입출력을 뺀 fd를 모두 닫아 넘길 fd가 복제되어 남지 않게 함
+// 반환: 부모 쪽 제어 소켓 (실패 시 -1), *pid에 자식 PID
+int handoff_spawn(char *const argv[], pid_t *pid);
+
+// len 바이트를 모두 보내거나 받음 (성공:1, 실패:0)
+int handoff_send(int sock, const void *data, size_t len);
+int handoff_recv(int sock, void *data, size_t len);
+
+// fd n개를 HANDOFF_FDS_PER_MSG개씩 나눠 보내거나 받음 (성공:1, 실패:0)
+int handoff_send_fds(int sock, const int *fds, int n);
+int handoff_recv_fds(int sock, int *fds, int n);
+
+// 제어 소켓에서 한 바이트 응답을 timeout_ms까지 기다림 (받은 바이트, 실패/시간 초과 시 -1)
+int handoff_wait_ack(int sock, int timeout_ms);
+
+#endif
@@ -0,0 +1,46 @@
+// 경로: include/pattern.h
+// 역할: 한 칸을 지나는 직선 구간(라인 윈도우)을 정수 인덱스로 묶어
+//       패턴 종류(5목, 열린 4, 3 등)를 표 한 번 조회로 판정하기 위한 선언.
+
+#ifndef PATTERN_H
+#define PATTERN_H
+
+// 라인 윈도우: 기준 칸 좌우로 PAT_HALF칸씩, 기준 칸 자신은 제외 (기준 칸에는 돌을 둔다고 가정)
+// 칸당 2비트 → 10칸 × 2비트 = 20비트 인덱스
+// 비트 배치: 칸 i(0..9)가 비트 [2i, 2i+1], i=0..4는 오프셋 -5..-1, i=5..9는 +1..+5
+#define PAT_HALF       5
+#define PAT_CELLS      (PAT_HALF * 2)
+#define PAT_INDEX_BITS (PAT_CELLS * 2)
+#define PAT_TABLE_SIZE (1 << PAT_INDEX_BITS)
+
+// 윈도우 칸 값 (기준 칸의 돌을 둔 플레이어 기준)
+#define PC_EMPTY 0
+#define PC_OWN   1
+#define PC_OPP   2
+#define PC_WALL  3   // 판 밖 (막힌 칸으로 취급)
+
+// 패턴 종류 (하위 3비트, 숫자가 클수록 강함)
+#define PAT_NONE       0
+#define PAT_TWO        1   // 한 수 더 두면 막힌 3
+#define PAT_OPEN_TWO   2   // 한 수 더 두면 열린 3
+#define PAT_THREE      3   // 막힌 3 (한 수 더 두면 4)
+#define PAT_OPEN_THREE 4   // 열린 3 (한 수 더 두면 열린 4)
+#define PAT_FOUR       5   // 4 (한 수 더 두면 5목)
+#define PAT_OPEN_FOUR  6   // 열린 4 (막을 수 없는 4)
+#define PAT_FIVE       7   // 5목 (승리)
+#define PAT_TYPE_MASK  0x07
+
+// 추가 플래그
+#define PAT_OVERLINE    0x08  // 6목 이상 (정확히 5목 규칙에서만 설정, 종류는 PAT_NONE)
+#define PAT_DOUBLE_FOUR 0x10  // 한 줄 안에 4가 두 개 (X_XXX_X 같은 모양)
+
+// 5목 판정 규칙별 표 (빌드 시 tools/gen_patterns가 src/pattern_table.c로 생성)
+// - pattern_free:  5목 이상이면 승리 (자유룰, 렌주룰의 백)
+// - pattern_exact: 정확히 5목만 승리, 6목 이상은 장목 (렌주룰의 흑)
+extern const unsigned char pattern_free[PAT_TABLE_SIZE];
+extern const unsigned char pattern_exact[PAT_TABLE_SIZE];
+
+// 표 계산 (생성기에서만 사용, exact: 1이면 정확히 5목 규칙)
+void pattern_build(unsigned char *table, int exact);
+
+#endif
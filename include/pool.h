@@ -0,0 +1,69 @@
+// 경로: include/pool.h
+// 역할: 고정 크기 객체 슬랩 풀과 게임별 아레나 선언.
+//       연결/게임/메시지처럼 자주 생기고 사라지는 객체를 매번 malloc/free하지 않기 위해 사용.
+//       - 풀: 객체 여러 개를 담은 슬랩 단위로만 메모리를 얻고, 해제한 객체는 자유 목록에 돌려놓음
+//             (슬랩은 돌려주지 않으므로 최대 사용량까지 늘어난 뒤에는 할당이 일어나지 않음)
+//             ctor는 슬랩을 만들 때 객체마다 한 번만 불리고, 해제/재할당 사이에 객체 내용이 유지됨
+//       - 아레나: 포인터만 앞으로 옮기는 할당. 개별 해제 없이 reset으로 한꺼번에 비우며
+//                 청크는 유지하므로 같은 크기의 게임을 반복해도 새 메모리를 얻지 않음
+
+#ifndef POOL_H
+#define POOL_H
+
+#include <stddef.h>
+
+typedef struct pool_slot pool_slot_t;
+typedef struct pool_slab pool_slab_t;
+
+typedef struct pool {
+    const char  *name;        // STATS 표시용
+    size_t       obj_size;
+    size_t       slot_size;   // 객체 + 자유 목록 링크 (정렬 포함)
+    int          per_slab;    // 슬랩 하나의 객체 수
+    int          max_objs;    // 객체 수 상한 (0이면 무제한)
+    void       (*ctor)(void *obj);
+    pool_slab_t *slabs;
+    pool_slot_t *free_list;
+    int          capacity;    // 슬랩으로 만든 객체 수
+    int          in_use;
+    int          peak;
+    size_t       bytes;       // 슬랩이 차지하는 전체 바이트
+} pool_t;
+
+// 풀 초기화 (메모리는 첫 pool_alloc 때 얻음, ctor는 NULL 가능)
+void pool_init(pool_t *p, const char *name, size_t obj_size, int per_slab, int max_objs,
+               void (*ctor)(void *obj));
+
+// 객체 할당 (상한에 닿았거나 메모리가 없으면 NULL)
+void *pool_alloc(pool_t *p);
+
+// 객체 반납 (NULL이면 아무 것도 안 함)
+void pool_free(pool_t *p, void *obj);
+
+// 슬랩까지 모두 해제 (종료 시)
+void pool_destroy(pool_t *p);
+
+typedef struct arena_chunk arena_chunk_t;
+
+typedef struct arena {
+    arena_chunk_t *head;      // 첫 청크 (reset 후 여기부터 다시 사용)
+    arena_chunk_t *cur;       // 지금 할당 중인 청크
+    size_t         chunk_size;
+    size_t         used;      // 이번 게임에서 할당한 바이트
+    size_t         capacity;  // 청크 전체 바이트
+    size_t         peak;      // reset 사이 used의 최댓값
+} arena_t;
+
+// 아레나 초기화 (메모리는 첫 할당 때 얻음)
+void arena_init(arena_t *a, size_t chunk_size);
+
+// size 바이트 할당 (8바이트 정렬, 실패 시 NULL). 청크보다 큰 요청은 그 크기의 청크를 새로 만듦
+void *arena_alloc(arena_t *a, size_t size);
+
+// 할당한 것 전체를 한 번에 비움 (청크는 유지)
+void arena_reset(arena_t *a);
+
+// 청크까지 모두 해제
+void arena_destroy(arena_t *a);
+
+#endif
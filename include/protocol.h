@@ -9,6 +9,12 @@
 #define CMD_EXIT    3
 #define CMD_RESTART 4
 #define CMD_MODE 5
+#define CMD_SPECTATE 6
+#define CMD_SYNC 7
+#define CMD_RESUME 8
+#define CMD_STATS 9
+#define CMD_SHM 10
+#define CMD_ANALYZE 11
 
 int parse_command(const char* msg);
 
@@ -0,0 +1,53 @@
+// 경로: include/ratelimit.h
+// 역할: 연결별 명령 속도 제한(토큰 버킷) 선언.
+//       - 연결마다 분류별 버킷을 두고, 명령 한 줄마다 "모든 명령" 버킷과 그 명령 분류의 버킷에서
+//         토큰 하나씩을 씀. 토큰은 초당 per_sec개씩 burst개까지 다시 참
+//       - 토큰이 없으면 명령을 처리하지 않고 거절하며, 거절도 "strike" 버킷에서 토큰을 씀.
+//         strike 토큰까지 다 쓴(계속 몰아 보내는) 연결은 끊음
+//       - 토큰은 1/1000개 단위 정수로 셈 (경과 ms × 초당 개수), 시계 조회 외에 시스템 호출 없음
+
+#ifndef RATELIMIT_H
+#define RATELIMIT_H
+
+#include <stdint.h>
+
+// 분류
+#define RATE_ALL      0   // 모든 명령
+#define RATE_MOVE     1   // MOVE (PVAI에서는 AI 수 계산까지)
+#define RATE_ANALYZE  2   // ANALYZE
+#define RATE_STATS    3   // STATS
+#define RATE_SYNC     4   // SYNC
+#define RATE_STRIKE   5   // 거절당한 명령 (다 쓰면 연결 끊음)
+#define RATE_CLASSES  6
+
+typedef struct rate_limit {
+    const char *name;    // -L 옵션의 키
+    int per_sec;         // 초당 다시 차는 토큰 수 (0이면 제한 없음)
+    int burst;           // 버킷 크기
+} rate_limit_t;
+
+// 분류별 한도 (기본값, rate_parse로 바꿈)
+extern rate_limit_t rate_limits[RATE_CLASSES];
+
+typedef struct rate_bucket {
+    int64_t  tokens;     // 남은 토큰 × 1000
+    uint64_t last_ms;    // 마지막으로 채운 시각 (0이면 아직 쓰지 않은 가득 찬 버킷)
+} rate_bucket_t;
+
+// 연결 하나의 상태
+typedef struct rate_state {
+    rate_bucket_t b[RATE_CLASSES];
+    int blocked;         // strike를 다 써서 끊는 중이면 1 (남은 명령은 모두 버림)
+} rate_state_t;
+
+// 새 연결: 모든 버킷을 가득 채운 상태로
+void rate_reset(rate_state_t *s);
+
+// 분류 cls의 버킷에서 토큰 하나를 씀 (있으면 1, 없으면 0, 제한 없는 분류는 항상 1)
+int rate_take(rate_state_t *s, int cls, uint64_t now_ms);
+
+// "off" 또는 "키=초당개수/버킷크기,..." 형식으로 한도 변경 (성공 1, 모르는 키나 형식 오류 0)
+// 키: all move analyze stats sync strike
+int rate_parse(const char *spec);
+
+#endif
@@ -0,0 +1,21 @@
+// 경로: include/render.h
+// 역할: 클라이언트 오목판 화면 출력(차분 렌더러) 선언. client.c와 client2.c가 함께 사용함.
+//       - 판은 화면 맨 위에 고정하고, 그 아래 줄들만 스크롤 영역으로 두어 안내 메시지가 판을 밀어내지 않음
+//       - 직전 화면을 기억해 두고 바뀐 칸만 커서 이동 + 글자 하나로 다시 그림
+//       - 한 화면 분량의 출력을 버퍼 하나에 모아 write 한 번으로 내보냄
+//       - 처음, 판 크기나 터미널 높이가 바뀌었을 때, render_invalidate 뒤에는 전체를 다시 그림
+//         (터미널이 판 + 안내 줄을 담기에 낮으면 스크롤 영역 없이 매번 전체를 그림)
+
+#ifndef RENDER_H
+#define RENDER_H
+
+#include "board.h"
+
+// board[행][열] (0: 빈칸, 1: P1 'O', 2: P2 'X')의 앞 size x size를 화면에 반영
+// footer는 판 아래 고정 줄에 표시할 안내 문구
+void render_board(int board[BOARD_MAX][BOARD_MAX], int size, const char *footer);
+
+// 다음 render_board에서 전체를 다시 그림 (화면이 다른 출력으로 덮였을 때)
+void render_invalidate();
+
+#endif
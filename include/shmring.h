@@ -0,0 +1,85 @@
+// 경로: include/shmring.h
+// 역할: 같은 호스트의 봇 클라이언트용 공유 메모리 전송 선언. 서버와 클라이언트가 함께 사용함.
+//       - 클라이언트가 유닉스 소켓으로 "SHM"을 보내면 서버가 "SHM_OK <링 크기>" 줄과 함께
+//         memfd 하나와 eventfd 두 개를 SCM_RIGHTS로 넘김
+//       - memfd에는 방향별 단일 생산자/단일 소비자 바이트 링 두 개 (up: 클라이언트 → 서버, down: 반대)
+//       - 링에는 텍스트 프로토콜 줄을 그대로 씀 (명령/이벤트 의미는 소켓과 같음)
+//       - 소비자는 잠들기 전에만 waiting을 세우고, 생산자는 그때만 eventfd로 깨움
+//         (서로 바쁘게 오가는 동안에는 시스템 호출 없이 메모리만 읽고 씀)
+//       - 소켓은 연결 유지 확인용으로 계속 열어 둠 (소켓이 끊기면 채널도 닫힘)
+//       - 서버가 채널을 닫을 때는 링에 "SHM_OFF"를 남기고, 클라이언트는 이후 소켓으로 주고받음
+
+#ifndef SHMRING_H
+#define SHMRING_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define SHM_RING_SIZE (64 * 1024)    // 방향별 링 크기 (2의 거듭제곱)
+#define SHM_LINE_MAX  512            // 링에서 꺼내는 줄 하나의 최대 길이
+#define SHM_FDS       3              // 넘기는 fd 수: memfd, up eventfd, down eventfd
+
+// 방향 하나의 링 (생산자가 쓰는 값과 소비자가 쓰는 값을 다른 캐시 줄에 둠)
+typedef struct shm_ring {
+    uint32_t head;                   // 소비자: 다음에 읽을 위치 (계속 증가, 링 크기로 나눈 나머지가 실제 위치)
+    uint32_t waiting;                // 소비자: 1이면 잠들었으니 eventfd로 깨워 달라는 뜻
+    char     pad1[56];
+    uint32_t tail;                   // 생산자: 다음에 쓸 위치
+    char     pad2[60];
+    char     data[SHM_RING_SIZE];
+} shm_ring_t;
+
+// memfd에 올라가는 전체 영역
+typedef struct shm_area {
+    uint32_t   magic;
+    uint32_t   version;
+    char       pad[56];
+    shm_ring_t up;                   // 클라이언트 → 서버 (명령)
+    shm_ring_t down;                 // 서버 → 클라이언트 (응답, 이벤트)
+} shm_area_t;
+
+// 한쪽 끝에서 본 채널
+typedef struct shm_chan {
+    shm_area_t *area;
+    shm_ring_t *tx;                  // 내가 쓰는 링
+    shm_ring_t *rx;                  // 내가 읽는 링
+    int         tx_efd;              // 상대를 깨우는 eventfd
+    int         rx_efd;              // 내가 기다리는 eventfd
+    long        wakeups;             // 상대를 깨운 횟수
+} shm_chan_t;
+
+// 서버: 채널 만들기. fds[SHM_FDS]에 상대에게 넘길 fd (memfd는 넘긴 뒤 닫아도 됨)
+int shm_chan_create(shm_chan_t *c, int fds[SHM_FDS]);
+
+// 클라이언트: 받은 fd로 채널 붙이기 (memfd는 여기서 닫음)
+int shm_chan_attach(shm_chan_t *c, int fds[SHM_FDS]);
+
+void shm_chan_close(shm_chan_t *c);
+
+// 소켓으로 줄 하나와 fd들을 한 메시지로 보냄 / 받음 (받는 쪽은 줄 끝까지 읽음)
+int shm_send_fds(int sock, const char *line, const int *fds, int n);
+int shm_recv_fds(int sock, char *line, size_t size, int *fds, int n);
+
+// 링에 len바이트를 씀 (자리가 모자라면 아무것도 쓰지 않고 0)
+int shm_write(shm_chan_t *c, const char *data, size_t len);
+
+// 링에서 줄 하나를 꺼냄 (개행 포함, NUL로 끝냄). 완성된 줄이 없으면 0
+// size - 1바이트보다 긴 줄은 개행 없는 앞 조각부터 차례로 꺼냄 (이어 붙이기는 호출자 몫)
+// 상대가 쓰는 tail이 말이 안 되면 -1 (채널을 닫아야 함)
+int shm_read_line(shm_chan_t *c, char *buf, size_t size);
+
+// 읽을 데이터가 있는지 (시스템 호출 없음)
+int shm_pending(const shm_chan_t *c);
+
+// 잠들기 전 호출: waiting을 세우고 링이 비어 있으면 1 (0이면 자지 말고 바로 읽어야 함)
+// 깨어나면 shm_wait_done으로 waiting을 내림
+int shm_wait_prepare(shm_chan_t *c);
+void shm_wait_done(shm_chan_t *c);
+
+// rx_efd의 신호를 비움 (읽을 수 있다고 알려졌을 때만 호출)
+void shm_clear_signal(shm_chan_t *c);
+
+// 데이터가 올 때까지 최대 timeout_ms 기다림 (-1: 무한). 읽을 것이 있으면 1
+int shm_wait(shm_chan_t *c, int timeout_ms);
+
+#endif
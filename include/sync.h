@@ -0,0 +1,22 @@
+// 경로: include/sync.h
+// 역할: 보드 상태를 한 줄 텍스트로 압축/복원하는 코덱 선언.
+//       서버(SYNC 응답, 관전자 스냅샷)와 클라이언트(재접속 시 보드 복원)가 함께 사용함.
+
+#ifndef SYNC_H
+#define SYNC_H
+
+// 인코딩 형식
+// - 칸 값(0: 빈칸, 1: P1, 2: P2)을 같은 값의 연속 구간(run)으로 묶음
+// - run 하나 = 6비트 = (값 2비트 << 4) | (길이-1, 4비트) → base64 문자 1개
+// - 16칸보다 긴 run은 여러 문자로 나눔
+// 빈 15x15 판은 15글자, 일반적인 중반 판도 수십 글자 수준
+
+// cells[0..n-1]을 out에 인코딩 (NUL 포함 size 바이트 이내)
+// 성공 시 기록한 글자 수, 버퍼 부족 시 -1
+int sync_encode(const int *cells, int n, char *out, int size);
+
+// in을 cells[0..n-1]로 복원 (공백/개행/NUL에서 멈춤)
+// 정확히 n칸이 복원되면 1, 형식 오류면 0
+int sync_decode(const char *in, int *cells, int n);
+
+#endif
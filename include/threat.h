@@ -0,0 +1,34 @@
+// 경로: include/threat.h
+// 역할: 판 전체 위협 스캔 커널(스칼라/SSE2/AVX2) 선언. board.c에서만 사용 (격자는 game_state_t에 들어 있음).
+//       판을 여백 있는 바이트 격자로 펼쳐 두고, 5칸 윈도우마다 자기 돌/빈칸 수를 세어
+//       "두면 5목" / "두면 4" 칸을 네 방향 모두 한 번에 표시함.
+
+#ifndef THREAT_H
+#define THREAT_H
+
+#include "board.h"
+
+// 여백을 둔 바이트 격자 (칸마다 0 또는 1)
+// - 판의 (x,y)는 격자의 [THREAT_TOP + y][THREAT_LEFT + x]
+// - 한 행이 32바이트라 AVX2 레지스터 하나(SSE2는 둘)에 들어감
+// - 위/아래 여백은 판 밖 4칸까지의 윈도우 시작점과 그 윈도우가 읽는 칸을 덮고,
+//   마지막 1행은 행 끝을 넘어 읽는 비정렬 로드용
+#define THREAT_COLS 32
+#define THREAT_LEFT 4
+#define THREAT_TOP  8
+#define THREAT_ROWS (THREAT_TOP + BOARD_MAX + THREAT_TOP + 1)
+
+typedef struct threat_grid {
+    unsigned char own[THREAT_ROWS][THREAT_COLS];    // 스캔하는 플레이어의 돌
+    unsigned char avail[THREAT_ROWS][THREAT_COLS];  // 판 안의 빈칸 (여백은 0 = 막힘)
+} threat_grid_t;
+
+// 커널 (n: 판 크기). 세 커널의 결과는 항상 같아야 함
+void threat_scan_scalar(const threat_grid_t *g, int n, threat_map_t *out);
+void threat_scan_sse2(const threat_grid_t *g, int n, threat_map_t *out);
+void threat_scan_avx2(const threat_grid_t *g, int n, threat_map_t *out);
+
+// 이 CPU에서 해당 커널(THREAT_IMPL_*)을 쓸 수 있으면 1
+int threat_cpu_supports(int impl);
+
+#endif
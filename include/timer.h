@@ -0,0 +1,58 @@
+// 경로: include/timer.h
+// 역할: 서버 이벤트 루프에서 사용하는 계층형 타이머 휠 선언.
+//       (재접속 유예, 턴 시계, 유휴 연결 정리처럼 "n초 뒤에 할 일"을 등록/취소)
+
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <stdint.h>
+
+#define TIMER_TICK_MS    100  // 휠 한 칸의 시간 (ms)
+#define TIMER_LEVEL_BITS 6
+#define TIMER_LEVEL_SIZE (1 << TIMER_LEVEL_BITS)  // 단계별 칸 수 (64)
+#define TIMER_LEVELS     4    // 단계 수: 6.4초 / 6.8분 / 7.3시간 / 19.4일
+
+typedef void (*timer_cb)(void *arg);
+
+// 타이머 노드 (POSIX timer_t와 구분하기 위해 wtimer라 부름)
+// 호출자가 자기 구조체에 포함해서 사용하므로 휠은 메모리를 할당하지 않음
+typedef struct wtimer {
+    struct wtimer  *next;
+    struct wtimer  *prev;
+    struct wtimer **head;   // 현재 들어 있는 칸의 리스트 헤드 (취소 시 O(1) 제거용)
+    uint64_t expires;       // 만료 tick
+    int      active;        // 휠에 등록되어 있으면 1
+    timer_cb cb;
+    void    *arg;
+} wtimer_t;
+
+// 계층형 휠
+// - 0단계 칸 하나는 1 tick, k단계 칸 하나는 64^k tick
+// - 0단계가 한 바퀴 돌 때마다 상위 단계의 한 칸을 하위 단계로 내려보냄(cascade)
+// - tick 처리 비용은 "만료되는 타이머 + 내려보내는 타이머" 수에 비례
+typedef struct timer_wheel {
+    struct wtimer *slots[TIMER_LEVELS][TIMER_LEVEL_SIZE];
+    uint64_t now;        // 현재까지 처리한 tick
+    uint64_t base_ms;    // tick 0에 해당하는 단조 시계(ms)
+    int      count;      // 등록된 타이머 수
+} timer_wheel_t;
+
+// 단조 시계 (ms)
+uint64_t timer_now_ms();
+
+// 휠 초기화 (현재 시각을 tick 0으로 설정)
+void timer_wheel_init(timer_wheel_t *w);
+
+// 타이머 등록 (delay_ms 뒤 cb(arg) 호출). 이미 등록된 타이머면 다시 설정
+void timer_add(timer_wheel_t *w, wtimer_t *t, uint64_t delay_ms, timer_cb cb, void *arg);
+
+// 타이머 취소 (등록되어 있지 않으면 아무 것도 안 함)
+void timer_cancel(timer_wheel_t *w, wtimer_t *t);
+
+// 현재 시각까지 밀린 tick을 처리하며 만료된 타이머의 콜백 호출
+void timer_wheel_advance(timer_wheel_t *w);
+
+// 다음 만료까지 남은 시간(ms). 타이머가 없으면 max_ms
+uint64_t timer_next_timeout(timer_wheel_t *w, uint64_t max_ms);
+
+#endif
@@ -0,0 +1,35 @@
+// 경로: include/trace.h
+// 역할: 지연 분석용 이벤트 추적 선언.
+//       - 스레드마다 고정 크기 원형 버퍼 하나에 구간 시작/끝 이벤트(이름, 시각, 인자 하나)를 기록
+//         (자기 스레드 버퍼에만 쓰므로 잠금이 없고, 가득 차면 가장 오래된 이벤트부터 덮어씀)
+//       - 꺼져 있을 때는 전역 플래그 확인 한 번, 켜져 있을 때는 시각 읽기(x86-64는 rdtsc) + 저장 한 번
+//       - 이름은 문자열 상수의 포인터만 저장하고, 내보낼 때 Chrome trace JSON
+//         (chrome://tracing, Perfetto에서 열림)으로 변환
+//       - log_write처럼 포맷/쓰기를 하지 않으므로 명령 하나 안의 단계별 시간까지 볼 수 있음
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#define TRACE_RING_EVENTS 65536   // 스레드당 보관하는 이벤트 수 (2의 거듭제곱)
+
+extern int trace_enabled;
+
+// 구간 시작 (arg: fd 등 이벤트에 붙일 값, 없으면 -1) / 끝. name은 문자열 상수
+#define TRACE_BEGIN(name, arg) \
+    do { if (__builtin_expect(trace_enabled, 0)) trace_emit((name), 'B', (arg)); } while (0)
+#define TRACE_END(name) \
+    do { if (__builtin_expect(trace_enabled, 0)) trace_emit((name), 'E', -1); } while (0)
+
+void trace_emit(const char *name, char phase, int arg);
+
+// 기록 시작 (이전 기록은 버림). 이미 켜져 있으면 아무것도 하지 않음
+void trace_start();
+
+// 기록 중지 (버퍼 내용은 trace_dump 전까지 유지)
+void trace_stop();
+
+// 마지막 trace_start 이후 모든 스레드의 이벤트를 path에 Chrome trace JSON으로 저장
+// 반환: 저장한 이벤트 수, 실패 시 -1
+long trace_dump(const char *path);
+
+#endif
@@ -0,0 +1,85 @@
+// 경로: include/uring.h
+// 역할: 서버 이벤트 루프의 io_uring 입출력 백엔드 선언 (서버 -u, 실패하면 select로 동작).
+//       liburing 없이 io_uring_setup/enter/register 시스템 호출을 직접 사용함.
+//       - 듣기 소켓에는 멀티샷 accept 하나, 연결마다 멀티샷 recv 하나만 걸어 두고
+//         받은 데이터는 커널이 제공 버퍼 링(provided buffer ring)에서 고른 버퍼로 옴
+//       - 관전자 송신 큐는 연결마다 sendmsg(iovec) 하나씩 제출하고,
+//         한 바퀴 동안 쌓인 방송은 io_uring_enter 한 번에 나감
+//       - 요청의 user_data에 fd와 세대 번호를 넣어, 닫힌 뒤 같은 번호로 열린 연결에
+//         늦게 도착한 완료가 섞이지 않게 함
+//       - 이벤트 처리(명령 해석, 게임 상태)는 select 경로와 같은 서버 함수를 그대로 사용
+
+#ifndef URING_H
+#define URING_H
+
+#include <stdint.h>
+#include "fanout.h"
+
+#define URING_ENTRIES    256     // 제출 큐 크기
+#define URING_CQ_ENTRIES 4096    // 완료 큐 크기 (연결마다 recv/send 완료가 쌓일 수 있음)
+#define URING_BUFS       256     // 제공 버퍼 수 (2의 거듭제곱)
+#define URING_BUF_SIZE   255     // 버퍼 하나의 크기 (select 경로의 read 한 번과 같음)
+
+// 완료 이벤트 종류
+#define URING_EV_ACCEPT 1        // fd: 새 연결
+#define URING_EV_RECV   2        // fd에서 res바이트 받음 (0: 연결 끊김, 음수: 에러)
+#define URING_EV_SENT   3        // fd로 res바이트 보냄 (음수: 에러), 보낸 만큼 큐에서 빼야 함
+#define URING_EV_POLL   4        // fd가 읽을 수 있게 됨 (uring_watch_poll, 소켓이 아닌 fd용)
+
+typedef struct uring_event {
+    int         type;
+    int         fd;
+    int         res;
+    const char *data;            // RECV 데이터 (uring_event_done 전까지 유효)
+    int         bid;             // 제공 버퍼 번호 (-1: 없음)
+} uring_event_t;
+
+typedef struct uring_stats {
+    long enters;                 // io_uring_enter 호출 수
+    long submitted;              // 제출한 요청 수
+    long completions;            // 처리한 완료 수
+    long recvs;                  // 넘겨준 RECV 이벤트 수
+    long sends;                  // 끝난 sendmsg 수
+} uring_stats_t;
+
+// 링과 제공 버퍼 링 준비 (커널이 멀티샷 recv/동기 취소를 지원하지 않으면 0)
+int uring_init();
+void uring_close();
+
+// 듣기 소켓에 멀티샷 accept 등록
+int uring_listen(int listen_fd);
+
+// 연결 fd에 멀티샷 recv 등록
+int uring_watch(int fd);
+
+// 소켓이 아닌 fd(eventfd 등)에 멀티샷 poll 등록
+int uring_watch_poll(int fd);
+
+// q에 쌓인 내용을 fd로 보내는 sendmsg 제출 (이미 보내는 중이거나 보낼 것이 없으면 0)
+// 보내는 동안 버퍼 참조를 잡아 두므로 q가 비워져도 안전. 큐에서 빼는 것은 SENT 이벤트에서
+int uring_send(int fd, const outq_t *q);
+int uring_sending(int fd);
+
+// fd에 걸린 요청을 모두 취소 (close 전에 호출, 이후 이 fd의 늦은 완료는 버림)
+void uring_forget(int fd);
+
+// 모든 요청 취소 (핫 재시작 인계 전). 취소 완료는 uring_next로 마저 받아 처리해야 함
+// uring_resume 전까지는 새 요청(재등록 포함)을 걸지 않음
+void uring_cancel_all();
+void uring_resume();
+
+// 제출하고 완료를 wait_ms까지 기다림. 반환: 받을 완료 수 (시간 초과/시그널이면 0, 에러 -1)
+int uring_wait(uint64_t wait_ms);
+
+// 시스템 호출 없이 받을 완료가 있는지
+int uring_ready();
+
+// 완료 하나를 이벤트로 꺼냄 (없으면 0). 재등록, 버려야 할 늦은 완료는 안에서 처리
+int uring_next(uring_event_t *ev);
+
+// RECV 이벤트의 버퍼를 제공 버퍼 링에 돌려줌
+void uring_event_done(uring_event_t *ev);
+
+void uring_get_stats(uring_stats_t *out);
+
+#endif
@@ -0,0 +1,41 @@
+// 경로: include/vcf.h
+// 역할: 위협 공간 탐색(VCF/VCT) 선언.
+//       공격 측은 위협수(4, VCT에서는 열린 3도)만, 수비 측은 그 위협을 막는 수만 두어 보므로
+//       전체 폭 탐색보다 훨씬 적은 노드로 깊은 필승 수순을 찾음.
+//       - VCF: 4를 연속으로 두어 이기는 수순 (수비 측 응수는 5목 자리 한 곳으로 강제)
+//       - VCT: 4와 열린 3을 섞어 이기는 수순 (3에 대한 수비 후보는 모두 확인)
+//       현재 판(board.c)에서 돌을 두고 무르며 탐색하고, 끝나면 판은 원래대로 돌아감.
+//       5목 변형에서만 동작 (렌주 규칙이면 흑의 금수와 정확히 5목 규칙을 따름).
+
+#ifndef VCF_H
+#define VCF_H
+
+#include <stdint.h>
+
+// 탐색 결과
+typedef struct vcf_result {
+    int  x, y;     // 필승 수순의 첫 수 (찾은 경우)
+    int  depth;    // 첫 수를 포함한 공격 측 수 (바로 5목이면 1)
+    long nodes;    // 탐색한 노드 수
+} vcf_result_t;
+
+// 이후 탐색의 마감 시각 (timer_now_ms 기준, 0이면 시간 제한 없음)
+// 마감을 넘기면 노드 상한을 넘긴 것과 같이 "못 찾음"으로 끝남
+void vcf_set_deadline(uint64_t deadline_ms);
+
+// 탐색 중단 함수 등록 (NULL이면 해제). 시계를 확인할 때마다 함께 불러 1이면 탐색을 멈추고,
+// 다음 vcf_set_abort 호출 전까지의 탐색은 모두 바로 "못 찾음"으로 끝남
+void vcf_set_abort(int (*fn)(void));
+
+// 마지막 vcf_set_abort 이후 중단 함수 때문에 멈춘 적이 있으면 1
+// (이때의 "못 찾음"은 탐색 결과가 아니므로 버려야 함)
+int vcf_aborted();
+
+// player가 먼저 두어 4를 연속으로 두어 이길 수 있으면 1
+// max_depth: 공격 측 수 상한, max_nodes: 노드 상한 (넘으면 못 찾은 것으로 처리)
+int vcf_search(int player, int max_depth, long max_nodes, vcf_result_t *res);
+
+// player가 먼저 두어 4/열린 3 연속으로 이길 수 있으면 1 (각 공격 노드에서 VCF를 먼저 시도)
+int vct_search(int player, int max_depth, long max_nodes, vcf_result_t *res);
+
+#endif
@@ -0,0 +1,79 @@
+// 경로: include/wal.h
+// 역할: 게임 상태 영속화(선행 기록 로그 + 스냅샷) 선언.
+//       서버가 받아들인 사건(게임 시작, 수, 게임 종료, 좌석 토큰)을 고정 크기 레코드로 로그에 덧붙이고,
+//       재시작하면 최근 스냅샷을 읽은 뒤 그 이후의 로그만 다시 적용해 진행 중이던 게임을 복구함.
+//       - 그룹 커밋: wal_append는 메모리 버퍼에만 쌓고, wal_commit 한 번이 write + fdatasync 한 번으로
+//         그동안 쌓인 레코드를 모두 디스크에 내림 (서버는 이벤트 루프 한 바퀴마다 한 번 호출)
+//       - 스냅샷: 레코드가 WAL_SNAPSHOT_EVERY개 쌓이면 살아 있는 게임을 최소 레코드열로 다시 써서
+//         임시 파일 → fsync → rename으로 교체하고 로그를 비움. 복구 시간은 스냅샷 간격에 비례
+//       - 레코드마다 CRC가 있어 쓰다 만 마지막 레코드는 복구 때 잘라냄
+//       - 커밋이 실패하면 쓰다 만 부분을 잘라내고 레코드는 버퍼에 남겨 다음 커밋에서 다시 씀
+//         (서버는 커밋이 다시 성공할 때까지 새 수를 받지 않고, 수는 커밋한 뒤에 방송함)
+
+#ifndef WAL_H
+#define WAL_H
+
+#include <stdint.h>
+
+// 레코드 종류
+#define WAL_GAME  1   // 새 게임 시작: arg = 모드, 변형, 규칙, AI 레벨
+#define WAL_MOVE  2   // 수: arg = x, y, 플레이어, P1 남은 시간(ms), P2 남은 시간(ms)
+#define WAL_END   3   // 게임 종료: arg = 승자 (0: 무승부)
+#define WAL_SEAT  4   // 좌석 토큰: arg = 좌석, text = 토큰 (빈 문자열이면 좌석 해제)
+#define WAL_CLEAR 5   // 게임 정리 (나가기/유예 만료)
+
+#define WAL_ARGS 5
+#define WAL_TEXT 24
+
+// 레코드 (고정 80바이트)
+typedef struct wal_rec {
+    uint32_t crc;              // 이 필드를 뺀 나머지의 CRC-32
+    uint16_t type;             // WAL_*
+    uint16_t reserved;
+    uint64_t lsn;              // 로그 순번 (1부터, 스냅샷 이후에도 계속 증가)
+    int64_t  arg[WAL_ARGS];
+    char     text[WAL_TEXT];
+} wal_rec_t;
+
+// 이만큼 레코드를 덧붙이면 스냅샷을 새로 씀
+#define WAL_SNAPSHOT_EVERY 256
+
+// 누적 통계 (STATS 표시용)
+typedef struct wal_stats {
+    uint64_t lsn;           // 마지막으로 배정한 순번
+    long     records;       // 이번 실행에서 덧붙인 레코드 수
+    long     commits;       // fdatasync 횟수 (records / commits가 그룹 커밋 효과)
+    long     snapshots;     // 쓴 스냅샷 수
+    long     recovered;     // 시작 시 복구에 적용한 레코드 수
+    long     failures;      // 실패한 커밋 수 (레코드는 남겨 두고 다시 씀)
+    long     dropped;       // 커밋이 계속 실패해 버퍼가 넘쳐 버린 레코드 수
+} wal_stats_t;
+
+// dir 아래의 로그(omok.wal)와 스냅샷(omok.snap)을 사용 (성공:1, 실패:0)
+int wal_open(const char *dir);
+
+// 복구: 스냅샷 레코드 → 스냅샷 이후의 로그 레코드 순으로 apply 호출
+// 깨진 꼬리는 잘라내고, 적용한 레코드 수 반환 (열려 있지 않으면 0)
+// apply가 NULL이면 적용 없이 순번만 이어 받음 (핫 재시작처럼 상태를 다른 경로로 받은 경우)
+long wal_recover(void (*apply)(const wal_rec_t *r));
+
+// 레코드 덧붙이기 (lsn/crc는 여기서 채움, 버퍼가 차면 바로 커밋). 열려 있지 않으면 무시
+// 버퍼가 찼는데 커밋도 실패하면 레코드를 버리고 0
+int wal_append(wal_rec_t *r);
+
+// 쌓인 레코드를 쓰고 fdatasync (쌓인 것이 없으면 아무 것도 안 함)
+// 실패 시 0: 쓰다 만 부분은 잘라내고 레코드는 남겨 두므로 다시 부르면 재시도
+int wal_commit();
+
+// 스냅샷을 쓸 때가 되었으면 1
+int wal_snapshot_due();
+
+// recs[0..n-1]을 새 스냅샷으로 쓰고 로그를 비움 (먼저 쌓인 레코드를 커밋). 실패 시 0
+int wal_snapshot(const wal_rec_t *recs, int n);
+
+void wal_get_stats(wal_stats_t *out);
+
+// 쌓인 레코드를 커밋하고 닫음
+void wal_close();
+
+#endif
@@ -0,0 +1,352 @@
+// 경로: src/ai.c
+// 역할: AI 수 선택 구현.
+//       - 오프닝 북에 있는 국면이면 그 수
+//       - 판 전체 위협 스캔으로 바로 이기는 자리 → 바로 막아야 하는 자리
+//       - 위협 공간 탐색(VCF → VCT)으로 자기 필승 수순의 첫 수 또는 상대 필승 수순을 막는 수
+//       - 그 외에는 후보 칸을 가중치로 평가해 가장 높은 칸
+
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include "ai.h"
+#include "board.h"
+#include "pattern.h"
+#include "book.h"
+#include "vcf.h"
+#include "timer.h"
+
+#define AI_DEFENSE_MAX 12
+
+const ai_level_t ai_levels[AI_LEVEL_MAX + 1] = {
+    { "-",      0,     0, 0,     0,  0,    0,    0,     0, 0 },
+    { "easy",   0,     0, 0,     0,  0,    0,   50,  2000, 0 },
+    { "normal", 8,  2000, 0,     0,  4,  300,  200,  5000, 2 },
+    { "hard",  12, 20000, 4,  2000,  8,  500, 1000, 15000, 3 },
+    { "expert",16, 50000, 6, 10000, 12, 2000, 3000, 30000, 4 },
+};
+
+const ai_eval_t ai_eval_default = {
+    {
+        0,      // PAT_NONE
+        50,     // PAT_TWO
+        300,    // PAT_OPEN_TWO
+        2000,   // PAT_THREE
+        10000,  // PAT_OPEN_THREE
+        12000,  // PAT_FOUR
+        50000,  // PAT_OPEN_FOUR
+        0,      // PAT_FIVE
+    },
+    40000,      // combo_four
+    20000,      // combo_three
+    80,         // block_pct
+    1,          // center
+    1,          // near
+};
+
+int ai_eval_parse(ai_eval_t *e, const char *spec) {
+    static const struct { const char *key; size_t off; } keys[] = {
+        { "two",         offsetof(ai_eval_t, pattern[PAT_TWO]) },
+        { "open_two",    offsetof(ai_eval_t, pattern[PAT_OPEN_TWO]) },
+        { "three",       offsetof(ai_eval_t, pattern[PAT_THREE]) },
+        { "open_three",  offsetof(ai_eval_t, pattern[PAT_OPEN_THREE]) },
+        { "four",        offsetof(ai_eval_t, pattern[PAT_FOUR]) },
+        { "open_four",   offsetof(ai_eval_t, pattern[PAT_OPEN_FOUR]) },
+        { "combo_four",  offsetof(ai_eval_t, combo_four) },
+        { "combo_three", offsetof(ai_eval_t, combo_three) },
+        { "block",       offsetof(ai_eval_t, block_pct) },
+        { "center",      offsetof(ai_eval_t, center) },
+        { "near",        offsetof(ai_eval_t, near) },
+    };
+
+    const char *p = spec;
+    while (*p) {
+        char key[32];
+        int value, len;
+        if (sscanf(p, "%31[a-z_]=%d%n", key, &value, &len) != 2) return 0;
+
+        size_t k;
+        for (k = 0; k < sizeof(keys) / sizeof(keys[0]); k++) {
+            if (strcmp(keys[k].key, key) == 0) break;
+        }
+        if (k == sizeof(keys) / sizeof(keys[0])) return 0;
+        *(int *)((char *)e + keys[k].off) = value;
+
+        p += len;
+        if (*p == ',') p++;
+        else if (*p) return 0;
+    }
+    return 1;
+}
+
+// 보드에서 (x,y)가 유효한 좌표인지 검사하는 함수
+static int in_range(int x, int y) {
+    int n = board_get_size();
+    return (x >= 0 && x < n && y >= 0 && y < n);
+}
+
+// (x,y)에 player가 두면 승리하는지 여부를 판단
+// 5목 변형은 라인 패턴 표 조회 (렌주룰의 흑은 정확히 5목만), 6목 변형은 최대 연속 길이로 판단
+static int is_five_if(int x, int y, int player) {
+    if (board_get_win_len() == WIN_LEN) {
+        unsigned char pat[4];
+        board_line_patterns(x, y, player, pat);
+        for (int d = 0; d < 4; d++) {
+            if ((pat[d] & PAT_TYPE_MASK) == PAT_FIVE) return 1;
+        }
+        return 0;
+    }
+    return (board_longest_if(x, y, player) >= board_get_win_len());
+}
+
+// (x,y)에 player가 둔다고 가정했을 때 네 줄 패턴 점수의 합
+// 4가 둘(4-4)이거나 4와 열린 3(4-3)이 함께 생기면 사실상 막을 수 없으므로 열린 4 수준으로 가산
+static int pattern_score(const ai_eval_t *E, int x, int y, int player) {
+    unsigned char pat[4];
+    board_line_patterns(x, y, player, pat);
+
+    int score = 0, fours = 0, threes = 0;
+    for (int d = 0; d < 4; d++) {
+        int t = pat[d] & PAT_TYPE_MASK;
+        if (t != PAT_FIVE) score += E->pattern[t];
+        if (t == PAT_FOUR) fours += (pat[d] & PAT_DOUBLE_FOUR) ? 2 : 1;
+        if (t == PAT_OPEN_THREE) threes++;
+    }
+    if (fours >= 2 || (fours >= 1 && threes >= 1)) score += E->combo_four;
+    else if (threes >= 2) score += E->combo_three;
+    return score;
+}
+
+int ai_evaluate_cell(const ai_eval_t *E, int me, int x, int y, int hx, int hy) {
+    // 이미 돌이 있으면 아주 낮은 점수 부여 (실질적으로 선택 불가)
+    if (!in_range(x, y) || get_stone(x, y) != 0) {
+        return -1000000000;
+    }
+
+    int score = 0;
+    int opp = 3 - me;
+
+    // 1. 두면 바로 이기는 자리 (5목 완성)
+    if (is_five_if(x, y, me)) {
+        score += 1000000;
+    }
+
+    // 렌주룰에서 상대(흑)에게 금수인 자리는 상대가 둘 수 없으므로 막을 필요가 없음
+    int opp_can_play = !board_is_forbidden(x, y, opp);
+
+    // 2. 상대가 두면 이기는 자리(= 즉시 막아야 하는 자리)
+    if (opp_can_play && is_five_if(x, y, opp)) {
+        score += 900000;
+    }
+
+    // 3. 양쪽이 이 칸에 두었을 때 생기는 패턴에 따른 가중치 부여
+    int win = board_get_win_len();
+    if (win == WIN_LEN) {
+        // 5목 변형: 네 줄의 패턴을 표에서 조회해 합산 (막을 때는 상대 점수의 block_pct%)
+        score += pattern_score(E, x, y, me);
+        if (opp_can_play) score += pattern_score(E, x, y, opp) * E->block_pct / 100;
+    } else {
+        int myLen  = board_longest_if(x, y, me);
+        int oppLen = opp_can_play ? board_longest_if(x, y, opp) : 0;
+
+        // (6목 변형: 5목/4목 기준)
+        if (myLen == win - 1)      score += 50000; // 5목을 만들 수 있는 자리
+        else if (myLen == win - 2) score += 10000; // 4목 자리
+
+        if (oppLen == win - 1)      score += 40000; // 상대의 5목을 막는 자리
+        else if (oppLen == win - 2) score +=  8000; // 상대의 4목 견제
+    }
+
+    // 4. 중앙 선호 (중앙에서 멀어질수록 감점)
+    int center = (board_get_size() - 1) / 2;
+    int dx = x - center;
+    int dy = y - center;
+    score -= (dx*dx + dy*dy) * E->center;
+
+    // 5. 상대가 마지막으로 둔 수(hx, hy)에 가까울수록 약간 선호 (상대 돌 근처에서 싸우는 전략)
+    if (hx >= 0 && hy >= 0) {
+        int pdx = x - hx;
+        int pdy = y - hy;
+        score -= (pdx*pdx + pdy*pdy) * E->near;
+    }
+
+    return score;
+}
+
+int ai_candidates(int me, int cand[][2], int max) {
+    int n = board_get_size();
+    int count = 0;
+
+    if (board_move_count() == 0) {
+        cand[0][0] = (n - 1) / 2;
+        cand[0][1] = (n - 1) / 2;
+        return 1;
+    }
+
+    for (int y = 0; y < n && count < max; y++) {
+        for (int x = 0; x < n && count < max; x++) {
+            if (get_stone(x, y) != 0 || !board_is_near(x, y)) continue;
+            if (board_is_forbidden(x, y, me)) continue;
+
+            cand[count][0] = x;
+            cand[count][1] = y;
+            count++;
+        }
+    }
+    return count;
+}
+
+int ai_rank_moves(const ai_eval_t *E, int me, int out[][3], int max) {
+    static int cand[BOARD_MAX * BOARD_MAX][2];
+    int ncand = ai_candidates(me, cand, BOARD_MAX * BOARD_MAX);
+    int count = 0;
+
+    for (int c = 0; c < ncand; c++) {
+        int s = ai_evaluate_cell(E, me, cand[c][0], cand[c][1], -1, -1);
+        if (max <= 0 || (count == max && s <= out[max - 1][2])) continue;
+
+        int pos = (count < max) ? count++ : max - 1;
+        while (pos > 0 && out[pos - 1][2] < s) {
+            out[pos][0] = out[pos - 1][0];
+            out[pos][1] = out[pos - 1][1];
+            out[pos][2] = out[pos - 1][2];
+            pos--;
+        }
+        out[pos][0] = cand[c][0];
+        out[pos][1] = cand[c][1];
+        out[pos][2] = s;
+    }
+    return count;
+}
+
+typedef int (*threat_search_fn)(int player, int max_depth, long max_nodes, vcf_result_t *res);
+
+// 상대에게 필승 수순(vr의 첫 수)이 있을 때 막는 수 선택
+// 상대 수순의 첫 수와 평가 점수가 높은 후보를 차례로 두어 보고, 같은 탐색으로 더 이상
+// 필승 수순이 없어지는 첫 수를 vr에 기록. 못 찾으면 둘 수 있는 첫 시도(보통 상대 수순의 첫 수)를 둠
+// 렌주룰에서 me에게 금수인 칸은 시도하지 않음. 둘 수 있는 시도가 없으면 0 (ai_choose_move의 조건식에서 사용)
+static int defend_threat(const ai_level_t *L, const ai_eval_t *E, int me,
+                         threat_search_fn search, int depth, vcf_result_t *vr, int hx, int hy) {
+    // tries[0]: 상대 수순의 첫 수, tries[1..ntop]: 평가 점수 내림차순 상위 후보
+    int tries[AI_DEFENSE_MAX + 1][2];
+    int scores[AI_DEFENSE_MAX + 1];
+    int max_tries = L->defense_tries < AI_DEFENSE_MAX ? L->defense_tries : AI_DEFENSE_MAX;
+    tries[0][0] = vr->x;
+    tries[0][1] = vr->y;
+
+    static int cand[BOARD_MAX * BOARD_MAX][2];
+    int ncand = ai_candidates(me, cand, BOARD_MAX * BOARD_MAX);
+    int ntop = 0;
+    for (int c = 0; c < ncand; c++) {
+        if (cand[c][0] == vr->x && cand[c][1] == vr->y) continue;
+        int s = ai_evaluate_cell(E, me, cand[c][0], cand[c][1], hx, hy);
+        if (max_tries == 0 || (ntop == max_tries && s <= scores[ntop])) continue;
+
+        int pos = (ntop < max_tries) ? ++ntop : ntop;
+        while (pos > 1 && scores[pos - 1] < s) {
+            scores[pos] = scores[pos - 1];
+            tries[pos][0] = tries[pos - 1][0];
+            tries[pos][1] = tries[pos - 1][1];
+            pos--;
+        }
+        scores[pos] = s;
+        tries[pos][0] = cand[c][0];
+        tries[pos][1] = cand[c][1];
+    }
+    int nt = 1 + ntop;
+
+    int fx = -1, fy = -1;
+    for (int t = 0; t < nt; t++) {
+        vcf_result_t r;
+        if (board_is_forbidden(tries[t][0], tries[t][1], me)) continue;
+        if (!place_stone(tries[t][0], tries[t][1], me)) continue;
+        if (fx < 0) {
+            fx = tries[t][0];
+            fy = tries[t][1];
+        }
+        int still = search(3 - me, depth, L->defense_nodes, &r);
+        board_undo();
+        if (!still) {
+            fx = tries[t][0];
+            fy = tries[t][1];
+            break;
+        }
+    }
+    if (fx < 0) return 0;
+    vr->x = fx;
+    vr->y = fy;
+    return 1;
+}
+
+void ai_choose_move(const ai_level_t *L, const ai_eval_t *E, int me, int hx, int hy,
+                    int *out_x, int *out_y) {
+    int bestScore = -1000000000;
+    int bestX = 0, bestY = 0;
+    int opp = 3 - me;
+
+    // 오프닝 북에 있는 국면이면 탐색 없이 바로 응답 (이진 탐색 한 번, me에게 금수인 수는 무시)
+    int bx, by;
+    if (book_lookup(board_hash(), &bx, &by) && in_range(bx, by) && get_stone(bx, by) == 0 &&
+        !board_is_forbidden(bx, by, me)) {
+        *out_x = bx;
+        *out_y = by;
+        return;
+    }
+
+    // 5목 변형: 판 전체 위협 스캔으로 바로 이기는 자리 → 바로 막아야 하는 자리 순으로 먼저 확인
+    // (렌주 규칙이 적용된 표로 한 번 더 확인: 흑의 장목은 승리가 아님)
+    // 렌주룰에서 me에게 금수인 막는 자리는 둘 수 없으므로 건너뛰고 탐색/후보 평가로 넘어감
+    static threat_map_t threats;
+    for (int k = 0; k < 2; k++) {
+        int p = k == 0 ? me : opp;
+        if (!board_threat_scan(p, &threats)) break;
+        int n = board_get_size();
+        for (int y = 0; y < n; y++) {
+            for (int x = 0; x < n; x++) {
+                if (!threats.five[y][x]) continue;
+                if (!is_five_if(x, y, p) || board_is_forbidden(x, y, me)) continue;
+                *out_x = x;
+                *out_y = y;
+                return;
+            }
+        }
+    }
+
+    // 위협 공간 탐색: 자기 필승 수순이 있으면 그 첫 수, 상대의 필승 수순이 있으면 막는 수
+    // (VCF를 먼저, 그다음 더 비싼 VCT, 시간 예산을 넘기면 그 뒤 탐색은 못 찾은 것으로 끝남)
+    vcf_result_t vr;
+    vcf_set_deadline(timer_now_ms() + (uint64_t)L->time_ms);
+    int found =
+        (L->vcf_depth > 0 &&
+         (vcf_search(me, L->vcf_depth, L->vcf_nodes, &vr) ||
+          (vcf_search(opp, L->vcf_depth, L->vcf_nodes, &vr) &&
+           defend_threat(L, E, me, vcf_search, L->vcf_depth, &vr, hx, hy)))) ||
+        (L->vct_depth > 0 &&
+         (vct_search(me, L->vct_depth, L->vct_nodes, &vr) ||
+          (vct_search(opp, L->vct_depth, L->vct_nodes, &vr) &&
+           defend_threat(L, E, me, vct_search, L->vct_depth, &vr, hx, hy))));
+    vcf_set_deadline(0);
+    if (found) {
+        *out_x = vr.x;
+        *out_y = vr.y;
+        return;
+    }
+
+    // 후보 칸에 대해서만 ai_evaluate_cell로 점수 평가
+    static int cand[BOARD_MAX * BOARD_MAX][2];
+    int ncand = ai_candidates(me, cand, BOARD_MAX * BOARD_MAX);
+
+    for (int c = 0; c < ncand; c++) {
+        int x = cand[c][0];
+        int y = cand[c][1];
+
+        int s = ai_evaluate_cell(E, me, x, y, hx, hy);
+        if (s > bestScore) {
+            bestScore = s;
+            bestX = x;
+            bestY = y;
+        }
+    }
+
+    *out_x = bestX;
+    *out_y = bestY;
+}
@@ -1,98 +1,447 @@
 // 경로: src/board.c
 // 역할: 오목판을 관리하고 돌을 두며, 승리 여부를 판정함.
+//       판 크기/승리 조건 변형마다 판정 커널을 매크로로 따로 만들어,
+//       기본 15x15/5목 경로도 크기와 길이가 컴파일 타임 상수인 루프를 그대로 사용함.
+//       판 상태는 모두 game_state_t(game.h) 하나에 들어 있고, board.h 함수들은 현재 상태에 대해 동작함.
 
 #include <stdio.h>
+#include <stdint.h>
+#include <string.h>
 #include "board.h"
+#include "game.h"
+#include "pattern.h"
+#include "threat.h"
 
-// 전역 오목판 배열
-static int board[BOARD_SIZE][BOARD_SIZE];
+// 기본 상태와 현재 상태 (board.h 함수들은 gs가 가리키는 상태에 대해 동작)
+// 라인 워드는 19칸 + 여백 10칸 = 29칸 = 58비트
+static game_state_t default_state = { VARIANT_GOMOKU15, RULE_FREESTYLE, BOARD_SIZE };
+static game_state_t *gs = &default_state;
 
+// 국면 해시 (Zobrist): 칸마다 플레이어별 난수를 XOR
+// 오프닝 북 파일과 서버가 같은 값을 써야 하므로 고정 시드에서 만든 난수를 사용
+static uint64_t zobrist[3][BOARD_MAX][BOARD_MAX];
+static uint64_t zobrist_variant[VARIANT_COUNT][2];   // [변형][규칙]
+static int zobrist_ready = 0;
+
+// 변형별 판정 커널 생성
+// N: 판 크기, K: 승리 길이 (둘 다 상수이므로 방향별 비교 루프가 펼쳐짐)
+#define DEFINE_BOARD_KERNELS(N, K)                                              \
+static int check_win_##N##_##K(const game_state_t *g, int player) {             \
+    for (int y = 0; y < N; y++) {                                               \
+        for (int x = 0; x < N; x++) {                                           \
+            if (g->cells[y][x] != player) continue;                             \
+            int k;                                                              \
+            /* 가로 */                                                          \
+            if (x + K - 1 < N) {                                                \
+                for (k = 1; k < K && g->cells[y][x+k] == player; k++) ;         \
+                if (k == K) return 1;                                           \
+            }                                                                   \
+            /* 세로 */                                                          \
+            if (y + K - 1 < N) {                                                \
+                for (k = 1; k < K && g->cells[y+k][x] == player; k++) ;         \
+                if (k == K) return 1;                                           \
+            }                                                                   \
+            /* 대각선 ↘ */                                                      \
+            if (x + K - 1 < N && y + K - 1 < N) {                               \
+                for (k = 1; k < K && g->cells[y+k][x+k] == player; k++) ;       \
+                if (k == K) return 1;                                           \
+            }                                                                   \
+            /* 대각선 ↗ */                                                      \
+            if (x + K - 1 < N && y - (K - 1) >= 0) {                            \
+                for (k = 1; k < K && g->cells[y-k][x+k] == player; k++) ;       \
+                if (k == K) return 1;                                           \
+            }                                                                   \
+        }                                                                       \
+    }                                                                           \
+    return 0;                                                                   \
+}                                                                               \
+                                                                                \
+static int longest_if_##N##_##K(const game_state_t *g, int x, int y, int player) { \
+    static const int dirs[4][2] = { {1, 0}, {0, 1}, {1, 1}, {1, -1} };          \
+    int best = 0;                                                               \
+    for (int d = 0; d < 4; d++) {                                               \
+        int dx = dirs[d][0], dy = dirs[d][1];                                   \
+        int len = 1;                                                            \
+        int nx = x + dx, ny = y + dy;                                           \
+        while (nx >= 0 && nx < N && ny >= 0 && ny < N &&                        \
+               g->cells[ny][nx] == player) { len++; nx += dx; ny += dy; }       \
+        nx = x - dx; ny = y - dy;                                               \
+        while (nx >= 0 && nx < N && ny >= 0 && ny < N &&                        \
+               g->cells[ny][nx] == player) { len++; nx -= dx; ny -= dy; }       \
+        if (len > best) best = len;                                             \
+    }                                                                           \
+    return best;                                                                \
+}
+
+DEFINE_BOARD_KERNELS(15, 5)
+DEFINE_BOARD_KERNELS(19, 5)
+DEFINE_BOARD_KERNELS(19, 6)
+
+// 변형 테이블 (VARIANT_* 번호 순서)
+typedef struct board_variant {
+    int size;
+    int win_len;
+    int (*check_win)(const game_state_t *g, int player);
+    int (*longest_if)(const game_state_t *g, int x, int y, int player);
+} board_variant_t;
+
+static const board_variant_t variants[VARIANT_COUNT] = {
+    { 15, 5, check_win_15_5, longest_if_15_5 },
+    { 19, 5, check_win_19_5, longest_if_19_5 },
+    { 19, 6, check_win_19_6, longest_if_19_6 },
+};
+
+// 상태 g의 변형 정보
+#define VAR(g) (&variants[(g)->variant])
+
+// (x,y)가 속한 방향 dir(0:가로 1:세로 2:↘ 3:↗)의 줄 번호와 줄 안의 위치
+static inline int line_of(int x, int y, int dir, int *pos) {
+    switch (dir) {
+    case 0:  *pos = x; return y;
+    case 1:  *pos = y; return x;
+    case 2:  *pos = x; return x - y + (BOARD_MAX - 1);
+    default: *pos = x; return x + y;
+    }
+}
+
+// 라인 워드를 모두 "판 밖"으로 채운 뒤 g의 변형 칸만 빈칸으로 비움
+static void reset_lines(game_state_t *g) {
+    for (int d = 0; d < 4; d++)
+        for (int l = 0; l < GAME_LINE_COUNT; l++)
+            g->lines[d][l] = ~(uint64_t)0;
+
+    for (int y = 0; y < g->size; y++) {
+        for (int x = 0; x < g->size; x++) {
+            for (int d = 0; d < 4; d++) {
+                int pos;
+                int l = line_of(x, y, d, &pos);
+                g->lines[d][l] &= ~((uint64_t)3 << (2 * (pos + PAT_HALF)));
+            }
+        }
+    }
+}
+
+int board_find_variant(int size, int win_len) {
+    for (int v = 0; v < VARIANT_COUNT; v++) {
+        if (variants[v].size == size && variants[v].win_len == win_len) return v;
+    }
+    return -1;
+}
+
+int board_set_variant(int variant) {
+    if (variant < 0 || variant >= VARIANT_COUNT) return 0;
+    gs->variant = variant;
+    gs->size = variants[variant].size;
+    // 렌주 표는 5목 기준이므로 다른 승리 길이에서는 자유룰로 되돌림
+    if (variants[variant].win_len != 5) gs->rule = RULE_FREESTYLE;
+    return 1;
+}
+
+// variant에서 rule을 쓸 수 있으면 1 (렌주는 5목 변형에서만)
+static int rule_ok(int variant, int rule) {
+    return rule == RULE_FREESTYLE || (rule == RULE_RENJU && variants[variant].win_len == 5);
+}
+
+int board_rule_ok(int variant, int rule) {
+    return variant >= 0 && variant < VARIANT_COUNT && rule_ok(variant, rule);
+}
+
+int board_set_rule(int rule) {
+    if (!rule_ok(gs->variant, rule)) return 0;
+    gs->rule = rule;
+    return 1;
+}
+
+int board_get_rule() {
+    return gs->rule;
+}
+
+int board_get_variant() {
+    return gs->variant;
+}
+
+int board_get_size() {
+    return gs->size;
+}
+
+int board_get_win_len() {
+    return VAR(gs)->win_len;
+}
 
 int get_stone(int x, int y) {
-    if (x < 0 || x >= BOARD_SIZE || y < 0 || y >= BOARD_SIZE) return -1;
-    return board[y][x];  // ★ 다른 함수들과 동일하게 [y][x] 사용
+    if (x < 0 || x >= gs->size || y < 0 || y >= gs->size) return -1;
+    return gs->cells[y][x];  // ★ 다른 함수들과 동일하게 [y][x] 사용
 }
 
-// 오목판 초기화
-void init_board() {
-    for (int y = 0; y < BOARD_SIZE; y++) {
-        for (int x = 0; x < BOARD_SIZE; x++) {
-            board[y][x] = 0;
+int board_is_near(int x, int y) {
+    if (x < 0 || x >= gs->size || y < 0 || y >= gs->size) return 0;
+    return gs->near[y][x] > 0;
+}
+
+void board_bind(game_state_t *g) {
+    gs = g ? g : &default_state;
+}
+
+game_state_t *board_state() {
+    return gs;
+}
+
+// splitmix64: 시드 하나로 고르게 퍼진 64비트 난수열 생성
+static uint64_t splitmix64(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static void zobrist_init() {
+    uint64_t seed = 0x6F6D6F6B;  // "omok"
+    for (int p = 1; p <= 2; p++)
+        for (int y = 0; y < BOARD_MAX; y++)
+            for (int x = 0; x < BOARD_MAX; x++)
+                zobrist[p][y][x] = splitmix64(&seed);
+    for (int v = 0; v < VARIANT_COUNT; v++)
+        for (int r = 0; r < 2; r++)
+            zobrist_variant[v][r] = splitmix64(&seed);
+    zobrist_ready = 1;
+}
+
+uint64_t game_hash(const game_state_t *g) {
+    return g->stones_hash ^ zobrist_variant[g->variant][g->rule];
+}
+
+uint64_t board_hash() {
+    return game_hash(gs);
+}
+
+// 빈 판으로 초기화 (변형이 바뀌었을 수 있으므로 최대 크기 전체를 비움)
+int game_init(game_state_t *g, int variant, int rule) {
+    if (variant < 0 || variant >= VARIANT_COUNT || !rule_ok(variant, rule)) return 0;
+    if (!zobrist_ready) zobrist_init();
+
+    g->variant = variant;
+    g->rule = rule;
+    g->size = variants[variant].size;
+    memset(g->cells, 0, sizeof(g->cells));
+    memset(g->near, 0, sizeof(g->near));
+    g->move_count = 0;
+    g->stones_hash = 0;
+    reset_lines(g);
+
+    // 위협 스캔 격자: 판 안의 칸만 빈칸(avail=1), 여백은 막힌 칸
+    memset(g->grid, 0, sizeof(g->grid));
+    for (int y = 0; y < g->size; y++) {
+        for (int x = 0; x < g->size; x++) {
+            g->grid[0].avail[THREAT_TOP + y][THREAT_LEFT + x] = 1;
+            g->grid[1].avail[THREAT_TOP + y][THREAT_LEFT + x] = 1;
         }
     }
+    return 1;
+}
+
+void init_board() {
+    game_init(gs, gs->variant, gs->rule);
 }
 
 // 오목판 출력 (서버 디버깅용)
 void print_board() {
-    for (int y = 0; y < BOARD_SIZE; y++) {
-        for (int x = 0; x < BOARD_SIZE; x++) {
-            printf("%d ", board[y][x]);
+    for (int y = 0; y < gs->size; y++) {
+        for (int x = 0; x < gs->size; x++) {
+            printf("%d ", gs->cells[y][x]);
         }
         printf("\n");
     }
 }
 
-// 돌 두기 (성공:1, 실패:0)
-int place_stone(int x, int y, int player) {
-    if (x < 0 || x >= BOARD_SIZE || y < 0 || y >= BOARD_SIZE) {
+// 보드 스냅샷 생성 (관전자 입장, SYNC 응답 시 현재 판 전체를 전달하기 위함)
+// 클라이언트는 MOVE p x y를 my_board[x][y]에 기록하므로 같은 순서(x가 행)로 기록
+int board_snapshot(int *cells) {
+    int n = 0;
+    for (int x = 0; x < gs->size; x++) {
+        for (int y = 0; y < gs->size; y++) {
+            cells[n++] = gs->cells[y][x];
+        }
+    }
+    return n;
+}
+
+int board_move_count() {
+    return gs->move_count;
+}
+
+int board_get_move(int idx, int *x, int *y, int *player) {
+    if (idx < 0 || idx >= gs->move_count) return 0;
+    *x = gs->move_hist[idx][0];
+    *y = gs->move_hist[idx][1];
+    *player = gs->move_hist[idx][2];
+    return 1;
+}
+
+// (x,y) 둘레 GAME_NEAR_DIST 안의 칸들의 후보 카운트에 delta를 더함 (판 밖은 건너뜀)
+static void update_near(game_state_t *g, int x, int y, int delta) {
+    int y0 = y - GAME_NEAR_DIST < 0 ? 0 : y - GAME_NEAR_DIST;
+    int y1 = y + GAME_NEAR_DIST >= g->size ? g->size - 1 : y + GAME_NEAR_DIST;
+    int x0 = x - GAME_NEAR_DIST < 0 ? 0 : x - GAME_NEAR_DIST;
+    int x1 = x + GAME_NEAR_DIST >= g->size ? g->size - 1 : x + GAME_NEAR_DIST;
+    for (int ny = y0; ny <= y1; ny++)
+        for (int nx = x0; nx <= x1; nx++)
+            g->near[ny][nx] += delta;
+}
+
+int game_make_move(game_state_t *g, int x, int y, int player) {
+    if (x < 0 || x >= g->size || y < 0 || y >= g->size) {
         return 0;
     }
-    if (board[y][x] != 0) {
+    if (g->cells[y][x] != 0) {
         return 0;
     }
-    board[y][x] = player;
+    g->cells[y][x] = player;
+    g->stones_hash ^= zobrist[player][y][x];
+    for (int d = 0; d < 4; d++) {
+        int pos;
+        int l = line_of(x, y, d, &pos);
+        g->lines[d][l] |= (uint64_t)player << (2 * (pos + PAT_HALF));
+    }
+    update_near(g, x, y, 1);
+    g->grid[player - 1].own[THREAT_TOP + y][THREAT_LEFT + x] = 1;
+    g->grid[0].avail[THREAT_TOP + y][THREAT_LEFT + x] = 0;
+    g->grid[1].avail[THREAT_TOP + y][THREAT_LEFT + x] = 0;
+
+    g->move_hist[g->move_count][0] = x;
+    g->move_hist[g->move_count][1] = y;
+    g->move_hist[g->move_count][2] = player;
+    g->move_count++;
     return 1;
 }
 
-// 승리 판정 (player 돌이 5개 연속이면 1 반환)
-int check_win(int player) {
-    for (int y = 0; y < BOARD_SIZE; y++) {
-        for (int x = 0; x < BOARD_SIZE; x++) {
-
-            if (board[y][x] != player) continue;
-
-            // 가로
-            if (x + 4 < BOARD_SIZE) {
-                if (board[y][x+1] == player &&
-                    board[y][x+2] == player &&
-                    board[y][x+3] == player &&
-                    board[y][x+4] == player) {
-                    return 1;
-                }
-            }
+int game_unmake_move(game_state_t *g) {
+    if (g->move_count == 0) return 0;
+    g->move_count--;
+    int x = g->move_hist[g->move_count][0];
+    int y = g->move_hist[g->move_count][1];
+    int player = g->move_hist[g->move_count][2];
 
-            // 세로
-            if (y + 4 < BOARD_SIZE) {
-                if (board[y+1][x] == player &&
-                    board[y+2][x] == player &&
-                    board[y+3][x] == player &&
-                    board[y+4][x] == player) {
-                    return 1;
-                }
-            }
+    g->cells[y][x] = 0;
+    g->stones_hash ^= zobrist[player][y][x];
+    for (int d = 0; d < 4; d++) {
+        int pos;
+        int l = line_of(x, y, d, &pos);
+        g->lines[d][l] &= ~((uint64_t)3 << (2 * (pos + PAT_HALF)));
+    }
+    update_near(g, x, y, -1);
+    g->grid[player - 1].own[THREAT_TOP + y][THREAT_LEFT + x] = 0;
+    g->grid[0].avail[THREAT_TOP + y][THREAT_LEFT + x] = 1;
+    g->grid[1].avail[THREAT_TOP + y][THREAT_LEFT + x] = 1;
+    return 1;
+}
 
-            // 대각선 ↘
-            if (x + 4 < BOARD_SIZE && y + 4 < BOARD_SIZE) {
-                if (board[y+1][x+1] == player &&
-                    board[y+2][x+2] == player &&
-                    board[y+3][x+3] == player &&
-                    board[y+4][x+4] == player) {
-                    return 1;
-                }
-            }
+// 돌 두기 (성공:1, 실패:0)
+int place_stone(int x, int y, int player) {
+    return game_make_move(gs, x, y, player);
+}
 
-            // 대각선 ↗
-            if (x + 4 < BOARD_SIZE && y - 4 >= 0) {
-                if (board[y-1][x+1] == player &&
-                    board[y-2][x+2] == player &&
-                    board[y-3][x+3] == player &&
-                    board[y-4][x+4] == player) {
-                    return 1;
-                }
-            }
+// 마지막 수 무르기 (탐색에서 수를 두어 보고 되돌릴 때 사용, 성공:1, 수가 없으면 0)
+int board_undo() {
+    return game_unmake_move(gs);
+}
+
+// 라인 윈도우 인덱스: 라인 워드에서 기준 칸 좌우 PAT_HALF칸(22비트)을 잘라 기준 칸을 빼고,
+// P2 기준이면 돌 코드 1과 2를 맞바꿈 (판 밖 3은 그대로)
+#define LO_MASK 0x55555555u
+unsigned board_line_index(int x, int y, int dir, int player) {
+    int pos;
+    int l = line_of(x, y, dir, &pos);
+    uint64_t w = gs->lines[dir][l] >> (2 * pos);   // 윈도우 시작 = pos - PAT_HALF + 여백 PAT_HALF
+
+    unsigned lo = (unsigned)(w & ((1u << (2 * PAT_HALF)) - 1));
+    unsigned hi = (unsigned)((w >> (2 * (PAT_HALF + 1))) & ((1u << (2 * PAT_HALF)) - 1));
+    unsigned idx = lo | (hi << (2 * PAT_HALF));
+
+    if (player == 2) idx = ((idx & LO_MASK) << 1) | ((idx >> 1) & LO_MASK);
+    return idx & (PAT_TABLE_SIZE - 1);
+}
+
+void board_line_patterns(int x, int y, int player, unsigned char out[4]) {
+    // 렌주룰의 흑은 정확히 5목만 인정하는 표, 그 외에는 5목 이상 표
+    const unsigned char *table =
+        (gs->rule == RULE_RENJU && player == 1) ? pattern_exact : pattern_free;
+    for (int d = 0; d < 4; d++) {
+        out[d] = table[board_line_index(x, y, d, player)];
+    }
+}
+
+// 렌주 금수 판정: 후보 칸을 지나는 네 줄만 표로 조회 (판 전체 재탐색 없음)
+// - 5목이 하나라도 생기면 금수보다 승리가 우선
+// - 장목, 4-4 (같은 줄의 두 4 포함), 3-3은 금수
+int board_is_forbidden(int x, int y, int player) {
+    if (gs->rule != RULE_RENJU || player != 1) return 0;
+    if (x < 0 || x >= gs->size || y < 0 || y >= gs->size || gs->cells[y][x] != 0) return 0;
+
+    unsigned char pat[4];
+    board_line_patterns(x, y, player, pat);
+
+    int overline = 0, fours = 0, threes = 0;
+    for (int d = 0; d < 4; d++) {
+        int t = pat[d] & PAT_TYPE_MASK;
+        if (t == PAT_FIVE) return 0;
+        if (pat[d] & PAT_OVERLINE) overline = 1;
+        if (t == PAT_FOUR || t == PAT_OPEN_FOUR) fours += (pat[d] & PAT_DOUBLE_FOUR) ? 2 : 1;
+        if (t == PAT_OPEN_THREE) threes++;
+    }
+    return overline || fours >= 2 || threes >= 2;
+}
+
+// 승리 판정
+// 5목 변형: 새 5목은 마지막 수를 지나야 하므로 그 칸의 네 줄만 표로 조회
+// (렌주룰의 흑은 정확히 5목 표를 쓰므로 장목은 승리가 아님)
+// 그 외(6목 변형, 마지막 수가 player의 수가 아닌 경우): 현재 변형의 커널로 판 전체 확인
+int check_win(int player) {
+    int n = gs->move_count;
+    if (VAR(gs)->win_len == WIN_LEN && n > 0 && gs->move_hist[n - 1][2] == player) {
+        unsigned char pat[4];
+        board_line_patterns(gs->move_hist[n - 1][0], gs->move_hist[n - 1][1], player, pat);
+        for (int d = 0; d < 4; d++) {
+            if ((pat[d] & PAT_TYPE_MASK) == PAT_FIVE) return 1;
         }
+        return 0;
     }
+    return VAR(gs)->check_win(gs, player);
+}
 
-    return 0;
+// (x,y)에 player가 둔다고 가정했을 때의 최대 연속 길이 (현재 변형의 커널로 위임)
+int board_longest_if(int x, int y, int player) {
+    return VAR(gs)->longest_if(gs, x, y, player);
 }
 
+// 위협 스캔 커널 선택 (-1: 아직 고르지 않음 → 첫 호출 때 CPU에 맞게 선택)
+static int threat_impl = -1;
+
+int board_threat_set_impl(int impl) {
+    if (impl < THREAT_IMPL_SCALAR || impl > THREAT_IMPL_AVX2) return 0;
+    if (!threat_cpu_supports(impl)) return 0;
+    threat_impl = impl;
+    return 1;
+}
+
+int board_threat_get_impl() {
+    if (threat_impl < 0) {
+        if (threat_cpu_supports(THREAT_IMPL_AVX2))      threat_impl = THREAT_IMPL_AVX2;
+        else if (threat_cpu_supports(THREAT_IMPL_SSE2)) threat_impl = THREAT_IMPL_SSE2;
+        else                                            threat_impl = THREAT_IMPL_SCALAR;
+    }
+    return threat_impl;
+}
+
+// 수마다 갱신해 둔 player의 격자를 선택된 커널로 스캔 (판을 다시 펼치지 않음)
+int board_threat_scan(int player, threat_map_t *out) {
+    if (VAR(gs)->win_len != WIN_LEN) return 0;
+
+    const threat_grid_t *g = &gs->grid[player - 1];
+    int n = gs->size;
+    switch (board_threat_get_impl()) {
+    case THREAT_IMPL_AVX2: threat_scan_avx2(g, n, out); break;
+    case THREAT_IMPL_SSE2: threat_scan_sse2(g, n, out); break;
+    default:               threat_scan_scalar(g, n, out); break;
+    }
+    return 1;
+}
@@ -0,0 +1,74 @@
+// 경로: src/book.c
+// 역할: 오프닝 북 파일을 읽기 전용으로 mmap하고 해시로 이진 탐색함.
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "book.h"
+
+static void *book_map = NULL;
+static size_t book_map_len = 0;
+static const book_entry_t *book_entries = NULL;
+static uint32_t book_count = 0;
+
+int book_open(const char *path) {
+    book_close();
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return 0;
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(book_header_t)) {
+        close(fd);
+        return 0;
+    }
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);  // 매핑은 fd를 닫아도 유지됨
+    if (map == MAP_FAILED) return 0;
+
+    // 머리와 크기 확인 (잘린 파일이나 다른 형식이면 거부)
+    const book_header_t *h = map;
+    if (memcmp(h->magic, BOOK_MAGIC, sizeof(h->magic)) != 0 || h->version != BOOK_VERSION ||
+        (size_t)st.st_size != sizeof(*h) + (size_t)h->count * sizeof(book_entry_t)) {
+        munmap(map, (size_t)st.st_size);
+        return 0;
+    }
+
+    // 조회가 항목 전체에 흩어지므로 미리 읽기는 끔
+    madvise(map, (size_t)st.st_size, MADV_RANDOM);
+
+    book_map = map;
+    book_map_len = (size_t)st.st_size;
+    book_entries = (const book_entry_t *)(h + 1);
+    book_count = h->count;
+    return 1;
+}
+
+void book_close() {
+    if (book_map) munmap(book_map, book_map_len);
+    book_map = NULL;
+    book_map_len = 0;
+    book_entries = NULL;
+    book_count = 0;
+}
+
+int book_size() {
+    return (int)book_count;
+}
+
+int book_lookup(uint64_t hash, int *x, int *y) {
+    uint32_t lo = 0, hi = book_count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (book_entries[mid].hash < hash) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo == book_count || book_entries[lo].hash != hash) return 0;
+    *x = book_entries[lo].x;
+    *y = book_entries[lo].y;
+    return 1;
+}
@@ -1,302 +1,330 @@
 // 경로: src/client.c
 // 역할: 오목 게임 클라이언트 프로그램.
-//       - 유닉스 도메인 소켓(/tmp/omok.sock)을 통해 서버와 통신
-//       - 서버로부터 보드 상태, 턴 정보, 모드 선택 요청 등을 수신
+//       - 유닉스 도메인 소켓(/tmp/omok.sock)을 통해 서버와 통신 (연결/파싱/보드 미러는 clientlib.c)
+//       - 서버로부터 보드 상태, 턴 정보, 모드 선택 요청 등을 콜백으로 받아 안내 출력
 //       - 사용자의 명령(exit, restart, 좌표 입력)을 서버로 전송
 //       - 로컬 보드를 이용해 콘솔 화면에 오목판을 출력
+//       - "./client spectate"로 실행하면 읽기 전용 관전자로 접속
 
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
-#include <sys/socket.h>
-#include <sys/un.h>
+#include <errno.h>
+#include <poll.h>
 #include <unistd.h>
-#include <sys/select.h>
+#include <time.h>
 
-#define SOCK_PATH "/tmp/omok.sock"   // 서버와 통신할 유닉스 도메인 소켓 경로
-#define BOARD_SIZE 15                // 오목판 크기 (15x15)
+#include "client.h"  // 서버 연결과 로컬 보드 미러
+#include "render.h"
 
-// 클라이언트 로컬 보드
-// 서버에서 수신한 MOVE 명령을 반영하여 현재까지의 수들을 저장하는 용도
-int my_board[BOARD_SIZE][BOARD_SIZE];
+#define RESUME_RETRY 10              // 연결이 끊겼을 때 재접속 시도 횟수 (1초 간격)
 
-int my_player_id=0;   // 서버로부터 부여받은 내 플레이어 번호 (1 또는 2, 초기 0은 미할당 상태)
-int current_turn=0;   // 현재 턴인 플레이어 번호 (1 또는 2)
-
-// 클라이언트 로컬 보드 초기화 함수
-// my_board 전체를 0으로 채워 모든 칸을 빈 칸 상태로 만든다.
-void init_my_board() {
-    memset(my_board, 0, sizeof(my_board));
-}
+// 서버 연결 (로컬 보드: 서버에서 수신한 MOVE/SYNC를 반영한 conn.board)
+client_t conn;
+int spectating=0;     // 관전자 모드 여부 (1이면 좌표 입력 불가)
+int quit=0;           // 콜백에서 프로그램 종료를 요청하면 1
+time_t join_retry_at=0;  // 서버가 혼잡(BUSY)해 JOIN을 다시 보낼 시각 (0이면 없음)
 
 // UI 그리기 함수
-// my_board 배열의 내용을 기반으로 콘솔 화면에 오목판을 그린다.
+// conn.board 배열의 내용을 기반으로 콘솔 화면에 오목판을 그린다.
+// 처음에만 전체를 그리고 이후에는 바뀐 칸만 다시 그림 (render.c)
 void draw_board() {
-    // 화면 클리어 (ANSI Escape code, 터미널의 내용을 지우고 커서를 (1,1)로 이동)
-    printf("\033[2J\033[1;1H");
-
-    // 상단 x 좌표 인덱스 출력
-    printf("   ");
-    for (int i = 0; i < BOARD_SIZE; i++) printf("%2d ", i);
-    printf("\n");
-
-    // 각 행(y)에 대해 현재 돌 상태를 출력
-    for (int i = 0; i < BOARD_SIZE; i++) {
-        printf("%2d ", i);
-        for (int j = 0; j < BOARD_SIZE; j++) {
-            if (my_board[i][j] == 0) printf(" . ");      // 빈 칸
-            else if (my_board[i][j] == 1) printf(" O "); // Player 1 (흑)
-            else if (my_board[i][j] == 2) printf(" X "); // Player 2 (백)
+    render_board(conn.board, conn.size, "Commands: exit, restart, sync, x y");
+}
+
+// 서버가 모드 선택을 요구하는 경우: 모드 / 판 변형 / AI 난이도를 물어 MODE 명령 전송
+static void ask_mode() {
+    printf("\n=== 게임 모드 선택 ===\n");
+    printf("1) AI와 대전하기\n");
+    printf("2) 다른 사람(두 번째 클라이언트)을 기다리기\n");
+    printf("번호를 입력해 주세요 (1 또는 2): ");
+
+    // 키보드에서 한 줄 입력 받아서 정수로 파싱
+    char line[32];
+    int choice = 0;
+
+    if (!fgets(line, sizeof(line), stdin)) {
+        // 입력 실패 시 기본값 2 (상대 기다리기)
+        choice = 2;
+    } else {
+        if (sscanf(line, "%d", &choice) != 1) {
+            choice = 2;
         }
-        printf("\n");
     }
-    printf("\nCommands: exit, restart, x y\n");
+
+    if (choice != 1 && choice != 2) {
+        printf("잘못된 입력입니다. 2번(상대방 기다리기)로 처리합니다.\n");
+        choice = 2;
+    }
+
+    // 판 변형 선택 (입력이 없거나 잘못되면 기본 15x15 오목)
+    printf("\n=== 판 선택 ===\n");
+    printf("1) 15x15 오목 (5목)\n");
+    printf("2) 19x19 오목 (5목)\n");
+    printf("3) 19x19 육목 (6목)\n");
+    printf("4) 15x15 렌주룰 (흑 3-3/4-4/장목 금수)\n");
+    printf("번호를 입력해 주세요 (1 ~ 4): ");
+
+    static const int var_size[4] = { 15, 19, 19, 15 };
+    static const int var_win[4]  = { 5, 5, 6, 5 };
+    static const int var_rule[4] = { 0, 0, 0, 1 };
+    int var_choice = 1;
+    if (fgets(line, sizeof(line), stdin) == NULL ||
+        sscanf(line, "%d", &var_choice) != 1 ||
+        var_choice < 1 || var_choice > 4) {
+        var_choice = 1;
+    }
+
+    // AI 대전이면 난이도 선택 (입력이 없거나 잘못되면 3: 어려움)
+    int level = 3;
+    if (choice == 1) {
+        printf("\n=== AI 난이도 ===\n");
+        printf("1) 쉬움  2) 보통  3) 어려움  4) 전문가\n");
+        printf("번호를 입력해 주세요 (1 ~ 4): ");
+        if (fgets(line, sizeof(line), stdin) == NULL ||
+            sscanf(line, "%d", &level) != 1 || level < 1 || level > 4) {
+            level = 3;
+        }
+    }
+
+    client_send(&conn, "MODE %d %d %d %d %d\n", choice,
+                var_size[var_choice - 1], var_win[var_choice - 1],
+                var_rule[var_choice - 1], level);
+}
+
+// MOVE 수신: 보드 미러는 이미 반영됨, 화면만 갱신
+static void on_move(client_t *c, int player, int x, int y) {
+    (void)c; (void)player; (void)x; (void)y;
+    draw_board();
+}
+
+// TURN 수신 시 입력 프롬프트 갱신
+static void on_turn(client_t *c, int turn) {
+    if (spectating) {
+        printf("[관전] Player %d 차례\n", turn);
+    } else if (c->player_id == 0) {
+        // 아직 내 번호를 못 받은 상태일 수도 있으니 안전하게 안내만 출력
+        printf("턴 정보 수신: Player %d 차례\n", turn);
+    } else if (turn == c->player_id) {
+        printf(">> 지금은 당신(Player %d)의 차례입니다. 행 열을 입력하세요: ", c->player_id);
+    } else {
+        printf(">> 지금은 상대(Player %d)의 차례입니다. 기다려주세요.\n", turn);
+    }
+    fflush(stdout);
 }
 
-// fd에서 개행('\n')까지 한 줄을 읽어오는 함수
-// - 최대 size-1 글자까지 읽어 buf에 저장하고, 마지막에 '\0'을 추가
-// - 정상적으로 줄을 읽으면 그 길이를 반환, EOF/에러 시 0 이하를 반환
-int read_line(int fd, char* buf, int size) {
-    int i = 0;
-    char c;
-    while (i < size - 1) {
-        int n = read(fd, &c, 1);
-        if (n <= 0) return n;      // EOF 또는 에러
-        if (c == '\n') {          // 개행 만나면 문자열 종료
-            buf[i] = '\0';
-            return i;
+// GAME_OVER 수신 시 안내 메시지 출력 (게임 종료 상태는 conn.game_over)
+static void on_game_over(client_t *c, int winner) {
+    (void)c; (void)winner;
+    printf("Game Over. Type 'restart' to play again or 'exit'.\n");
+}
+
+// 그 밖의 서버 메시지 안내 (보드 미러는 라이브러리가 이미 반영함)
+static void on_line(client_t *c, const char *buf) {
+    // 디버깅용 (필요하면 주석 해제)
+    // printf("[Server] %s\n", buf);
+
+    if (strncmp(buf, "RESUMED", 7) == 0) {
+        printf("재접속에 성공했습니다. 게임을 이어갑니다.\n");
+    } else if (strncmp(buf, "ERR INVALID_TOKEN", 17) == 0) {
+        printf("이전 자리를 복구하지 못했습니다. 프로그램을 종료합니다.\n");
+        quit = 1;
+    } else if (strncmp(buf, "OPPONENT_DISCONNECTED", 21) == 0) {
+        // 상대방의 일시적인 연결 끊김 / 복귀 알림
+        int sec = 0;
+        sscanf(buf + 21, "%d", &sec);
+        printf("상대의 연결이 끊어졌습니다. %d초 동안 재접속을 기다립니다.\n", sec);
+    } else if (strncmp(buf, "OPPONENT_RESUMED", 16) == 0) {
+        printf("상대가 다시 접속했습니다.\n");
+    } else if (strncmp(buf, "MODE_SELECT", 11) == 0) {
+        ask_mode();
+    } else if (strncmp(buf, "BUSY", 4) == 0) {
+        // 서버 과부하: JOIN이 거절됐으면 잠시 뒤 다시 참가, AI 대전이 거절됐으면 모드를 다시 고름
+        int sec = 0;
+        sscanf(buf + 4, "%d", &sec);
+        if (c->player_id == 0) {
+            printf("서버가 혼잡합니다. %d초 뒤에 다시 참가합니다.\n", sec);
+            join_retry_at = time(NULL) + sec;
+        } else {
+            printf("서버가 혼잡해 지금은 AI 대전을 시작할 수 없습니다. "
+                   "%d초 뒤에 다시 고르거나 다른 모드를 고르세요.\n", sec);
+            ask_mode();
+        }
+    } else if (strncmp(buf, "OK PLAYER", 9) == 0) {
+        printf("you are player %d\n", c->player_id);
+    } else if (strncmp(buf, "SYNC ", 5) == 0) {
+        if (c->move_count > 0) draw_board();
+    } else if (strncmp(buf, "RESET", 5) == 0) {
+        draw_board();
+    } else if (strncmp(buf, "START", 5) == 0) {
+        draw_board();
+        printf("Game Started!\n");
+    } else if (strncmp(buf, "ERR FORBIDDEN_MOVE", 18) == 0) {
+        // 렌주룰 금수 자리에 두려고 한 경우
+        printf("렌주룰 금수(3-3, 4-4, 장목) 자리입니다. 다른 곳에 두세요.\n");
+    } else if (strncmp(buf, "CLOCK ", 6) == 0) {
+        // CLOCK <P1 ms> <P2 ms>: 턴 시계 남은 시간
+        long long t1, t2;
+        if (sscanf(buf + 6, "%lld %lld", &t1, &t2) == 2) {
+            printf("[남은 시간] P1 %lld초 / P2 %lld초\n", t1 / 1000, t2 / 1000);
         }
-        buf[i++] = c;
+    } else if (strncmp(buf, "TIMEOUT", 7) == 0) {
+        // TIMEOUT P<n>: 제한 시간 초과 패배
+        printf("\n⏰ %s: 제한 시간을 모두 사용했습니다.\n", buf + 8);
+    } else if (strncmp(buf, "WIN", 3) == 0) {
+        printf("\n🏆 %s 🏆\n", buf);
+    } else if (strncmp(buf, "OPPONENT_EXIT", 13) == 0) {
+        // 상대 클라이언트가 EXIT로 종료한 경우
+        printf("상대가 나갔습니다. 프로그램을 종료합니다.\n");
+        quit = 1;
     }
-    buf[i] = '\0';
-    return i;
 }
 
-int main() {
-    int fd;
-    struct sockaddr_un addr;
-    char buf[256];
-    int game_over = 0;  // 게임 종료 상태 플래그 (1이면 게임이 끝난 상태)
+static const client_callbacks_t ui_callbacks = { on_move, on_turn, on_game_over, on_line };
 
-    init_my_board();    // 시작 시 로컬 보드 초기화
+// 서버와의 연결이 끊긴 경우 토큰으로 좌석 복구를 시도
+// 성공하면 1 (서버가 OK PLAYER / RESUMED / SYNC를 보내줌), 실패 시 0
+int try_resume() {
+    if (conn.token[0] == '\0') return 0;
 
-    // 1. 유닉스 도메인 스트림 소켓 생성
-    fd = socket(AF_UNIX, SOCK_STREAM, 0);
-    if (fd == -1) {
-        perror("socket");
+    printf("\n서버와의 연결이 끊어졌습니다. 재접속을 시도합니다...\n");
+    for (int attempt = 1; attempt <= RESUME_RETRY; attempt++) {
+        sleep(1);
+        if (!client_connect(&conn, CLIENT_SOCK_PATH)) continue;
+        client_send(&conn, "RESUME %s\n", conn.token);
         return 1;
     }
+    return 0;
+}
 
-    // 2. 소켓 주소 구조체 초기화 및 경로 설정
-    memset(&addr, 0, sizeof(addr));
-    addr.sun_family = AF_UNIX;
-    strcpy(addr.sun_path, SOCK_PATH);
+// 키보드 입력 한 줄 처리. 프로그램을 끝내야 하면 0
+static int handle_input(const char *input) {
+    // 1) exit 명령: 서버에 EXIT 전송 후 종료
+    if (strcmp(input, "exit") == 0) {
+        client_send(&conn, "EXIT\n");
+        return 0;
+    }
+    // 관전자는 exit 외의 입력을 서버로 보내지 않음
+    if (spectating) {
+        printf("관전 중에는 'exit'만 입력할 수 있습니다.\n");
+        return 1;
+    }
+    // 2) restart 명령: 서버에 RESTART 전송
+    if (strcmp(input, "restart") == 0) {
+        client_send(&conn, "RESTART\n");
+        return 1;
+    }
+    // sync 명령: 놓친 수만 다시 받기 (오래 밀렸으면 서버가 전체 스냅샷으로 응답)
+    //            화면도 전체를 다시 그림 (다른 출력으로 판이 어지러워졌을 때)
+    if (strcmp(input, "sync") == 0) {
+        render_invalidate();
+        draw_board();
+        client_send(&conn, "SYNC %d\n", conn.move_count);
+        return 1;
+    }
 
-    // 3. 서버에 connect 시도
-    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+    // 3) 그 외의 입력은 모두 좌표 입력으로 간주 (내 턴일 때만 허용)
+    if (conn.game_over) {
+        printf("이미 게임이 종료되었습니다. 'restart' 또는 'exit'만 가능합니다.\n");
+        return 1;
+    }
+    if (conn.player_id == 0) {
+        printf("아직 플레이어 번호를 받지 못했습니다. 잠시만 기다려 주세요.\n");
+        return 1;
+    }
+    if (conn.turn != conn.player_id) {
+        printf("지금은 상대(Player %d)의 차례입니다. 좌표를 입력할 수 없습니다.\n", conn.turn);
+        return 1;
+    }
+    int r, c;
+    if (sscanf(input, "%d %d", &r, &c) != 2) {
+        printf("좌표는 '행 열' 형식으로 입력해 주세요. 예) 7 8\n");
+        return 1;
+    }
+    // ① 좌표 범위 검사 (0 ~ 판 크기-1)
+    if (r < 0 || r >= conn.size || c < 0 || c >= conn.size) {
+        printf("유효하지 않은 좌표값입니다. 0 ~ %d 사이의 값을 입력해 주세요.\n", conn.size - 1);
+        return 1;
+    }
+    // ② 이미 돌이 있는지 검사 (로컬 보드 기준)
+    if (conn.board[r][c] != 0) {
+        printf("이미 말이 있습니다. 다른 좌표를 선택해 주세요.\n");
+        return 1;
+    }
+    // 유효한 좌표인 경우 서버에 MOVE 명령 전송
+    client_send(&conn, "MOVE %d %d\n", r, c);
+    return 1;
+}
+
+int main(int argc, char *argv[]) {
+    client_init(&conn, &ui_callbacks, NULL);
+
+    if (argc > 1 && strcmp(argv[1], "spectate") == 0) {
+        spectating = 1;
+    }
+
+    // 서버에 connect 시도
+    if (!client_connect(&conn, CLIENT_SOCK_PATH)) {
         perror("connect");
-        close(fd);
         return 1;
     }
 
-    // 접속 메시지 전송 (JOIN 명령으로 서버에 참가 의사 전달)
-    write(fd, "JOIN user1\n", 11);
-    printf("서버에 연결되었습니다. 서버의 안내를 기다리는 중입니다...\n");
+    if (spectating) {
+        // 관전 요청 (서버가 현재 판 스냅샷을 SYNC 줄로 보내줌)
+        client_send(&conn, "SPECTATE\n");
+        printf("관전자로 접속했습니다. 'exit'로 종료할 수 있습니다.\n");
+    } else {
+        // 접속 메시지 전송 (JOIN 명령으로 서버에 참가 의사 전달)
+        client_send(&conn, "JOIN user1\n");
+        // 진행 중이던 판이 있으면 복원 (재접속 대비)
+        client_send(&conn, "SYNC\n");
+        printf("서버에 연결되었습니다. 서버의 안내를 기다리는 중입니다...\n");
+    }
+
+    // 메인 이벤트 루프: 서버 메시지 수신과 사용자 입력을 poll()로 동시에 처리
+    while (!quit) {
+        struct pollfd p[1 + CLIENT_POLLFDS];
+        p[0].fd = 0;              // 표준 입력 (키보드)
+        p[0].events = POLLIN;
+        p[0].revents = 0;
+        int n = client_pollfds(&conn, p + 1);
+
+        // JOIN을 다시 보낼 시각이 있으면 그때까지만 기다림
+        int timeout = -1;
+        if (client_pending(&conn)) {
+            timeout = 0;
+        } else if (join_retry_at) {
+            long left = (long)(join_retry_at - time(NULL)) * 1000;
+            timeout = left > 0 ? (int)left : 0;
+        }
+        if (poll(p, 1 + n, timeout) < 0 && errno != EINTR) break;
 
-    // 메인 이벤트 루프: 서버 메시지 수신과 사용자 입력을 select()로 동시에 처리
-    while (1) {
-        // 보드가 바뀔 때마다 다시 그림 (게임 오버가 아닐 때만)
-        // 현재는 MOVE 수신 시에만 보드를 그리도록 되어 있음
-        if (!game_over) {
-            // draw_board(); // 여기서 매번 그리면 깜빡일 수 있으니 MOVE 때 그림
+        // 서버로부터의 메시지 수신 처리 (줄마다 콜백 호출)
+        if (!client_handle(&conn, p + 1, n)) {
+            // 게임 중이었다면 토큰으로 같은 자리에 재접속 시도
+            if (!quit && try_resume()) continue;
+            break;  // 서버 종료 또는 에러 시 루프 탈출
         }
+        if (quit) break;
 
-        // 읽기용 파일 디스크립터 집합 구성 (stdin과 서버 소켓)
-        fd_set readfds;
-        FD_ZERO(&readfds);
-        FD_SET(0, &readfds);  // 표준 입력 (키보드)
-        FD_SET(fd, &readfds); // 서버 소켓
-
-        int max_fd = fd;
-
-        // 블로킹 select: 서버 메시지 또는 사용자 입력이 올 때까지 대기
-        if (select(max_fd + 1, &readfds, NULL, NULL, NULL) < 0) break;
-
-        // 서버로부터의 메시지 수신 처리
-        if (FD_ISSET(fd, &readfds)) {
-            int n = read_line(fd, buf, sizeof(buf));
-            if (n <= 0) break;  // 서버 종료 또는 에러 시 루프 탈출
-
-	    // 1) 서버가 모드 선택을 요구하는 경우 처리
-	     if (strncmp(buf, "MODE_SELECT", 11) == 0) {
-                printf("\n=== 게임 모드 선택 ===\n");
-                printf("1) AI와 대전하기\n");
-                printf("2) 다른 사람(두 번째 클라이언트)을 기다리기\n");
-                printf("번호를 입력해 주세요 (1 또는 2): ");
-
-                // 키보드에서 한 줄 입력 받아서 정수로 파싱
-                char line[32];
-                int choice = 0;
-
-                if (!fgets(line, sizeof(line), stdin)) {
-                    // 입력 실패 시 기본값 2 (상대 기다리기)
-                    choice = 2;
-                } else {
-                    if (sscanf(line, "%d", &choice) != 1) {
-                        choice = 2;
-                    }
-                }
-
-                if (choice != 1 && choice != 2) {
-                    printf("잘못된 입력입니다. 2번(상대방 기다리기)로 처리합니다.\n");
-                    choice = 2;
-                }
-
-                char msg[32];
-                snprintf(msg, sizeof(msg), "MODE %d\n", choice);
-                write(fd, msg, strlen(msg));
-
-                // 이 턴에서는 다른 처리는 하지 않고 다음 select로
-                continue;
-            }
-
-	    // 서버에서 "OK PLAYER1" 또는 "OK PLAYER2" 수신 시 내 플레이어 번호 설정
-	    if(strncmp(buf,"OK PLAYER", 9)==0){
-                   int p;
-                   if(sscanf(buf,"OK PLAYER%d",&p)==1){
-                           my_player_id=p;
-                           printf("you are player %d\n",my_player_id);
-                   }
-           }
-
-            // 디버깅용 (필요하면 주석 처리)
-            // printf("[Server] %s\n", buf);
-
-            // 1. MOVE 파싱 및 UI 업데이트
-            // 형식: MOVE <player> <x> <y>
-            int p, x, y;
-            if (strncmp(buf, "MOVE", 4) == 0) {
-                if (sscanf(buf + 5, "%d %d %d", &p, &x, &y) == 3) {
-                    if (x >= 0 && x < BOARD_SIZE && y >= 0 && y < BOARD_SIZE) {
-                        my_board[x][y] = p; // 서버에서 보낸 좌표에 해당 플레이어의 돌 기록
-                        draw_board();
-                    }
-                }
-            }
-
-            // 2. RESET 처리: 서버에서 RESET 수신 시 보드 및 상태 초기화
-            if (strncmp(buf, "RESET", 5) == 0) {
-                init_my_board();
-                draw_board();
-                game_over = 0;
-            }
-
-            // START 수신 시 게임 시작 안내 및 보드 출력
-            if (strncmp(buf, "START", 5) == 0) {
-                draw_board();
-                printf("Game Started!\n");
-            }
-
-            // TURN 수신 시 현재 턴 정보 업데이트 및 안내 메시지 출력
-            if (strncmp(buf, "TURN", 4) == 0) {
-                // TURN 메시지가 오면 입력 프롬프트 갱신
-                int turn;
-                sscanf(buf + 5, "%d", &turn);
-		current_turn = turn;
-
-		 if (my_player_id == 0) {
-                 // 아직 내 번호를 못 받은 상태일 수도 있으니 안전하게 안내만 출력
-                        printf("턴 정보 수신: Player %d 차례\n", current_turn);
-                } else if (current_turn == my_player_id) {
-                        printf(">> 지금은 당신(Player %d)의 차례입니다. 행 열을 입력하세요: ", my_player_id);
-                } else {
-                        printf(">> 지금은 상대(Player %d)의 차례입니다. 기다려주세요.\n", current_turn);
-                }
-
-                //printf(">> TURN Player %d: ", turn);
-                fflush(stdout);
-            }
-
-            // WIN 문자열이 포함된 경우 승리 메시지 출력
-            if (strstr(buf, "WIN")) {
-                printf("\n🏆 %s 🏆\n", buf);
-            }
-
-            // GAME_OVER 수신 시 게임 종료 상태로 전환하고 안내 메시지 출력
-            if (strstr(buf, "GAME_OVER")) {
-                game_over = 1;
-                printf("Game Over. Type 'restart' to play again or 'exit'.\n");
-            }
-
-	    // 상대 클라이언트가 EXIT로 종료한 경우 서버로부터 OPPONENT_EXIT를 수신
-	    if (strncmp(buf, "OPPONENT_EXIT", 13) == 0) {
-                printf("상대가 나갔습니다. 프로그램을 종료합니다.\n");
-                break;   // 메인 while(1) 탈출
-            }
+        if (join_retry_at && time(NULL) >= join_retry_at) {
+            join_retry_at = 0;
+            client_send(&conn, "JOIN user1\n");
         }
 
         // 표준 입력(키보드) 처리
-        if (FD_ISSET(0, &readfds)) {
+        if (p[0].revents & (POLLIN | POLLHUP)) {
             char input[128];
             if (!fgets(input, sizeof(input), stdin)) break;
 
             // 입력 문자열의 끝 개행 문자 제거
             input[strcspn(input, "\n")] = 0;
             if (strlen(input) == 0) continue;
-
-            // 1) exit 명령: 서버에 EXIT 전송 후 종료
-            if (strcmp(input, "exit") == 0) {
-                write(fd, "EXIT\n", 5);
-                break;
-
-            // 2) restart 명령: 서버에 RESTART 전송
-            } else if (strcmp(input, "restart") == 0) {
-                write(fd, "RESTART\n", 8);
-
-            // 3) 그 외의 입력은 모두 좌표 입력으로 간주
-            } else {
-		     // 여기서부터 "좌표 입력"은 내 턴일 때만 허용
-        	if (game_over) {
-            		printf("이미 게임이 종료되었습니다. 'restart' 또는 'exit'만 가능합니다.\n");
-            		continue;
-        	}
-        	if (my_player_id == 0) {
-            		printf("아직 플레이어 번호를 받지 못했습니다. 잠시만 기다려 주세요.\n");
-            		continue;
-        	}
-        	if (current_turn != my_player_id) {
-            		printf("지금은 상대(Player %d)의 차례입니다. 좌표를 입력할 수 없습니다.\n",
-                   	current_turn);
-            		continue;
-        	}
-                int r, c;
-                if (sscanf(input, "%d %d", &r, &c) == 2) {
-			// ① 좌표 범위 검사 (0 ~ BOARD_SIZE-1)
-                    if (r < 0 || r >= BOARD_SIZE || c < 0 || c >= BOARD_SIZE) {
-                        printf("유효하지 않은 좌표값입니다. 0 ~ %d 사이의 값을 입력해 주세요.\n",
-                               BOARD_SIZE - 1);
-                        continue;   // 서버로 보내지 않고 다시 입력 기다림
-                    }
-
-                    // ② 이미 돌이 있는지 검사 (로컬 보드 기준)
-                    if (my_board[r][c] != 0) {
-                        printf("이미 말이 있습니다. 다른 좌표를 선택해 주세요.\n");
-                        continue;   // 서버로 보내지 않고 다시 입력 기다림
-                    }
-
-                    // 유효한 좌표인 경우 서버에 MOVE 명령 전송
-                    char msg[64];
-                    snprintf(msg, sizeof(msg), "MOVE %d %d\n", r, c);
-                    write(fd, msg, strlen(msg));
-                }else {
-            		printf("좌표는 '행 열' 형식으로 입력해 주세요. 예) 7 8\n");
-        	}
-            }
+            if (!handle_input(input)) break;
         }
     }
 
-    // 서버 소켓 닫고 프로그램 종료
-    close(fd);
+    // 서버 연결 닫고 프로그램 종료
+    client_close(&conn);
     return 0;
 }
-
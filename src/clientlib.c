@@ -0,0 +1,337 @@
+// 경로: src/clientlib.c
+// 역할: 화면 없는 클라이언트 라이브러리 구현 (비블로킹 연결, 누적 줄 파서, 보드 미러, 콜백).
+//       줄 순서: 공유 메모리를 쓰는 동안 소켓으로 온 바이트는 해석하지 않고 쌓아 둠
+//       (서버는 링에 SHM_OFF를 남긴 뒤에야 소켓으로 다시 쓰므로, 링을 SHM_OFF까지 읽고 나서 해석)
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "client.h"
+#include "sync.h"
+
+static void clear_board(client_t *c) {
+    memset(c->board, 0, sizeof(c->board));
+    c->move_count = 0;
+    c->last_x = c->last_y = -1;
+}
+
+static void drop_shm_fds(client_t *c) {
+    for (int k = 0; k < SHM_FDS; k++) {
+        if (c->shm_fds[k] != -1) close(c->shm_fds[k]);
+        c->shm_fds[k] = -1;
+    }
+}
+
+void client_init(client_t *c, const client_callbacks_t *cb, void *user) {
+    memset(c, 0, sizeof(*c));
+    c->fd = -1;
+    c->state = CLIENT_CLOSED;
+    c->size = BOARD_SIZE;
+    c->win_len = WIN_LEN;
+    c->last_x = c->last_y = -1;
+    c->shm.tx_efd = c->shm.rx_efd = -1;
+    for (int k = 0; k < SHM_FDS; k++) c->shm_fds[k] = -1;
+    c->cb = cb;
+    c->user = user;
+}
+
+int client_connect(client_t *c, const char *path) {
+    struct sockaddr_un addr;
+    if (c->state != CLIENT_CLOSED) client_close(c);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd == -1) return 0;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path);
+
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0) {
+        c->state = CLIENT_OPEN;
+    } else if (errno == EINPROGRESS) {
+        c->state = CLIENT_CONNECTING;
+    } else {
+        // EAGAIN: 서버의 접속 대기열이 가득 참 (호출하는 쪽이 잠시 뒤 다시 시도)
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return 0;
+    }
+    c->fd = fd;
+    c->in_len = c->out_len = 0;
+    c->in_skip = 0;
+    return 1;
+}
+
+void client_close(client_t *c) {
+    if (c->shm_on) shm_chan_close(&c->shm);
+    c->shm_on = 0;
+    drop_shm_fds(c);
+    if (c->fd != -1) close(c->fd);
+    c->fd = -1;
+    c->state = CLIENT_CLOSED;
+}
+
+// 송신 버퍼를 가능한 만큼 보냄. 치명적 에러면 0
+static int client_flush(client_t *c) {
+    int off = 0;
+    while (off < c->out_len) {
+        ssize_t w = send(c->fd, c->out + off, c->out_len - off, MSG_NOSIGNAL);
+        if (w < 0 && errno == EINTR) continue;
+        if (w < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (w <= 0) return 0;
+        off += (int)w;
+    }
+    memmove(c->out, c->out + off, c->out_len - off);
+    c->out_len -= off;
+    return 1;
+}
+
+int client_send(client_t *c, const char *fmt, ...) {
+    char line[CLIENT_LINE_MAX];
+    va_list ap;
+    va_start(ap, fmt);
+    int len = vsnprintf(line, sizeof(line), fmt, ap);
+    va_end(ap);
+    if (c->state == CLIENT_CLOSED || len < 0 || len >= (int)sizeof(line)) return 0;
+
+    // 소켓에 밀린 명령이 있으면 순서를 지키기 위해 그 뒤에 붙임
+    if (c->shm_on && c->out_len == 0) return shm_write(&c->shm, line, len);
+
+    if (c->out_len + len > CLIENT_OUTBUF) return 0;
+    memcpy(c->out + c->out_len, line, len);
+    c->out_len += len;
+    if (c->state == CLIENT_OPEN) client_flush(c);   // 실패는 다음 client_handle에서 끊김으로 드러남
+    return 1;
+}
+
+int client_request_shm(client_t *c) {
+    if (c->shm_on) return 1;
+    return client_send(c, "SHM\n");
+}
+
+int client_pollfds(client_t *c, struct pollfd *p) {
+    if (c->state == CLIENT_CLOSED) return 0;
+    p[0].fd = c->fd;
+    p[0].events = POLLIN;
+    if (c->state == CLIENT_CONNECTING || c->out_len > 0) p[0].events |= POLLOUT;
+    p[0].revents = 0;
+    if (!c->shm_on) return 1;
+
+    shm_wait_prepare(&c->shm);   // 링이 비어 있지 않으면 client_pending이 1
+    p[1].fd = c->shm.rx_efd;
+    p[1].events = POLLIN;
+    p[1].revents = 0;
+    return 2;
+}
+
+int client_pending(const client_t *c) {
+    return c->shm_on && shm_pending(&c->shm);
+}
+
+// SYNC <수순> <턴> <종료여부> <인코딩된 보드>
+static void apply_sync(client_t *c, const char *args) {
+    int cnt, turn, over;
+    char enc[BOARD_MAX * BOARD_MAX + 1];
+    int cells[BOARD_MAX * BOARD_MAX];
+    // %361s: BOARD_MAX * BOARD_MAX
+    if (sscanf(args, "%d %d %d %361s", &cnt, &turn, &over, enc) != 4 ||
+        !sync_decode(enc, cells, c->size * c->size)) return;
+    for (int r = 0; r < c->size; r++)
+        for (int col = 0; col < c->size; col++)
+            c->board[r][col] = cells[r * c->size + col];
+    c->move_count = cnt;
+    c->turn = turn;
+    c->game_over = over;
+    c->last_x = c->last_y = -1;
+}
+
+// 줄 하나를 보드 미러에 반영하고 콜백 호출
+static void client_dispatch(client_t *c, char *line) {
+    const client_callbacks_t *cb = c->cb;
+    int a, b, d;
+
+    if (strncmp(line, "MOVE ", 5) == 0) {
+        if (sscanf(line + 5, "%d %d %d", &a, &b, &d) == 3 &&
+            b >= 0 && b < c->size && d >= 0 && d < c->size) {
+            c->board[b][d] = a;
+            c->move_count++;
+            c->last_x = b;
+            c->last_y = d;
+            if (cb && cb->on_move) cb->on_move(c, a, b, d);
+        }
+    } else if (strncmp(line, "TURN ", 5) == 0) {
+        if (sscanf(line + 5, "%d", &a) == 1) {
+            c->turn = a;
+            if (cb && cb->on_turn) cb->on_turn(c, a);
+        }
+    } else if (strncmp(line, "WIN P", 5) == 0) {
+        sscanf(line + 5, "%d", &c->winner);
+    } else if (strcmp(line, "GAME_OVER") == 0) {
+        c->game_over = 1;
+        if (cb && cb->on_game_over) cb->on_game_over(c, c->winner);
+    } else if (strncmp(line, "SYNC ", 5) == 0) {
+        apply_sync(c, line + 5);
+    } else if (strncmp(line, "VARIANT ", 8) == 0) {
+        // VARIANT <판 크기> <승리 길이> <규칙>: 이번 게임의 판 변형 (START/SYNC 직전에 수신)
+        if (sscanf(line + 8, "%d %d %d", &a, &b, &d) >= 2 && a > 0 && a <= BOARD_MAX) {
+            c->size = a;
+            c->win_len = b;
+            c->rule = d;
+            clear_board(c);
+        }
+    } else if (strcmp(line, "RESET") == 0 || strcmp(line, "START") == 0) {
+        if (line[0] == 'R') clear_board(c);
+        c->game_over = 0;
+        c->winner = 0;
+    } else if (strncmp(line, "OK PLAYER", 9) == 0) {
+        sscanf(line + 9, "%d", &c->player_id);
+    } else if (strncmp(line, "TOKEN ", 6) == 0) {
+        sscanf(line + 6, "%31s", c->token);
+    } else if (strcmp(line, "SPECTATING") == 0) {
+        c->spectating = 1;
+    } else if (strncmp(line, "SHM_OK", 6) == 0) {
+        // 서버는 이 줄 다음부터 링으로 씀. 붙지 못하면 이후 응답을 받을 길이 없으므로 끊음
+        if (c->shm_fds[0] == -1) {
+            client_close(c);
+            return;
+        }
+        int ok = shm_chan_attach(&c->shm, c->shm_fds);
+        for (int k = 0; k < SHM_FDS; k++) c->shm_fds[k] = -1;   // 실패해도 attach가 닫음
+        if (!ok) {
+            client_close(c);
+            return;
+        }
+        c->shm_on = 1;
+    } else if (strcmp(line, "SHM_OFF") == 0) {
+        if (c->shm_on) shm_chan_close(&c->shm);
+        c->shm_on = 0;
+    }
+
+    if (cb && cb->on_line && c->state != CLIENT_CLOSED) cb->on_line(c, line);
+}
+
+// 링과 소켓 버퍼에서 완성된 줄을 순서대로 처리. 콜백 안에서 연결이 닫히면 0
+static int client_drain(client_t *c) {
+    char line[SHM_LINE_MAX];
+    for (;;) {
+        if (c->shm_on) {
+            int len = shm_read_line(&c->shm, line, sizeof(line));
+            if (len <= 0) return 1;
+            if (line[len - 1] != '\n') {
+                // 너무 긴 줄은 버림 (서버는 줄을 한 번에 쓰므로 나머지 조각도 이미 링에 있음)
+                while ((len = shm_read_line(&c->shm, line, sizeof(line))) > 0 && line[len - 1] != '\n') {
+                }
+                continue;
+            }
+            line[strcspn(line, "\n")] = '\0';
+            client_dispatch(c, line);
+            if (c->state == CLIENT_CLOSED) return 0;
+            continue;
+        }
+
+        int off = 0;
+        char *nl;
+        while (!c->shm_on && (nl = memchr(c->in + off, '\n', c->in_len - off)) != NULL) {
+            *nl = '\0';
+            client_dispatch(c, c->in + off);
+            if (c->state == CLIENT_CLOSED) return 0;
+            off = (int)(nl - c->in) + 1;
+        }
+        memmove(c->in, c->in + off, c->in_len - off);
+        c->in_len -= off;
+        if (!c->shm_on) return 1;
+    }
+}
+
+// recvmsg 한 번 (SHM_OK에 딸려 오는 fd를 받기 위해 read 대신 사용)
+// 반환: 받은 바이트 수, 더 읽을 것 없음 -1, 끊김 0
+static ssize_t client_recv(client_t *c, char *buf, size_t size) {
+    char cbuf[CMSG_SPACE(sizeof(int) * SHM_FDS)];
+    struct iovec iov = { buf, size };
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cbuf;
+    msg.msg_controllen = sizeof(cbuf);
+
+    ssize_t r;
+    do {
+        r = recvmsg(c->fd, &msg, MSG_CMSG_CLOEXEC);
+    } while (r < 0 && errno == EINTR);
+    if (r < 0) return (errno == EAGAIN || errno == EWOULDBLOCK) ? -1 : 0;
+
+    for (struct cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+        if (cm->cmsg_level != SOL_SOCKET || cm->cmsg_type != SCM_RIGHTS) continue;
+        int cnt = (int)((cm->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+        int *fds = (int *)CMSG_DATA(cm);
+        drop_shm_fds(c);
+        for (int k = 0; k < cnt; k++) {
+            if (k < SHM_FDS) c->shm_fds[k] = fds[k];
+            else close(fds[k]);
+        }
+    }
+    return r;
+}
+
+int client_handle(client_t *c, const struct pollfd *p, int n) {
+    if (c->state == CLIENT_CLOSED) return 0;
+    short rev = n > 0 ? p[0].revents : 0;
+
+    if (c->shm_on) {
+        shm_wait_done(&c->shm);
+        if (n > 1 && (p[1].revents & POLLIN)) shm_clear_signal(&c->shm);
+    }
+
+    if (c->state == CLIENT_CONNECTING) {
+        if (!(rev & (POLLOUT | POLLERR | POLLHUP))) return 1;
+        int err = 0;
+        socklen_t elen = sizeof(err);
+        if (getsockopt(c->fd, SOL_SOCKET, SO_ERROR, &err, &elen) == -1 || err != 0) {
+            client_close(c);
+            return 0;
+        }
+        c->state = CLIENT_OPEN;
+    }
+
+    if (!client_drain(c)) return 0;
+
+    if (rev & (POLLIN | POLLHUP | POLLERR)) {
+        for (;;) {
+            if (c->in_len == CLIENT_INBUF) {
+                if (c->shm_on) break;        // 링을 SHM_OFF까지 읽기 전에는 소켓 줄을 해석하지 않음
+                c->in_len = 0;               // 개행 없이 버퍼를 채운 줄은 개행까지 버림
+                c->in_skip = 1;
+            }
+            ssize_t r = client_recv(c, c->in + c->in_len, CLIENT_INBUF - c->in_len);
+            if (r < 0) break;
+            if (r == 0) {
+                client_drain(c);
+                client_close(c);
+                return 0;
+            }
+            if (c->in_skip) {
+                char *nl = memchr(c->in + c->in_len, '\n', r);
+                if (!nl) continue;
+                int rest = (int)(c->in + c->in_len + r - (nl + 1));
+                memmove(c->in, nl + 1, rest);
+                c->in_len = rest;
+                c->in_skip = 0;
+            } else {
+                c->in_len += (int)r;
+            }
+            if (!client_drain(c)) return 0;
+        }
+    }
+
+    if (c->state == CLIENT_OPEN && c->out_len > 0 && !client_flush(c)) {
+        client_close(c);
+        return 0;
+    }
+    return 1;
+}
@@ -0,0 +1,121 @@
+// 경로: src/evalcache.c
+// 역할: 국면 분석 결과의 샤드별 LRU 캐시 구현.
+//       항목은 샤드 안의 배열 인덱스로 연결하므로 할당이 없고, 조회/저장/내보내기 모두 O(1)
+
+#include <string.h>
+#include "evalcache.h"
+
+typedef struct cache_entry {
+    uint64_t   key;
+    int        chain;         // 같은 버킷의 다음 항목 (-1: 끝)
+    int        prev, next;    // LRU 리스트 (prev 쪽이 최근)
+    analysis_t val;
+} cache_entry_t;
+
+typedef struct cache_shard {
+    cache_entry_t e[EVALCACHE_PER_SHARD];
+    int  bucket[EVALCACHE_BUCKETS];   // 버킷의 첫 항목 (-1: 비어 있음)
+    int  head, tail;                  // LRU 리스트 머리(가장 최근) / 꼬리(가장 오래됨)
+    int  count;                       // 차 있는 항목 수 (앞에서부터 채움)
+    long hits, misses, evictions;
+} cache_shard_t;
+
+static cache_shard_t shards[EVALCACHE_SHARDS];
+
+// 샤드는 키의 윗비트, 버킷은 아랫비트로 고름 (board_hash는 Zobrist 해시라 비트가 고르게 섞여 있음)
+static cache_shard_t *shard_of(uint64_t key) {
+    return &shards[key >> (64 - EVALCACHE_SHARD_BITS)];
+}
+
+static int bucket_of(uint64_t key) {
+    return (int)(key & (EVALCACHE_BUCKETS - 1));
+}
+
+static void lru_unlink(cache_shard_t *s, int i) {
+    cache_entry_t *e = &s->e[i];
+    if (e->prev >= 0) s->e[e->prev].next = e->next;
+    else s->head = e->next;
+    if (e->next >= 0) s->e[e->next].prev = e->prev;
+    else s->tail = e->prev;
+}
+
+static void lru_push_front(cache_shard_t *s, int i) {
+    cache_entry_t *e = &s->e[i];
+    e->prev = -1;
+    e->next = s->head;
+    if (s->head >= 0) s->e[s->head].prev = i;
+    s->head = i;
+    if (s->tail < 0) s->tail = i;
+}
+
+static int find(cache_shard_t *s, uint64_t key) {
+    for (int i = s->bucket[bucket_of(key)]; i >= 0; i = s->e[i].chain) {
+        if (s->e[i].key == key) return i;
+    }
+    return -1;
+}
+
+// 버킷 체인에서 항목 i를 뺌 (내보낼 때)
+static void chain_remove(cache_shard_t *s, int i) {
+    int *link = &s->bucket[bucket_of(s->e[i].key)];
+    while (*link >= 0 && *link != i) link = &s->e[*link].chain;
+    if (*link == i) *link = s->e[i].chain;
+}
+
+void evalcache_init() {
+    memset(shards, 0, sizeof(shards));
+    for (int k = 0; k < EVALCACHE_SHARDS; k++) {
+        cache_shard_t *s = &shards[k];
+        for (int b = 0; b < EVALCACHE_BUCKETS; b++) s->bucket[b] = -1;
+        s->head = s->tail = -1;
+    }
+}
+
+int evalcache_get(uint64_t key, analysis_t *out) {
+    cache_shard_t *s = shard_of(key);
+    int i = find(s, key);
+    if (i < 0) {
+        s->misses++;
+        return 0;
+    }
+    s->hits++;
+    if (s->head != i) {
+        lru_unlink(s, i);
+        lru_push_front(s, i);
+    }
+    *out = s->e[i].val;
+    return 1;
+}
+
+void evalcache_put(uint64_t key, const analysis_t *a) {
+    cache_shard_t *s = shard_of(key);
+    int i = find(s, key);
+    if (i >= 0) {
+        lru_unlink(s, i);
+    } else {
+        if (s->count < EVALCACHE_PER_SHARD) {
+            i = s->count++;
+        } else {
+            i = s->tail;
+            lru_unlink(s, i);
+            chain_remove(s, i);
+            s->evictions++;
+        }
+        int b = bucket_of(key);
+        s->e[i].key = key;
+        s->e[i].chain = s->bucket[b];
+        s->bucket[b] = i;
+    }
+    s->e[i].val = *a;
+    lru_push_front(s, i);
+}
+
+void evalcache_get_stats(evalcache_stats_t *out) {
+    memset(out, 0, sizeof(*out));
+    for (int k = 0; k < EVALCACHE_SHARDS; k++) {
+        out->hits += shards[k].hits;
+        out->misses += shards[k].misses;
+        out->evictions += shards[k].evictions;
+        out->entries += shards[k].count;
+    }
+}
@@ -0,0 +1,143 @@
+// 경로: src/fanout.c
+// 역할: 관전자 방송(fan-out)용 공유 메시지 버퍼와 송신 큐 구현.
+//       - 이벤트는 msgbuf 하나로 한 번만 포맷되고, 각 수신자 큐는 포인터만 보관
+//       - 버퍼는 크기 등급별 슬랩 풀에서 얻어 방송마다 malloc/free하지 않음
+//       - 송신은 비블로킹 writev로 처리하여 느린 관전자가 서버 루프를 막지 않음
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <sys/uio.h>
+#include "fanout.h"
+
+#define MSGBUF_PER_SLAB 64
+
+static const size_t class_size[MSGBUF_CLASSES] = { 64, 256, 1024 };
+static const char *class_name[MSGBUF_CLASSES] = { "msgbuf64", "msgbuf256", "msgbuf1024" };
+static pool_t class_pool[MSGBUF_CLASSES];
+static int pools_ready = 0;
+
+static void pools_init() {
+    for (int k = 0; k < MSGBUF_CLASSES; k++) {
+        pool_init(&class_pool[k], class_name[k], sizeof(msgbuf_t) + class_size[k] + 1,
+                  MSGBUF_PER_SLAB, 0, NULL);
+    }
+    pools_ready = 1;
+}
+
+const pool_t *msgbuf_pool(int k) {
+    if (!pools_ready) pools_init();
+    return &class_pool[k];
+}
+
+msgbuf_t *msgbuf_new(const char *data, size_t len) {
+    if (!pools_ready) pools_init();
+    int cls = 0;
+    while (cls < MSGBUF_CLASSES && len > class_size[cls]) cls++;
+
+    msgbuf_t *m = (cls < MSGBUF_CLASSES) ? pool_alloc(&class_pool[cls])
+                                         : malloc(sizeof(*m) + len + 1);
+    if (!m) return NULL;
+    m->refcnt = 1;
+    m->cls = cls;
+    m->len = len;
+    memcpy(m->data, data, len);
+    m->data[len] = '\0';
+    return m;
+}
+
+msgbuf_t *msgbuf_printf(const char *fmt, ...) {
+    char tmp[512];
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(tmp, sizeof(tmp), fmt, args);
+    va_end(args);
+    if (n < 0) return NULL;
+    if ((size_t)n >= sizeof(tmp)) n = sizeof(tmp) - 1;
+    return msgbuf_new(tmp, (size_t)n);
+}
+
+msgbuf_t *msgbuf_ref(msgbuf_t *m) {
+    if (m) m->refcnt++;
+    return m;
+}
+
+void msgbuf_unref(msgbuf_t *m) {
+    if (!m || --m->refcnt > 0) return;
+    if (m->cls < MSGBUF_CLASSES) pool_free(&class_pool[m->cls], m);
+    else free(m);
+}
+
+void outq_init(outq_t *q) {
+    q->head = 0;
+    q->count = 0;
+    q->off = 0;
+}
+
+void outq_clear(outq_t *q) {
+    while (q->count > 0) {
+        msgbuf_unref(q->items[q->head]);
+        q->head = (q->head + 1) % OUTQ_MAX;
+        q->count--;
+    }
+    outq_init(q);
+}
+
+int outq_push(outq_t *q, msgbuf_t *m) {
+    if (q->count >= OUTQ_MAX) return 0;
+    q->items[(q->head + q->count) % OUTQ_MAX] = msgbuf_ref(m);
+    q->count++;
+    return 1;
+}
+
+int outq_iov(const outq_t *q, struct iovec *iov) {
+    for (int k = 0; k < q->count; k++) {
+        msgbuf_t *m = q->items[(q->head + k) % OUTQ_MAX];
+        size_t skip = (k == 0) ? q->off : 0;
+        iov[k].iov_base = m->data + skip;
+        iov[k].iov_len  = m->len - skip;
+    }
+    return q->count;
+}
+
+void outq_consume(outq_t *q, size_t n) {
+    while (q->count > 0 && n > 0) {
+        msgbuf_t *m = q->items[q->head];
+        size_t rest = m->len - q->off;
+        if (n < rest) {
+            q->off += n;
+            return;
+        }
+        n -= rest;
+        msgbuf_unref(m);
+        q->head = (q->head + 1) % OUTQ_MAX;
+        q->count--;
+        q->off = 0;
+    }
+}
+
+int outq_flush(outq_t *q, int fd) {
+    while (q->count > 0) {
+        // 쌓인 버퍼들을 iovec으로 묶어 syscall 한 번에 전송
+        struct iovec iov[OUTQ_MAX];
+        int cnt = outq_iov(q, iov);
+
+        ssize_t n = writev(fd, iov, cnt);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            if (errno == EINTR) continue;
+            return -1;
+        }
+
+        // 보낸 만큼 큐에서 제거
+        outq_consume(q, (size_t)n);
+        if (q->count > 0 && q->off > 0) break;  // 커널 버퍼가 찼음
+    }
+    return q->count;
+}
+
+int outq_pending(const outq_t *q) {
+    return q->count > 0;
+}
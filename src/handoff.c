@@ -0,0 +1,160 @@
+// 경로: src/handoff.c
+// 역할: 핫 재시작 인계 구현 (새 바이너리 실행, 제어 소켓으로 바이트열/fd 전달).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include "handoff.h"
+
+int handoff_spawn(char *const argv[], pid_t *pid) {
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == -1) return -1;
+
+    pid_t p = fork();
+    if (p < 0) {
+        close(sv[0]);
+        close(sv[1]);
+        return -1;
+    }
+    if (p > 0) {
+        close(sv[1]);
+        *pid = p;
+        return sv[0];
+    }
+
+    // 자식: 제어 소켓만 남기고 닫음 (서버는 select를 쓰므로 열린 fd는 모두 FD_SETSIZE 미만)
+    int ctl = sv[1];
+    for (int fd = 3; fd < FD_SETSIZE; fd++) {
+        if (fd != ctl) close(fd);
+    }
+
+    int argc = 0;
+    while (argv[argc]) argc++;
+    char **args = malloc(sizeof(char *) * (argc + 3));
+    if (!args) _exit(127);
+    int n = 0;
+    for (int k = 0; k < argc; k++) {
+        if (strcmp(argv[k], HANDOFF_OPT) == 0) {
+            k++;   // 이전 인계 때 붙은 "-H <fd>"
+            continue;
+        }
+        args[n++] = argv[k];
+    }
+    char fdstr[16];
+    snprintf(fdstr, sizeof(fdstr), "%d", ctl);
+    args[n++] = HANDOFF_OPT;
+    args[n++] = fdstr;
+    args[n] = NULL;
+
+    execvp(args[0], args);
+    _exit(127);
+}
+
+int handoff_send(int sock, const void *data, size_t len) {
+    const char *p = data;
+    while (len > 0) {
+        ssize_t n = write(sock, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return 0;
+        p += n;
+        len -= (size_t)n;
+    }
+    return 1;
+}
+
+int handoff_recv(int sock, void *data, size_t len) {
+    char *p = data;
+    while (len > 0) {
+        ssize_t n = read(sock, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return 0;
+        p += n;
+        len -= (size_t)n;
+    }
+    return 1;
+}
+
+// fd 묶음은 한 바이트짜리 메시지에 제어 메시지로 실어 보냄
+// (스트림 소켓이라도 그 바이트를 recvmsg로 읽을 때 함께 받으므로 앞뒤 데이터와 섞이지 않음)
+typedef union fd_cmsg {
+    struct cmsghdr hdr;
+    char buf[CMSG_SPACE(sizeof(int) * HANDOFF_FDS_PER_MSG)];
+} fd_cmsg_t;
+
+int handoff_send_fds(int sock, const int *fds, int n) {
+    for (int off = 0; off < n; off += HANDOFF_FDS_PER_MSG) {
+        int cnt = (n - off < HANDOFF_FDS_PER_MSG) ? n - off : HANDOFF_FDS_PER_MSG;
+        char byte = 'F';
+        struct iovec iov = { &byte, 1 };
+        fd_cmsg_t u;
+        memset(&u, 0, sizeof(u));
+
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = u.buf;
+        msg.msg_controllen = CMSG_SPACE(sizeof(int) * cnt);
+
+        struct cmsghdr *c = CMSG_FIRSTHDR(&msg);
+        c->cmsg_level = SOL_SOCKET;
+        c->cmsg_type = SCM_RIGHTS;
+        c->cmsg_len = CMSG_LEN(sizeof(int) * cnt);
+        memcpy(CMSG_DATA(c), fds + off, sizeof(int) * cnt);
+
+        ssize_t r;
+        do {
+            r = sendmsg(sock, &msg, 0);
+        } while (r < 0 && errno == EINTR);
+        if (r != 1) return 0;
+    }
+    return 1;
+}
+
+int handoff_recv_fds(int sock, int *fds, int n) {
+    for (int off = 0; off < n; off += HANDOFF_FDS_PER_MSG) {
+        int cnt = (n - off < HANDOFF_FDS_PER_MSG) ? n - off : HANDOFF_FDS_PER_MSG;
+        char byte;
+        struct iovec iov = { &byte, 1 };
+        fd_cmsg_t u;
+
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = u.buf;
+        msg.msg_controllen = sizeof(u.buf);
+
+        ssize_t r;
+        do {
+            r = recvmsg(sock, &msg, 0);
+        } while (r < 0 && errno == EINTR);
+        if (r != 1 || (msg.msg_flags & MSG_CTRUNC)) return 0;
+
+        struct cmsghdr *c = CMSG_FIRSTHDR(&msg);
+        if (!c || c->cmsg_level != SOL_SOCKET || c->cmsg_type != SCM_RIGHTS ||
+            c->cmsg_len != CMSG_LEN(sizeof(int) * cnt)) {
+            return 0;
+        }
+        memcpy(fds + off, CMSG_DATA(c), sizeof(int) * cnt);
+    }
+    return 1;
+}
+
+int handoff_wait_ack(int sock, int timeout_ms) {
+    struct pollfd p = { sock, POLLIN, 0 };
+    int r;
+    do {
+        r = poll(&p, 1, timeout_ms);
+    } while (r < 0 && errno == EINTR);
+    if (r <= 0) return -1;
+
+    unsigned char byte;
+    if (read(sock, &byte, 1) != 1) return -1;
+    return byte;
+}
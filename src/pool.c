@@ -0,0 +1,149 @@
+// 경로: src/pool.c
+// 역할: 슬랩 풀과 아레나 구현.
+
+#include <stdlib.h>
+#include "pool.h"
+
+#define POOL_ALIGN 16
+
+// 슬롯: [링크][객체]. 링크를 객체 밖에 두어 반납해도 객체 내용(ctor가 만든 상태)이 유지됨
+struct pool_slot {
+    pool_slot_t *next;
+};
+
+struct pool_slab {
+    pool_slab_t *next;
+};
+
+#define SLOT_HDR  (((sizeof(pool_slot_t) + POOL_ALIGN - 1) / POOL_ALIGN) * POOL_ALIGN)
+#define SLAB_HDR  (((sizeof(pool_slab_t) + POOL_ALIGN - 1) / POOL_ALIGN) * POOL_ALIGN)
+
+void pool_init(pool_t *p, const char *name, size_t obj_size, int per_slab, int max_objs,
+               void (*ctor)(void *obj)) {
+    p->name = name;
+    p->obj_size = obj_size;
+    p->slot_size = SLOT_HDR + ((obj_size + POOL_ALIGN - 1) / POOL_ALIGN) * POOL_ALIGN;
+    p->per_slab = per_slab > 0 ? per_slab : 1;
+    p->max_objs = max_objs;
+    p->ctor = ctor;
+    p->slabs = NULL;
+    p->free_list = NULL;
+    p->capacity = 0;
+    p->in_use = 0;
+    p->peak = 0;
+    p->bytes = 0;
+}
+
+// 슬랩 하나를 만들어 객체들을 자유 목록에 넣음 (상한을 넘지 않는 만큼만)
+static int pool_grow(pool_t *p) {
+    int n = p->per_slab;
+    if (p->max_objs > 0 && p->capacity + n > p->max_objs) n = p->max_objs - p->capacity;
+    if (n <= 0) return 0;
+
+    size_t bytes = SLAB_HDR + (size_t)n * p->slot_size;
+    pool_slab_t *slab = malloc(bytes);
+    if (!slab) return 0;
+    p->bytes += bytes;
+    slab->next = p->slabs;
+    p->slabs = slab;
+
+    char *base = (char *)slab + SLAB_HDR;
+    for (int i = n - 1; i >= 0; i--) {
+        pool_slot_t *s = (pool_slot_t *)(base + (size_t)i * p->slot_size);
+        if (p->ctor) p->ctor((char *)s + SLOT_HDR);
+        s->next = p->free_list;
+        p->free_list = s;
+    }
+    p->capacity += n;
+    return 1;
+}
+
+void *pool_alloc(pool_t *p) {
+    if (!p->free_list && !pool_grow(p)) return NULL;
+    pool_slot_t *s = p->free_list;
+    p->free_list = s->next;
+    p->in_use++;
+    if (p->in_use > p->peak) p->peak = p->in_use;
+    return (char *)s + SLOT_HDR;
+}
+
+void pool_free(pool_t *p, void *obj) {
+    if (!obj) return;
+    pool_slot_t *s = (pool_slot_t *)((char *)obj - SLOT_HDR);
+    s->next = p->free_list;
+    p->free_list = s;
+    p->in_use--;
+}
+
+void pool_destroy(pool_t *p) {
+    while (p->slabs) {
+        pool_slab_t *next = p->slabs->next;
+        free(p->slabs);
+        p->slabs = next;
+    }
+    p->free_list = NULL;
+    p->capacity = 0;
+    p->in_use = 0;
+    p->bytes = 0;
+}
+
+// 청크: [머리][데이터 size 바이트]
+struct arena_chunk {
+    arena_chunk_t *next;
+    size_t         size;
+    size_t         off;
+};
+
+#define CHUNK_HDR (((sizeof(arena_chunk_t) + 7) / 8) * 8)
+
+void arena_init(arena_t *a, size_t chunk_size) {
+    a->head = NULL;
+    a->cur = NULL;
+    a->chunk_size = chunk_size;
+    a->used = 0;
+    a->capacity = 0;
+    a->peak = 0;
+}
+
+void *arena_alloc(arena_t *a, size_t size) {
+    size = (size + 7) & ~(size_t)7;
+
+    // 지금 청크에 자리가 없으면 다음 청크로 (reset 뒤에는 이미 있는 청크를 다시 씀)
+    while (a->cur && a->cur->off + size > a->cur->size && a->cur->next) {
+        a->cur = a->cur->next;
+        a->cur->off = 0;
+    }
+    if (!a->cur || a->cur->off + size > a->cur->size) {
+        size_t csize = size > a->chunk_size ? size : a->chunk_size;
+        arena_chunk_t *c = malloc(CHUNK_HDR + csize);
+        if (!c) return NULL;
+        c->next = NULL;
+        c->size = csize;
+        c->off = 0;
+        if (a->cur) a->cur->next = c;
+        else a->head = c;
+        a->cur = c;
+        a->capacity += csize;
+    }
+
+    void *ptr = (char *)a->cur + CHUNK_HDR + a->cur->off;
+    a->cur->off += size;
+    a->used += size;
+    if (a->used > a->peak) a->peak = a->used;
+    return ptr;
+}
+
+void arena_reset(arena_t *a) {
+    a->cur = a->head;
+    if (a->cur) a->cur->off = 0;
+    a->used = 0;
+}
+
+void arena_destroy(arena_t *a) {
+    while (a->head) {
+        arena_chunk_t *next = a->head->next;
+        free(a->head);
+        a->head = next;
+    }
+    arena_init(a, a->chunk_size);
+}
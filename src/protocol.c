@@ -20,6 +20,24 @@ int parse_command(const char* msg) {
     if (strncmp(msg, "RESTART", 7) == 0) {
         return CMD_RESTART;
     }
+    if (strncmp(msg, "SPECTATE", 8) == 0) {
+        return CMD_SPECTATE;
+    }
+    if (strncmp(msg, "SYNC", 4) == 0) {
+        return CMD_SYNC;
+    }
+    if (strncmp(msg, "RESUME", 6) == 0) {
+        return CMD_RESUME;
+    }
+    if (strncmp(msg, "STATS", 5) == 0) {
+        return CMD_STATS;
+    }
+    if (strncmp(msg, "SHM", 3) == 0) {
+        return CMD_SHM;
+    }
+    if (strncmp(msg, "ANALYZE", 7) == 0) {
+        return CMD_ANALYZE;
+    }
     return CMD_NONE;
 }
 
@@ -0,0 +1,67 @@
+// 경로: src/ratelimit.c
+// 역할: 연결별 명령 속도 제한(토큰 버킷) 구현.
+
+#include <stdio.h>
+#include <string.h>
+#include "ratelimit.h"
+
+// 사람이 직접 두는 클라이언트는 닿지 않고, 명령을 몰아 보내는 연결만 걸리는 정도
+rate_limit_t rate_limits[RATE_CLASSES] = {
+    { "all",     100, 200 },
+    { "move",     30,  60 },
+    { "analyze",  10,  20 },
+    { "stats",     5,  10 },
+    { "sync",     10,  20 },
+    { "strike",    2,  20 },
+};
+
+void rate_reset(rate_state_t *s) {
+    memset(s, 0, sizeof(*s));
+}
+
+int rate_take(rate_state_t *s, int cls, uint64_t now_ms) {
+    const rate_limit_t *l = &rate_limits[cls];
+    rate_bucket_t *b = &s->b[cls];
+    if (l->per_sec <= 0) return 1;
+
+    int64_t cap = (int64_t)l->burst * 1000;
+    if (b->last_ms == 0) {
+        b->tokens = cap;
+    } else if (now_ms > b->last_ms) {
+        b->tokens += (int64_t)(now_ms - b->last_ms) * l->per_sec;
+        if (b->tokens > cap) b->tokens = cap;
+    }
+    b->last_ms = now_ms;
+
+    if (b->tokens < 1000) return 0;
+    b->tokens -= 1000;
+    return 1;
+}
+
+int rate_parse(const char *spec) {
+    if (strcmp(spec, "off") == 0) {
+        for (int c = 0; c < RATE_CLASSES; c++) rate_limits[c].per_sec = 0;
+        return 1;
+    }
+
+    const char *p = spec;
+    while (*p) {
+        char key[32];
+        int per_sec, burst, len;
+        if (sscanf(p, "%31[a-z]=%d/%d%n", key, &per_sec, &burst, &len) != 3) return 0;
+        if (per_sec < 0 || burst < 1) return 0;
+
+        int c;
+        for (c = 0; c < RATE_CLASSES; c++) {
+            if (strcmp(rate_limits[c].name, key) == 0) break;
+        }
+        if (c == RATE_CLASSES) return 0;
+        rate_limits[c].per_sec = per_sec;
+        rate_limits[c].burst = burst;
+
+        p += len;
+        if (*p == ',') p++;
+        else if (*p) return 0;
+    }
+    return 1;
+}
@@ -0,0 +1,123 @@
+// 경로: src/render.c
+// 역할: 클라이언트 오목판 차분 렌더러 구현.
+//       화면 배치 (줄 번호는 1부터):
+//         1          열 번호
+//         2..n+1     판 (칸 하나는 " O " 세 글자, 돌 글자는 5 + 3 * 열 번째 칸)
+//         n+2        빈 줄
+//         n+3        안내 문구 (footer)
+//         n+4..끝    스크롤 영역 (클라이언트의 printf 안내 메시지가 여기서만 스크롤됨)
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include "render.h"
+
+#define RENDER_FRAME_MAX 8192
+#define BOARD_TOP 2                        // 판 첫 행의 화면 줄
+#define CELL_COL(j) (5 + 3 * (j))          // 열 j의 돌 글자 화면 칸
+
+static int shown[BOARD_MAX][BOARD_MAX];    // 지금 화면에 보이는 판
+static int shown_size = 0;
+static int shown_rows = 0;                 // 스크롤 영역을 잡을 때의 터미널 높이
+static int valid = 0;                      // 0이면 다음 화면은 전체 다시 그리기
+static int restore_registered = 0;
+
+static char frame[RENDER_FRAME_MAX];
+static int frame_len = 0;
+
+static void put(const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(frame + frame_len, sizeof(frame) - frame_len, fmt, ap);
+    va_end(ap);
+    if (n > 0) frame_len += n;
+    if (frame_len > (int)sizeof(frame) - 1) frame_len = sizeof(frame) - 1;
+}
+
+static void flush_frame() {
+    const char *p = frame;
+    int left = frame_len;
+    while (left > 0) {
+        ssize_t n = write(STDOUT_FILENO, p, left);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        p += n;
+        left -= n;
+    }
+    frame_len = 0;
+}
+
+static char glyph(int v) {
+    return v == 1 ? 'O' : (v == 2 ? 'X' : '.');
+}
+
+// 터미널 높이 (터미널이 아니면 0)
+static int term_rows() {
+    struct winsize ws;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_row > 0) return ws.ws_row;
+    return 0;
+}
+
+// 종료 시 스크롤 영역 해제 (DECSTBM은 커서를 맨 위로 옮기므로 커서 위치를 저장/복원)
+static void restore_terminal() {
+    fflush(stdout);
+    if (write(STDOUT_FILENO, "\0337\033[r\0338", 7) < 0) {}
+}
+
+static void draw_full(int board[BOARD_MAX][BOARD_MAX], int size, const char *footer,
+                      int rows, int region_top) {
+    put("\033[r\033[2J\033[H   ");
+    for (int j = 0; j < size; j++) put("%2d ", j);
+    put("\n");
+    for (int i = 0; i < size; i++) {
+        put("%2d ", i);
+        for (int j = 0; j < size; j++) put(" %c ", glyph(board[i][j]));
+        put("\n");
+    }
+    put("\n%s\n", footer);
+    if (rows > 0) put("\033[%d;%dr\033[%d;1H", region_top, rows, region_top);
+}
+
+void render_board(int board[BOARD_MAX][BOARD_MAX], int size, const char *footer) {
+    // 앞서 printf로 쌓인 안내 메시지가 먼저 나가야 화면 순서가 맞음
+    fflush(stdout);
+
+    int rows = term_rows();
+    int region_top = BOARD_TOP + size + 2;
+    int fits = rows > region_top;
+
+    if (!valid || !fits || size != shown_size || rows != shown_rows) {
+        draw_full(board, size, footer, fits ? rows : 0, region_top);
+        for (int i = 0; i < size; i++) memcpy(shown[i], board[i], sizeof(int) * size);
+        shown_size = size;
+        shown_rows = rows;
+        valid = fits;
+        if (fits && !restore_registered) {
+            atexit(restore_terminal);
+            restore_registered = 1;
+        }
+    } else {
+        // 바뀐 칸만: 커서 저장 → 칸마다 이동 + 글자 → 커서 복원 (입력 중인 줄은 그대로)
+        put("\0337");
+        int changed = 0;
+        for (int i = 0; i < size; i++) {
+            for (int j = 0; j < size; j++) {
+                if (shown[i][j] == board[i][j]) continue;
+                put("\033[%d;%dH%c", BOARD_TOP + i, CELL_COL(j), glyph(board[i][j]));
+                shown[i][j] = board[i][j];
+                changed++;
+            }
+        }
+        put("\0338");
+        if (changed == 0) frame_len = 0;
+    }
+    flush_frame();
+}
+
+void render_invalidate() {
+    valid = 0;
+}
@@ -16,9 +16,27 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <time.h>
+#include <errno.h>
+#include <stdint.h>
+#include <poll.h>
 
 #include "board.h"
+#include "game.h"
+#include "pool.h"
 #include "protocol.h"
+#include "fanout.h"
+#include "sync.h"
+#include "timer.h"
+#include "book.h"
+#include "vcf.h"
+#include "ai.h"
+#include "wal.h"
+#include "handoff.h"
+#include "uring.h"
+#include "shmring.h"
+#include "evalcache.h"
+#include "ratelimit.h"
+#include "trace.h"
 #include "log.h" // 로그 헤더 추가
 
 #define SOCK_PATH "/tmp/omok.sock"  // 서버가 사용하는 유닉스 도메인 소켓 경로
@@ -28,138 +46,765 @@
 #define MODE_NONE 0                 // 아직 모드가 선택되지 않은 상태
 #define MODE_PVP 1                  // 사람 vs 사람 모드
 #define MODE_PVAI 2                 // 사람 vs AI 모드
+#define MAX_SPECTATORS 512          // 동시 관전자 수 상한 (select의 FD_SETSIZE 이내)
+#define SYNC_DELTA_MAX 16           // SYNC <n> 요청 시 이 수 이하로 밀려 있으면 MOVE 델타로 응답
+#define DEFAULT_GRACE_SEC 30        // 연결이 끊긴 플레이어의 자리를 유지하는 기본 시간(초)
+#define DEFAULT_TIME_BANK_SEC 600   // 플레이어별 기본 제한 시간(초), 0이면 턴 시계 사용 안 함
+#define DEFAULT_IDLE_SEC 60         // 아무 명령도 보내지 않는 연결을 정리하기까지의 기본 시간(초)
+#define DEFAULT_TRACE_FILE "omok-trace.json"  // 이벤트 추적을 끌 때 저장하는 기본 파일 (trace.h)
 
 int server_fd = -1;
 int running = 1;        // 서버 메인 루프 실행 플래그 (시그널에 의해 0으로 변경됨)
+
+// 핫 재시작 (SIGUSR2: 같은 경로의 새 바이너리에 듣기 소켓, 연결, 게임 상태를 넘기고 종료)
+// 배포: 바이너리를 바꿔 놓고 kill -USR2 $(cat /tmp/omok.pid)
+int upgrade_requested = 0;
+int handed_off = 0;     // 인계를 마쳤으면 1 (종료 시 소켓/PID 파일을 지우지 않음)
+
+// 이벤트 추적 (SIGUSR1로 켜고 끔, 끌 때 trace_path에 Chrome trace JSON 저장)
+// 파일 쓰기가 루프를 멈추게 하므로 연결의 명령으로는 켜고 끌 수 없고 서버 운영자만 (시그널)
+// 확인: kill -USR1 $(cat /tmp/omok.pid) 로 켜고, 재현한 뒤 한 번 더 보내 끄고 chrome://tracing에서 열기
+const char *trace_path = DEFAULT_TRACE_FILE;
+int trace_toggle_requested = 0;
+char **saved_argv;      // 새 바이너리에 그대로 넘길 명령줄
 int game_mode=MODE_NONE;
 int rand_initialized = 0;
 
+// 게임 상태 (타이머 콜백에서도 접근하므로 전역으로 관리)
+int client_fd[MAX_CLIENTS] = { -1, -1 }; // 클라이언트 소켓 FD
+int joined[MAX_CLIENTS]    = { 0, 0 };   // 각 클라이언트의 JOIN 여부
+int current_turn = 1;                    // 현재 턴인 플레이어 (1 또는 2)
+int game_over = 0;                       // 게임 종료 여부 플래그
+int player_count = 0;                    // 플레이어 슬롯을 차지한 연결 수 (유예 중인 자리 포함)
+
+// 세션 재개 관련
+// - JOIN 시 좌석마다 토큰을 발급하고, 연결이 끊기면 grace_sec 동안 자리를 유지
+// - 그 사이 같은 토큰으로 RESUME 하면 새 fd를 기존 좌석에 다시 연결
+int grace_sec = DEFAULT_GRACE_SEC;
+char seat_token[MAX_CLIENTS][17];
+int seat_held[MAX_CLIENTS];              // 1이면 연결은 끊겼지만 자리 유지 중
+wtimer_t seat_timer[MAX_CLIENTS];
+timer_wheel_t timers;
+
+// 턴 시계 (플레이어별 남은 시간, 자기 차례에만 줄어들고 0이 되면 패배)
+int time_bank_sec = DEFAULT_TIME_BANK_SEC;
+int64_t bank_ms[MAX_CLIENTS];
+int clock_player = 0;                    // 시계가 돌고 있는 플레이어 (0이면 정지)
+uint64_t turn_started_ms = 0;
+wtimer_t turn_timer;
+int in_game = 0;                         // START 이후 게임 진행 중이면 1
+
+// 유휴 연결 정리 (JOIN/SPECTATE 없이 조용한 연결, 게임 밖에서 조용한 플레이어)
+int idle_sec = DEFAULT_IDLE_SEC;
+wtimer_t idle_timer[MAX_CLIENTS];
+
+// 관전자 연결 목록
+// 슬롯마다 연결 기록을 가리키고(NULL이면 빈 슬롯), 기록은 conn_pool에서 얻고 돌려줌
+typedef struct spec_conn {
+    int      fd;           // 관전자 소켓, 비블로킹 모드로 사용
+    int      attached;     // SPECTATE를 보내 실제로 방송을 받는 중인지 여부
+    outq_t   q;            // 송신 큐 (공유 msgbuf 포인터만 보관)
+    wtimer_t idle_timer;   // SPECTATE 전까지만 사용
+} spec_conn_t;
+
+#define CONN_PER_SLAB 32
+
+spec_conn_t *spec[MAX_SPECTATORS];
+pool_t conn_pool;
+int spec_count = 0;
+int spec_slot_of[FD_SETSIZE];   // fd → 관전자 슬롯 + 1 (0이면 관전자가 아님), 완료 이벤트의 fd로 슬롯을 찾음
+
+// 명령 속도 제한 (ratelimit.h, 연결이 좌석과 관전자 슬롯을 옮겨 다녀도 이어지도록 fd별)
+rate_state_t conn_rate[FD_SETSIZE];
+long rate_limited = 0;       // ERR RATE_LIMITED로 거절한 명령 수
+long rate_disconnects = 0;   // 계속 한도를 넘겨 끊은 연결 수
+
+// 연결별 입력 줄 조립 (읽기 한 번에 줄이 나뉘어 오거나 여러 줄이 붙어 와도 개행 단위로 처리)
+// 개행까지 CONN_LINE_MAX - 1바이트를 넘는 줄은 ERR LINE_TOO_LONG으로 거절하고 개행까지 버림
+// 가장 긴 명령은 19x19 판을 다 채운 수순의 ANALYZE M 요청 (361수 × "xx yy " 약 2.2KB)
+#define CONN_LINE_MAX 4096
+typedef struct conn_inbuf {
+    int  len;                  // 아직 개행이 오지 않은 앞부분 길이
+    int  discard;              // 1이면 너무 긴 줄을 버리는 중 (개행이 오면 풀림)
+    char data[CONN_LINE_MAX];
+} conn_inbuf_t;
+conn_inbuf_t conn_in[FD_SETSIZE];
+
+// 게임 기록 (판 상태와 게임별 아레나)
+// - 기록은 game_pool에서 얻고, 게임을 치우면(EXIT) 돌려줌
+// - 아레나는 게임 중 생기는 가변 크기 데이터(끝난 게임의 기록 줄 등)에 쓰고
+//   START/RESET 때 reset만 하므로, 청크는 다음 게임에 그대로 다시 쓰임
+typedef struct game {
+    game_state_t state;
+    arena_t      arena;
+} game_t;
+
+#define GAME_PER_SLAB   4
+#define GAME_ARENA_CHUNK 4096
+
+pool_t game_pool;
+game_t *cur_game = NULL;
+
+// 오프닝 북(-b)과 게임 기록 파일(-r, 북 빌드용)
+const char *book_path = NULL;
+FILE *record_fp = NULL;
+
+// 게임 영속화 (-w <디렉토리>, wal.h)
+// - 게임 시작/수/종료/좌석 토큰을 로그에 남기고 이벤트 루프 한 바퀴마다 한 번 커밋(그룹 커밋)
+// - 수와 게임 결과는 방송 전에 커밋하므로(persist_sync) 알린 수는 크래시에도 남음
+//   (좌석 토큰 등 나머지 레코드는 다음 바퀴 커밋까지 잃을 수 있고, 재접속 후 SYNC로 맞춤)
+// - 재시작하면 복구한 게임의 좌석을 유예 상태로 잡아 두어 기존 토큰으로 RESUME 가능
+const char *wal_dir = NULL;
+
+// 입출력 백엔드 (-u: io_uring, 준비에 실패하거나 지정하지 않으면 select)
+// 접속/명령 처리 함수는 같고, 기다리는 방법과 송신 제출만 다름 (uring.h)
+int use_uring = 0;
+
+// io_uring일 때 관전자가 아닌 연결(플레이어 좌석, JOIN 전 연결)의 송신 큐 (fd별)
+// 응답과 방송을 write 대신 여기에 쌓고, 루프가 한 바퀴분을 연결마다 sendmsg 하나로 제출
+outq_t conn_outq[FD_SETSIZE];
+
+// 공유 메모리 전송 (SHM 명령, shmring.h)
+// 같은 호스트의 봇이 플레이어 연결에서 협상하면 이후 명령/응답은 링으로 오가고 소켓은 연결 확인용으로만 씀
+// 링으로 들어온 줄은 소켓으로 받은 것과 같은 처리 함수로 넘김
+#define SHM_MAX_CONNS     4
+#define SHM_DISPATCH_MAX 64         // 한 바퀴에 채널 하나에서 꺼내는 줄 수 (다른 연결이 밀리지 않도록)
+
+typedef struct shm_conn {
+    int        active;
+    int        fd;                  // 협상한 소켓
+    shm_chan_t chan;
+} shm_conn_t;
+
+shm_conn_t shm_conns[SHM_MAX_CONNS];
+int shm_count = 0;
+long shm_lines_in = 0;              // 링으로 받은 명령 줄 수
+long shm_msgs_out = 0;              // 링으로 보낸 메시지 수
+long shm_wakeups_closed = 0;        // 닫힌 채널이 상대를 깨운 횟수 (STATS 누계용)
+
 // board.c 내부의 보드 상태를 참조하기 위한 함수
 // 0: 빈칸, 1: 사람(P1), 2: AI(P2)
 extern int get_stone(int x, int y);
 
 // 보드에서 (x,y)가 유효한 좌표인지 검사하는 함수
 static int in_range(int x, int y) {
-    return (x >= 0 && x < BOARD_SIZE && y >= 0 && y < BOARD_SIZE);
+    int n = board_get_size();
+    return (x >= 0 && x < n && y >= 0 && y < n);
+}
+
+// 연결의 공유 메모리 채널 (없으면 NULL)
+static shm_chan_t *conn_shm(int fd) {
+    for (int k = 0; k < SHM_MAX_CONNS && shm_count > 0; k++) {
+        if (shm_conns[k].active && shm_conns[k].fd == fd) return &shm_conns[k].chan;
+    }
+    return NULL;
+}
+
+// io_uring 송신 큐에 쌓음 (큐가 넘치면 읽지 않는 연결로 보고 소켓을 끊음)
+static void conn_queue(int fd, msgbuf_t *m) {
+    if (outq_push(&conn_outq[fd], m)) return;
+    log_write("Send queue full: FD=%d", fd);
+    shutdown(fd, SHUT_RDWR);
 }
 
-// 한 방향(dx, dy)으로 같은 색(player) 돌이 몇 개 연속되는지 세는 함수
-// 시작점은 (x,y)의 바로 다음 칸부터 검사
-static int count_dir(int x, int y, int dx, int dy, int player) {
-    int cnt = 0;
-    int nx = x + dx;
-    int ny = y + dy;
+// io_uring이면 이 연결의 송신을 큐로 모으는지 (관전자는 자기 큐를 따로 씀)
+static int conn_queued(int fd) {
+    return use_uring && fd >= 0 && fd < FD_SETSIZE && spec_slot_of[fd] == 0;
+}
 
-    while (in_range(nx, ny) && get_stone(nx, ny) == player) {
-        cnt++;
-        nx += dx;
-        ny += dy;
+// 연결로 보내기: 공유 메모리 채널이 있으면 링으로, io_uring이면 송신 큐로, 아니면 소켓으로
+// 링이 가득 찼으면 읽지 않는 봇으로 보고 소켓을 끊음 (다음 바퀴에 끊긴 연결로 정리됨)
+static void conn_write(int fd, const void *data, size_t len) {
+    shm_chan_t *c = conn_shm(fd);
+    if (!c && conn_queued(fd)) {
+        msgbuf_t *m = msgbuf_new(data, len);
+        if (!m) return;
+        conn_queue(fd, m);
+        msgbuf_unref(m);
+        return;
     }
-    return cnt;
+    if (!c) {
+        TRACE_BEGIN("write", fd);
+        write(fd, data, len);
+        TRACE_END("write");
+        return;
+    }
+    if (shm_write(c, data, len)) {
+        shm_msgs_out++;
+        return;
+    }
+    log_write("Shared memory ring full: FD=%d", fd);
+    shutdown(fd, SHUT_RDWR);
 }
 
-// (x,y)에 player가 둔다고 가정했을 때, 해당 위치를 기준으로 만들 수 있는
-// 최대 연속 길이(가로, 세로, 두 대각선 중 최대)를 계산
-static int longest_line_if(int x, int y, int player) {
-    // (x,y)는 현재 빈칸이라고 가정하고, 여기에 player의 돌이 새로 놓인다고 생각
-    static const int dirs[4][2] = {
-        {1, 0},  // 가로
-        {0, 1},  // 세로
-        {1, 1},  // 대각 ↘
-        {1, -1}  // 대각 ↗
-    };
+// 연결의 공유 메모리 채널 닫기 (farewell이 있으면 링에 남겨 클라이언트가 소켓으로 돌아가게 함)
+static void shm_detach(int fd, const char *farewell) {
+    for (int k = 0; k < SHM_MAX_CONNS && shm_count > 0; k++) {
+        if (!shm_conns[k].active || shm_conns[k].fd != fd) continue;
+        shm_chan_t *c = &shm_conns[k].chan;
+        if (farewell) shm_write(c, farewell, strlen(farewell));
+        if (use_uring) uring_forget(c->rx_efd);
+        shm_wakeups_closed += c->wakeups;
+        shm_chan_close(c);
+        shm_conns[k].active = 0;
+        shm_count--;
+        log_write("Shared memory channel closed: FD=%d", fd);
+        return;
+    }
+}
+
+// SHM 요청: 채널을 만들어 "SHM_OK <링 크기>" 줄과 함께 fd를 넘김 (실패 시 0, 소켓 그대로)
+static int shm_attach(int fd) {
+    if (conn_shm(fd)) return 0;
+    int k = 0;
+    while (k < SHM_MAX_CONNS && shm_conns[k].active) k++;
+    if (k == SHM_MAX_CONNS) return 0;
+
+    int fds[SHM_FDS];
+    if (!shm_chan_create(&shm_conns[k].chan, fds)) return 0;
+    char line[32];
+    snprintf(line, sizeof(line), "SHM_OK %d\n", SHM_RING_SIZE);
+    int ok = shm_send_fds(fd, line, fds, SHM_FDS);
+    close(fds[0]);
+    if (!ok) {
+        shm_chan_close(&shm_conns[k].chan);
+        return 0;
+    }
+    shm_conns[k].fd = fd;
+    shm_conns[k].active = 1;
+    shm_count++;
+    if (use_uring) uring_watch_poll(shm_conns[k].chan.rx_efd);
+    log_write("Shared memory channel attached: FD=%d", fd);
+    return 1;
+}
 
-    int best = 0;
-    for (int k = 0; k < 4; k++) {
-        int dx = dirs[k][0];
-        int dy = dirs[k][1];
+// 잠들기 전: 모든 채널에 깨워 달라고 표시. 이미 읽을 것이 있는 채널이 있으면 1 (기다리지 말아야 함)
+static int shm_arm() {
+    int ready = 0;
+    for (int k = 0; k < SHM_MAX_CONNS && shm_count > 0; k++) {
+        if (shm_conns[k].active && !shm_wait_prepare(&shm_conns[k].chan)) ready = 1;
+    }
+    return ready;
+}
 
-        int len = 1; // (x,y)에 새로 놓는 돌 1개 포함
-        len += count_dir(x, y, dx,  dy, player);
-        len += count_dir(x, y, -dx, -dy, player);
+// eventfd가 울린 채널의 신호 비우기
+static void shm_signaled(int efd) {
+    for (int k = 0; k < SHM_MAX_CONNS && shm_count > 0; k++) {
+        if (shm_conns[k].active && shm_conns[k].chan.rx_efd == efd) shm_clear_signal(&shm_conns[k].chan);
+    }
+}
 
-        if (len > best) best = len;
+// 읽을 것이 있는 채널이 있는지 (메모리만 봄, AI 미리 계산 중단 확인용)
+static int shm_any_pending() {
+    for (int k = 0; k < SHM_MAX_CONNS && shm_count > 0; k++) {
+        if (shm_conns[k].active && shm_pending(&shm_conns[k].chan)) return 1;
     }
-    return best;
+    return 0;
+}
+
+// AI 난이도별 CPU 할당량 창 (ai.h의 quota_ms)
+// 할당량을 다 쓴 레벨의 게임은 창이 끝날 때까지 한 단계 낮은 레벨로 계산함
+#define AI_QUOTA_WINDOW_SEC 60
+
+// 레벨별 사용량 (STATS로 조회)
+typedef struct ai_usage {
+    long     moves;        // 이 레벨로 계산한 수
+    long     downgraded;   // 할당량 초과로 이 레벨에서 낮춰 계산한 수
+    uint64_t cpu_us;       // 누적 CPU 시간
+    uint64_t window_us;    // 현재 창에서 쓴 CPU 시간 (미리 계산한 시간 포함)
+    long     ponder_hits;  // 미리 계산해 둔 응수로 바로 둔 수
+    uint64_t ponder_us;    // 미리 계산에 쓴 누적 CPU 시간
+} ai_usage_t;
+
+int ai_level = AI_LEVEL_DEFAULT;     // 현재 게임의 난이도
+ai_usage_t ai_usage[AI_LEVEL_MAX + 1];
+wtimer_t ai_quota_timer;
+
+// 국면 분석 (ANALYZE <N> [<판 크기> <승리 길이> <규칙> M <x y ...> | S <인코딩된 보드>])
+// - 국면을 생략하면 현재 게임, M은 P1부터 번갈아 둔 수순, S는 SYNC와 같은 인코딩의 판
+// - 분석 전용 판(analyze_state)에 국면을 만들어 캐시(evalcache)를 먼저 찾고, 없으면 대기열에
+//   넣었다가 빈 시간에 계산해 응답. 같은 국면을 기다리는 요청은 작업 하나에 묶음
+// - 계산: 후보 평가 상위 ANALYSIS_TOP_MAX개(ai_rank_moves) + ANALYZE_LEVEL의 AI 선택(ai_choose_move)
+// - 실시간 게임이 항상 먼저: 입력도 미리 계산할 일도 없을 때만 한 작업씩 계산하고, 계산 중에
+//   입력이 오면 탐색을 멈추고 다음 빈 시간에 같은 작업부터 다시. 쓴 CPU는 AI 레벨과 따로
+//   ANALYZE_QUOTA_MS 창 할당량에 청구하고, 다 쓰면 창이 끝날 때까지 캐시에 없는 요청은 기다림
+#define ANALYZE_LEVEL     3
+#define ANALYZE_QUOTA_MS  10000   // AI_QUOTA_WINDOW_SEC 창마다
+#define ANALYZE_QUEUE_MAX 32
+#define ANALYZE_WAITERS   8       // 작업 하나에 묶는 요청 수
+
+typedef struct analyze_job {
+    uint64_t key;                              // 국면 해시 + 마지막 수 (캐시 키, analyze_key)
+    int variant, rule;
+    int nmoves;
+    unsigned char moves[BOARD_MAX * BOARD_MAX][2];   // P1부터 번갈아 둔 수순 (x, y)
+    int hx, hy;                                // AI 선택에 넘기는 마지막 수 (S는 수순이 없으므로 -1)
+    int nwait;
+    int fd[ANALYZE_WAITERS];                   // 응답을 기다리는 연결 (닫히면 빠짐)
+    int top[ANALYZE_WAITERS];                  // 연결마다 요청한 후보 수
+} analyze_job_t;
+
+analyze_job_t analyze_queue[ANALYZE_QUEUE_MAX];   // 원형 대기열
+int analyze_head = 0;
+int analyze_len = 0;
+game_state_t analyze_state;                       // 분석 전용 판 (현재 게임 판과 따로)
+long analyze_done = 0;                            // 계산을 마친 국면 수
+uint64_t analyze_cpu_us = 0;
+uint64_t analyze_window_us = 0;                   // 현재 창에서 쓴 CPU 시간
+
+// 과부하 감지와 입장 제어
+// - 루프 지연: 메인 루프 한 바퀴에서 입출력 대기, 빈 시간 계산(미리 계산, 분석), AI 수 계산을 뺀
+//   처리 시간 (그동안 다른 연결의 명령이 기다림). OVERLOAD_SAMPLE_MS마다 그 구간의 최대값을
+//   지수 평균(가중치 1/4)에 넣음
+// - AI 부하: 같은 구간에서 실시간 AI 수 계산(ai_move)이 차지한 시간 비율의 지수 평균(가중치 1/8)과
+//   분석 대기열 길이 (빈 시간이 없어 분석이 밀린다는 신호)
+// - 셋 중 하나라도 기준 이상이면 과부하: 새 JOIN과 MODE 1(PVAI)은 BUSY <재시도 초>로 거절하고,
+//   AI는 한 단계 낮은 레벨로 계산해 진행 중인 게임의 응답 시간을 지킴
+// - 셋 다 기준의 절반 아래로 내려오면 자동으로 풀림 (경계에서 오락가락하지 않도록)
+#define OVERLOAD_SAMPLE_MS      1000
+#define DEFAULT_OVERLOAD_LAG_MS 100                        // -O로 변경, 0이면 과부하 판단 안 함
+#define OVERLOAD_AI_PCT         70
+#define OVERLOAD_QUEUE_DEPTH    (ANALYZE_QUEUE_MAX * 3 / 4)
+#define OVERLOAD_RETRY_SEC      5
+
+int overload_lag_ms = DEFAULT_OVERLOAD_LAG_MS;
+int overloaded = 0;
+uint64_t lag_max_us = 0;       // 현재 구간의 최대 루프 지연
+uint64_t lag_last_us = 0;      // 지난 구간의 최대 루프 지연
+uint64_t lag_avg_us = 0;       // 루프 지연 지수 평균
+uint64_t ai_live_us = 0;       // 실시간 AI 수 계산에 쓴 누적 시간 (벽시계)
+uint64_t io_wait_us = 0;       // select / io_uring_enter에서 기다린 누적 시간
+uint64_t ai_live_mark = 0;     // 구간 시작 때의 ai_live_us
+uint64_t sample_start_us = 0;  // 구간 시작 시각
+int ai_load_pct = 0;           // AI 부하 지수 평균 (%)
+long overload_busy = 0;        // BUSY로 거절한 요청 수
+long overload_episodes = 0;    // 과부하에 들어간 횟수
+wtimer_t overload_timer;
+
+static uint64_t mono_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
 }
 
-// (x,y)에 player가 두면 5목(이상)이 되는지 여부를 판단
-static int is_five_if(int x, int y, int player) {
-    return (longest_line_if(x, y, player) >= 5);
+static uint64_t thread_cpu_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
 }
 
-// (hx, hy) : 사람이 방금 둔 좌표 (CMD_MOVE 처리 시 전달되는 x,y)
-// (x,y)에 AI가 둔다고 가정했을 때 해당 칸의 점수를 평가하는 함수
-static int evaluate_cell(int x, int y, int hx, int hy) {
-    // 이미 돌이 있으면 아주 낮은 점수 부여 (실질적으로 선택 불가)
-    if (!in_range(x, y) || get_stone(x, y) != 0) {
-        return -1000000000;
+// 할당량 창이 끝나면 레벨별 창 사용량을 비우고 다음 창 시작
+static void ai_quota_window_expired(void *arg) {
+    (void)arg;
+    for (int l = AI_LEVEL_MIN; l <= AI_LEVEL_MAX; l++) ai_usage[l].window_us = 0;
+    analyze_window_us = 0;
+    timer_add(&timers, &ai_quota_timer, AI_QUOTA_WINDOW_SEC * 1000, ai_quota_window_expired, NULL);
+}
+
+// 구간 하나를 마치고 과부하 여부 판정 (OVERLOAD_SAMPLE_MS마다)
+static void overload_sample(void *arg) {
+    (void)arg;
+    uint64_t now = mono_us();
+    uint64_t span = now > sample_start_us ? now - sample_start_us : 1;
+    int ai_pct = (int)((ai_live_us - ai_live_mark) * 100 / span);
+    if (ai_pct > 100) ai_pct = 100;
+
+    lag_last_us = lag_max_us;
+    lag_avg_us = (lag_avg_us * 3 + lag_max_us) / 4;
+    ai_load_pct = (ai_load_pct * 7 + ai_pct) / 8;
+    lag_max_us = 0;
+    ai_live_mark = ai_live_us;
+    sample_start_us = now;
+
+    uint64_t lag_limit = (uint64_t)overload_lag_ms * 1000;
+    if (!overloaded &&
+        (lag_avg_us >= lag_limit || ai_load_pct >= OVERLOAD_AI_PCT ||
+         analyze_len >= OVERLOAD_QUEUE_DEPTH)) {
+        overloaded = 1;
+        overload_episodes++;
+        log_write("Overloaded: loop lag %llu us, AI load %d%%, analysis queue %d",
+                  (unsigned long long)lag_avg_us, ai_load_pct, analyze_len);
+    } else if (overloaded &&
+               lag_avg_us < lag_limit / 2 && ai_load_pct < OVERLOAD_AI_PCT / 2 &&
+               analyze_len < OVERLOAD_QUEUE_DEPTH / 2) {
+        overloaded = 0;
+        log_write("Load back to normal: loop lag %llu us, AI load %d%%",
+                  (unsigned long long)lag_avg_us, ai_load_pct);
     }
+    timer_add(&timers, &overload_timer, OVERLOAD_SAMPLE_MS, overload_sample, NULL);
+}
 
-    int score = 0;
-    int ai    = 2; // AI는 Player 2
-    int human = 1; // 사람은 Player 1
+// 메인 루프 한 바퀴의 처리 시간 기록 (busy: 입출력 대기와 빈 시간 계산을 뺀 시간)
+static void overload_note(uint64_t busy_us) {
+    if (busy_us > lag_max_us) lag_max_us = busy_us;
+}
 
-    // 1. AI가 두면 바로 이기는 자리 (5목 완성)
-    if (is_five_if(x, y, ai)) {
-        score += 1000000;
+// 과부하면 BUSY <재시도 초>로 거절 (거절했으면 1)
+static int overload_reject(int fd) {
+    if (!overloaded) return 0;
+    char msg[32];
+    int len = snprintf(msg, sizeof(msg), "BUSY %d\n", OVERLOAD_RETRY_SEC);
+    conn_write(fd, msg, len);
+    overload_busy++;
+    return 1;
+}
+
+// 난이도 level의 창 할당량이 남아 있으면 level, 다 썼으면 할당량이 남은 낮은 레벨
+// (가장 낮은 레벨은 할당량과 관계없이 반환). 과부하 중이면 한 단계 더 낮춤
+static int ai_effective_level(int level) {
+    int eff = level;
+    if (overloaded && eff > AI_LEVEL_MIN) eff--;
+    while (eff > AI_LEVEL_MIN &&
+           ai_usage[eff].window_us >= (uint64_t)ai_levels[eff].quota_ms * 1000) {
+        eff--;
     }
+    return eff;
+}
 
-    // 2. 사람이 두면 이기는 자리(= 즉시 막아야 하는 자리)
-    if (is_five_if(x, y, human)) {
-        score += 900000;
+// 미리 계산 (PVAI에서 사람 차례 동안 AI가 쉬지 않도록)
+// - 사람 차례 국면에서 사람이 둘 만한 수를 ponder_moves개 고르고, 각 수를 둔 국면의 AI 응수를
+//   ai_choose_move로 미리 계산해 둠. 실제 수가 그중 하나면 ai_move가 계산 없이 바로 응답
+// - select가 할 일 없이 돌아왔을 때만 한 수씩 계산하고, 계산 중에도 소켓에 입력이 오면
+//   위협 공간 탐색을 멈추고 결과를 버림 (다음 빈 시간에 같은 수부터 다시)
+// - 쓴 CPU는 그 레벨의 창 할당량에 청구하고, 할당량을 다 쓴 레벨은 미리 계산하지 않음
+#define PONDER_MAX 4
+
+typedef struct ponder_entry {
+    int      hx, hy;   // 사람의 예상 수
+    uint64_t hash;     // 예상 수를 둔 뒤의 board_hash()
+    int      x, y;     // 미리 계산한 AI 응수
+    int      done;     // 계산을 마쳤으면 1
+} ponder_entry_t;
+
+int ponder_ready = 0;        // 아래 목록이 유효하면 1
+uint64_t ponder_base;        // 목록을 만든 국면 (사람 차례)
+int ponder_level;            // 목록을 계산하는 레벨
+ponder_entry_t ponder[PONDER_MAX];
+int ponder_count = 0;        // 예상 수 개수
+int ponder_next = 0;         // 다음에 계산할 예상 수
+struct pollfd ponder_fds[1 + MAX_CLIENTS + MAX_SPECTATORS];
+int ponder_nfds = 0;
+
+// 현재 국면에서 사람의 예상 수 목록을 새로 만듦 (사람 입장의 평가 점수 내림차순 상위 max개)
+static void ponder_reset(int level) {
+    static int cand[BOARD_MAX * BOARD_MAX][2];
+    int scores[PONDER_MAX];
+    int max = ai_levels[level].ponder_moves < PONDER_MAX ? ai_levels[level].ponder_moves : PONDER_MAX;
+    int ncand = ai_candidates(1, cand, BOARD_MAX * BOARD_MAX);
+
+    ponder_count = 0;
+    for (int c = 0; c < ncand; c++) {
+        int s = ai_evaluate_cell(&ai_eval_default, 1, cand[c][0], cand[c][1], -1, -1);
+        if (max == 0 || (ponder_count == max && s <= scores[max - 1])) continue;
+
+        int pos = (ponder_count < max) ? ponder_count++ : max - 1;
+        while (pos > 0 && scores[pos - 1] < s) {
+            scores[pos] = scores[pos - 1];
+            ponder[pos] = ponder[pos - 1];
+            pos--;
+        }
+        scores[pos] = s;
+        memset(&ponder[pos], 0, sizeof(ponder[pos]));
+        ponder[pos].hx = cand[c][0];
+        ponder[pos].hy = cand[c][1];
     }
 
-    // 3. 양쪽의 최대 연속 길이에 따른 가중치 부여
-    int myLen  = longest_line_if(x, y, ai);
-    int oppLen = longest_line_if(x, y, human);
+    ponder_base = board_hash();
+    ponder_level = level;
+    ponder_next = 0;
+    ponder_ready = 1;
+}
 
-    if (myLen == 4)      score += 50000; // AI가 4목을 만들 수 있는 자리
-    else if (myLen == 3) score += 10000; // 3목 자리
+// 미리 계산할 일이 남아 있으면 1 (사람 차례가 새 국면이면 예상 수 목록을 다시 만듦)
+static int ponder_pending() {
+    if (game_mode != MODE_PVAI || !in_game || game_over || current_turn != 1) return 0;
 
-    if (oppLen == 4)      score += 40000; // 사람의 4목을 막는 자리
-    else if (oppLen == 3) score +=  8000; // 사람의 3목 견제
+    int eff = ai_effective_level(ai_level);
+    if (ai_levels[eff].ponder_moves == 0 ||
+        ai_usage[eff].window_us >= (uint64_t)ai_levels[eff].quota_ms * 1000) {
+        return 0;
+    }
+    if (!ponder_ready || ponder_base != board_hash() || ponder_level != eff) ponder_reset(eff);
+    return ponder_next < ponder_count;
+}
 
-    // 4. 중앙 선호 (중앙에서 멀어질수록 감점)
-    int center = (BOARD_SIZE - 1) / 2;
-    int dx = x - center;
-    int dy = y - center;
-    int dist2 = dx*dx + dy*dy;
-    score -= dist2; // 거리 제곱만큼 점수 감소
+// 위협 공간 탐색의 중단 함수: 듣는 소켓 중 하나라도 읽을 것이 있으면 1
+// (io_uring이면 완료 큐에 받을 것이 있는지만 보므로 시스템 호출이 없음, 공유 메모리 채널도 링만 봄)
+static int ponder_interrupted() {
+    if (shm_any_pending()) return 1;
+    if (use_uring) return uring_ready();
+    return poll(ponder_fds, ponder_nfds, 0) > 0;
+}
 
-    // 5. 사람이 마지막으로 둔 수(hx, hy)에 가까울수록 약간 선호
-    if (hx >= 0 && hy >= 0) {
-        int pdx = x - hx;
-        int pdy = y - hy;
-        int pd2 = pdx*pdx + pdy*pdy;
-        score -= pd2; // 사람 돌 근처에서 싸우는 전략 선호
+// ponder_interrupted가 select 백엔드에서 볼 fd 목록 (듣는 소켓 + 모든 연결)을 만듦
+// 빈 시간 계산(미리 계산, 국면 분석)을 시작하기 전에 한 번
+static void ponder_watch() {
+    ponder_nfds = 0;
+    ponder_fds[ponder_nfds].fd = server_fd;
+    ponder_fds[ponder_nfds++].events = POLLIN;
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (client_fd[i] == -1) continue;
+        ponder_fds[ponder_nfds].fd = client_fd[i];
+        ponder_fds[ponder_nfds++].events = POLLIN;
+    }
+    for (int k = 0; k < MAX_SPECTATORS && spec_count > 0; k++) {
+        if (!spec[k]) continue;
+        ponder_fds[ponder_nfds].fd = spec[k]->fd;
+        ponder_fds[ponder_nfds++].events = POLLIN;
     }
+}
+
+// 예상 수 하나의 AI 응수를 계산 (ponder_pending()이 1일 때만 호출)
+static void ponder_step() {
+    ponder_entry_t *e = &ponder[ponder_next];
 
-    return score;
+    ponder_watch();
+    if (!place_stone(e->hx, e->hy, 1)) {
+        ponder_next++;   // 둘 수 없는 수 (일어나지 않아야 함)
+        return;
+    }
+    e->hash = board_hash();
+
+    uint64_t start = thread_cpu_us();
+    vcf_set_abort(ponder_interrupted);
+    TRACE_BEGIN("ponder", ponder_level);
+    ai_choose_move(&ai_levels[ponder_level], &ai_eval_default, 2, e->hx, e->hy, &e->x, &e->y);
+    TRACE_END("ponder");
+    int cancelled = vcf_aborted();
+    vcf_set_abort(NULL);
+    uint64_t used = thread_cpu_us() - start;
+    board_undo();
+
+    ai_usage[ponder_level].cpu_us += used;
+    ai_usage[ponder_level].window_us += used;
+    ai_usage[ponder_level].ponder_us += used;
+    if (cancelled) return;
+
+    e->done = 1;
+    ponder_next++;
 }
 
-// 사람이 방금 둔 좌표 (hx, hy)를 참고해서
-// AI가 둘 최적의 좌표를 (out_x, out_y)에 설정
-static void choose_ai_move(int hx, int hy, int *out_x, int *out_y) {
-    int bestScore = -1000000000;
-    int bestX = 0, bestY = 0;
+// 방금 둔 사람의 수가 예상 수 중 하나였으면 미리 계산한 응수 (있으면 1)
+static int ponder_lookup(int level, int *out_x, int *out_y) {
+    if (!ponder_ready || ponder_level != level) return 0;
+    uint64_t h = board_hash();
+    for (int k = 0; k < ponder_count; k++) {
+        ponder_entry_t *e = &ponder[k];
+        if (!e->done || e->hash != h) continue;
+        if (!in_range(e->x, e->y) || get_stone(e->x, e->y) != 0) return 0;
+        *out_x = e->x;
+        *out_y = e->y;
+        return 1;
+    }
+    return 0;
+}
 
-    // 전체 보드를 순회하면서 빈칸에 대해 evaluate_cell로 점수 평가
-    for (int y = 0; y < BOARD_SIZE; y++) {
-        for (int x = 0; x < BOARD_SIZE; x++) {
-            if (get_stone(x, y) != 0) continue; // 이미 돌이 있는 칸은 스킵
+// 난이도 level로 AI 수 계산
+// 그 레벨의 창 할당량을 다 썼으면 할당량이 남은 낮은 레벨로 계산하고 (가장 낮은 레벨은 항상 허용)
+// 실제로 계산한 레벨에 CPU 시간을 청구함. 미리 계산해 둔 응수가 있으면 그대로 사용
+static void ai_move(int level, int hx, int hy, int *out_x, int *out_y) {
+    int eff = ai_effective_level(level);
+    if (eff != level) {
+        ai_usage[level].downgraded++;
+        log_write("AI level %d over CPU quota or overloaded, using level %d", level, eff);
+    }
 
-            int s = evaluate_cell(x, y, hx, hy);
-            if (s > bestScore) {
-                bestScore = s;
-                bestX = x;
-                bestY = y;
-            }
+    if (ponder_lookup(eff, out_x, out_y)) {
+        ai_usage[eff].moves++;
+        ai_usage[eff].ponder_hits++;
+        log_write("AI reply to (%d, %d) was pondered", hx, hy);
+        return;
+    }
+
+    uint64_t start = thread_cpu_us();
+    uint64_t wall = mono_us();
+    TRACE_BEGIN("ai_search", eff);
+    ai_choose_move(&ai_levels[eff], &ai_eval_default, 2, hx, hy, out_x, out_y);
+    TRACE_END("ai_search");
+    uint64_t used = thread_cpu_us() - start;
+    ai_live_us += mono_us() - wall;
+
+    ai_usage[eff].moves++;
+    ai_usage[eff].cpu_us += used;
+    ai_usage[eff].window_us += used;
+}
+
+// 분석 작업의 국면을 g에 만듦 (둘 수 없는 수가 있으면 0, 성공이면 둘 차례 1 또는 2)
+static int analyze_build(const analyze_job_t *j, game_state_t *g) {
+    if (!game_init(g, j->variant, j->rule)) return 0;
+    for (int k = 0; k < j->nmoves; k++) {
+        if (!game_make_move(g, j->moves[k][0], j->moves[k][1], k % 2 + 1)) return 0;
+    }
+    return j->nmoves % 2 + 1;
+}
+
+// ANALYZE 요청을 작업 j와 요청 후보 수 top으로 (형식 오류면 0)
+static int analyze_parse(const char *req, analyze_job_t *j, int *top) {
+    int off = 0;
+    if (sscanf(req, "ANALYZE %d%n", top, &off) != 1 || *top < 1 || *top > ANALYSIS_TOP_MAX) return 0;
+    const char *p = req + off;
+    while (*p == ' ') p++;
+
+    j->nmoves = 0;
+    j->hx = j->hy = -1;
+    if (*p == '\0' || *p == '\r' || *p == '\n') {
+        // 현재 게임
+        game_state_t *g = board_state();
+        j->variant = g->variant;
+        j->rule = g->rule;
+        for (int k = 0; k < board_move_count(); k++) {
+            int mx, my, mp;
+            board_get_move(k, &mx, &my, &mp);
+            j->moves[j->nmoves][0] = (unsigned char)mx;
+            j->moves[j->nmoves++][1] = (unsigned char)my;
+            j->hx = mx;
+            j->hy = my;
         }
+        return 1;
     }
 
-    *out_x = bestX;
-    *out_y = bestY;
+    int size, win;
+    char kind;
+    if (sscanf(p, "%d %d %d %c%n", &size, &win, &j->rule, &kind, &off) != 4) return 0;
+    j->variant = board_find_variant(size, win);
+    if (j->variant < 0 || (j->rule != RULE_FREESTYLE && j->rule != RULE_RENJU)) return 0;
+    p += off;
+
+    if (kind == 'M') {
+        for (;;) {
+            char *end;
+            long x = strtol(p, &end, 10);
+            if (end == p) break;
+            p = end;
+            long y = strtol(p, &end, 10);
+            if (end == p || x < 0 || x >= size || y < 0 || y >= size) return 0;
+            p = end;
+            if (j->nmoves >= size * size) return 0;
+            j->moves[j->nmoves][0] = (unsigned char)x;
+            j->moves[j->nmoves++][1] = (unsigned char)y;
+            j->hx = (int)x;
+            j->hy = (int)y;
+        }
+        while (*p == ' ' || *p == '\r' || *p == '\n') p++;
+        return *p == '\0';
+    }
+    if (kind == 'S') {
+        // 돌 배치만 있으므로 P1 돌과 P2 돌을 번갈아 둔 수순으로 바꿈 (돌 수가 맞지 않으면 오류)
+        // 이 수순의 마지막 수는 실제 마지막 수가 아니므로 hx/hy는 -1로 둠
+        int cells[BOARD_MAX * BOARD_MAX];
+        while (*p == ' ') p++;
+        if (!sync_decode(p, cells, size * size)) return 0;
+        int n1 = 0, n2 = 0;
+        for (int idx = 0; idx < size * size; idx++) {
+            if (cells[idx] == 1) n1++;
+            else if (cells[idx] == 2) n2++;
+        }
+        if (n1 != n2 && n1 != n2 + 1) return 0;
+        int next[3] = { 0, 0, 0 };   // 플레이어별로 다음에 찾을 칸
+        for (int k = 0; k < n1 + n2; k++) {
+            int pl = k % 2 + 1;
+            while (cells[next[pl]] != pl) next[pl]++;
+            j->moves[k][0] = (unsigned char)(next[pl] / size);
+            j->moves[k][1] = (unsigned char)(next[pl] % size);
+            next[pl]++;
+        }
+        j->nmoves = n1 + n2;
+        return 1;
+    }
+    return 0;
+}
+
+// 캐시 키: AI 선택(ai_choose_move)은 마지막 수 근처를 선호하므로 국면 해시에 마지막 수를 섞음
+// (같은 배치라도 마지막 수가 다르면 다른 결과로 캐시, 마지막 수가 없으면 국면 해시 그대로)
+static uint64_t analyze_key(const game_state_t *g, int hx, int hy) {
+    uint64_t last = hx < 0 ? 0 : (uint64_t)(hy * BOARD_MAX + hx + 1);
+    return game_hash(g) ^ (last * 0x9E3779B97F4A7C15ull);
+}
+
+// 빈 시간에 계산할 분석 작업이 있고 창 할당량이 남았으면 1
+static int analyze_pending() {
+    return analyze_len > 0 && analyze_window_us < (uint64_t)ANALYZE_QUOTA_MS * 1000;
+}
+
+// 닫히는 연결을 분석 작업의 응답 대상에서 뺌 (fd 번호가 새 연결에 다시 쓰이기 전에)
+static void analyze_forget(int fd) {
+    for (int n = 0; n < analyze_len; n++) {
+        analyze_job_t *j = &analyze_queue[(analyze_head + n) % ANALYZE_QUEUE_MAX];
+        for (int w = 0; w < j->nwait; w++) {
+            if (j->fd[w] != fd) continue;
+            j->nwait--;
+            j->fd[w] = j->fd[j->nwait];
+            j->top[w] = j->top[j->nwait];
+            w--;
+        }
+    }
+}
+
+// STATS의 풀 사용량 한 줄: POOL <이름> <사용 중> <만든 객체 수> <최대 사용> <슬랩 바이트>
+static int format_pool_stat(char *out, size_t size, const pool_t *p) {
+    return snprintf(out, size, "POOL %s %d %d %d %zu\n",
+                    p->name, p->in_use, p->capacity, p->peak, p->bytes);
+}
+
+// STATS 응답
+// - 레벨별 AI 사용량
+//   AISTAT <레벨> <이름> <수> <누적 CPU ms> <창 CPU ms> <창 할당량 ms> <낮춘 수> <미리 계산 적중 수> <미리 계산 CPU ms>
+// - 연결/게임/메시지 버퍼 풀 사용량 (POOL)과 현재 게임 아레나 (ARENA game <사용> <청크 전체> <최대 사용>)
+// - 게임 로그 (WAL <마지막 lsn> <레코드 수> <커밋 수> <스냅샷 수> <복구한 레코드 수> <실패한 커밋 수> <버린 레코드 수>)
+// - 입출력 백엔드 (IO <select|uring> <io_uring_enter 수> <제출 수> <완료 수> <recv 수> <sendmsg 수>)
+// - 공유 메모리 전송 (SHM <채널 수> <받은 줄 수> <보낸 메시지 수> <상대를 깨운 횟수>)
+// - 국면 분석 (ANALYZE <대기 작업> <계산한 국면> <캐시 적중> <캐시 실패> <캐시 항목> <내보낸 항목>
+//             <누적 CPU ms> <창 CPU ms> <창 할당량 ms>)
+// - 속도 제한 (RATE <거절한 명령 수> <끊은 연결 수>)
+// - 과부하 (LOAD <과부하 여부> <루프 지연 평균 us> <지난 구간 최대 지연 us> <AI 부하 %> <분석 대기열>
+//          <BUSY로 거절한 수> <과부하 진입 횟수>)
+static msgbuf_t *build_stats_reply() {
+    char text[1024];
+    int len = 0;
+    for (int l = AI_LEVEL_MIN; l <= AI_LEVEL_MAX; l++) {
+        len += snprintf(text + len, sizeof(text) - len, "AISTAT %d %s %ld %llu %llu %d %ld %ld %llu\n",
+                        l, ai_levels[l].name, ai_usage[l].moves,
+                        (unsigned long long)(ai_usage[l].cpu_us / 1000),
+                        (unsigned long long)(ai_usage[l].window_us / 1000),
+                        ai_levels[l].quota_ms, ai_usage[l].downgraded, ai_usage[l].ponder_hits,
+                        (unsigned long long)(ai_usage[l].ponder_us / 1000));
+    }
+    len += format_pool_stat(text + len, sizeof(text) - len, &conn_pool);
+    len += format_pool_stat(text + len, sizeof(text) - len, &game_pool);
+    for (int k = 0; k < MSGBUF_CLASSES; k++) {
+        len += format_pool_stat(text + len, sizeof(text) - len, msgbuf_pool(k));
+    }
+    len += snprintf(text + len, sizeof(text) - len, "ARENA game %zu %zu %zu\n",
+                    cur_game->arena.used, cur_game->arena.capacity, cur_game->arena.peak);
+    wal_stats_t ws;
+    wal_get_stats(&ws);
+    len += snprintf(text + len, sizeof(text) - len, "WAL %llu %ld %ld %ld %ld %ld %ld\n",
+                    (unsigned long long)ws.lsn, ws.records, ws.commits, ws.snapshots, ws.recovered,
+                    ws.failures, ws.dropped);
+    uring_stats_t us;
+    memset(&us, 0, sizeof(us));
+    if (use_uring) uring_get_stats(&us);
+    len += snprintf(text + len, sizeof(text) - len, "IO %s %ld %ld %ld %ld %ld\n",
+                    use_uring ? "uring" : "select", us.enters, us.submitted, us.completions,
+                    us.recvs, us.sends);
+    long wakeups = shm_wakeups_closed;
+    for (int k = 0; k < SHM_MAX_CONNS; k++) {
+        if (shm_conns[k].active) wakeups += shm_conns[k].chan.wakeups;
+    }
+    len += snprintf(text + len, sizeof(text) - len, "SHM %d %ld %ld %ld\n",
+                    shm_count, shm_lines_in, shm_msgs_out, wakeups);
+    evalcache_stats_t cs;
+    evalcache_get_stats(&cs);
+    len += snprintf(text + len, sizeof(text) - len, "ANALYZE %d %ld %ld %ld %d %ld %llu %llu %d\n",
+                    analyze_len, analyze_done, cs.hits, cs.misses, cs.entries, cs.evictions,
+                    (unsigned long long)(analyze_cpu_us / 1000),
+                    (unsigned long long)(analyze_window_us / 1000), ANALYZE_QUOTA_MS);
+    len += snprintf(text + len, sizeof(text) - len, "RATE %ld %ld\n", rate_limited, rate_disconnects);
+    len += snprintf(text + len, sizeof(text) - len, "LOAD %d %llu %llu %d %d %ld %ld\n",
+                    overloaded, (unsigned long long)lag_avg_us, (unsigned long long)lag_last_us,
+                    ai_load_pct, analyze_len, overload_busy, overload_episodes);
+    len += snprintf(text + len, sizeof(text) - len, "STATS_END\n");
+    return msgbuf_new(text, len);
 }
 
 // 시그널 핸들러
@@ -168,6 +813,10 @@ void handle_signal(int sig) {
     if (sig == SIGTERM || sig == SIGINT) {
         log_write("Signal %d received. Stopping server...", sig);
         running = 0; // 루프 종료 유도
+    } else if (sig == SIGUSR2) {
+        upgrade_requested = 1; // 메인 루프가 다음 바퀴에서 인계 시작
+    } else if (sig == SIGUSR1) {
+        trace_toggle_requested = 1; // 메인 루프가 다음 바퀴에서 추적을 켜거나 끄고 저장
     }
 }
 
@@ -176,7 +825,17 @@ void handle_signal(int sig) {
 void send_mode_select_message(int fd) {
     const char *msg =
         "MODE_SELECT\n";  // 한 줄로만 보내고, 실제 질문은 클라이언트에서 출력
-    write(fd, msg, strlen(msg));
+    conn_write(fd, msg, strlen(msg));
+}
+
+// PID 파일 기록 (임시 파일에 쓰고 rename으로 바꿔, 읽는 쪽이 빈 파일이나 반쯤 쓴 파일을 보지 않음)
+static void write_pid_file() {
+    char tmp[sizeof(PID_FILE) + 8];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", PID_FILE);
+    FILE *fp = fopen(tmp, "w");
+    if (!fp) return;
+    fprintf(fp, "%d\n", getpid());
+    if (fclose(fp) != 0 || rename(tmp, PID_FILE) == -1) unlink(tmp);
 }
 
 // 데몬화 함수
@@ -198,6 +857,7 @@ void daemonize() {
     signal(SIGTTOU, SIG_IGN);
     signal(SIGTTIN, SIG_IGN);
     signal(SIGHUP, SIG_IGN);
+    signal(SIGPIPE, SIG_IGN);   // 이미 끊긴 연결에 쓰면 프로세스를 죽이지 말고 에러로 받음
 
     // 4. 2차 fork (세션 리더가 되지 않도록 재차 포크)
     pid = fork();
@@ -218,415 +878,1934 @@ void daemonize() {
     close(fd);
 
     // 8. PID 파일 생성 (현재 데몬의 PID 기록)
-    FILE *fp = fopen(PID_FILE, "w");
-    if (fp) {
-        fprintf(fp, "%d\n", getpid());
-        fclose(fp);
+    write_pid_file();
+}
+
+// 연결 닫기 (io_uring이면 그 fd에 걸린 요청을 먼저 취소해, 같은 번호로 열릴 다음 연결과 섞이지 않게 함)
+static void conn_close(int fd) {
+    analyze_forget(fd);
+    shm_detach(fd, NULL);
+    if (use_uring) {
+        // 닫기 직전에 쌓인 마지막 응답(ERR IDLE_TIMEOUT 등)은 제출 중인 송신이 없을 때만 바로 보냄
+        if (fd < FD_SETSIZE && outq_pending(&conn_outq[fd]) && !uring_sending(fd)) {
+            outq_flush(&conn_outq[fd], fd);
+        }
+        uring_forget(fd);
+        if (fd < FD_SETSIZE) outq_clear(&conn_outq[fd]);
     }
+    close(fd);
+}
+
+// 연결을 입출력 백엔드에 등록 (io_uring이면 멀티샷 recv, select는 매 바퀴 fd 집합을 새로 만드므로 할 일 없음)
+static void io_watch(int fd) {
+    if (use_uring) uring_watch(fd);
+}
+
+// fd의 관전자 슬롯 (관전자가 아니면 -1)
+static int spectator_slot(int fd) {
+    if (fd < 0 || fd >= FD_SETSIZE) return -1;
+    return spec_slot_of[fd] - 1;
+}
+
+// 관전자 슬롯 비우기 (fd는 닫지 않음, 큐에 남은 버퍼 참조는 해제)
+static void detach_spectator(int k) {
+    spec_slot_of[spec[k]->fd] = 0;
+    timer_cancel(&timers, &spec[k]->idle_timer);
+    outq_clear(&spec[k]->q);
+    pool_free(&conn_pool, spec[k]);
+    spec[k] = NULL;
+    spec_count--;
+}
+
+// 관전자 슬롯 정리 (연결 종료)
+static void remove_spectator(int k) {
+    if (!spec[k]) return;
+    log_write("Spectator disconnected: FD=%d", spec[k]->fd);
+    conn_close(spec[k]->fd);
+    detach_spectator(k);
+}
+
+// SPECTATE/RESUME 없이 조용한 관전 대기 연결 정리
+static void spectator_idle_expired(void *arg) {
+    int k = (int)(intptr_t)arg;
+    log_write("Idle timeout: FD=%d (spectator pending)", spec[k]->fd);
+    remove_spectator(k);
+}
+
+// 새 연결을 관전자 슬롯에 등록 (빈 슬롯이 없으면 -1)
+static int add_spectator(int fd) {
+    if (fd >= FD_SETSIZE) return -1;
+    for (int k = 0; k < MAX_SPECTATORS; k++) {
+        if (spec[k]) continue;
+        spec[k] = pool_alloc(&conn_pool);
+        if (!spec[k]) return -1;
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        memset(&spec[k]->idle_timer, 0, sizeof(spec[k]->idle_timer));
+        spec[k]->fd = fd;
+        spec[k]->attached = 0;
+        outq_init(&spec[k]->q);
+        spec_slot_of[fd] = k + 1;
+        spec_count++;
+        if (idle_sec > 0) {
+            timer_add(&timers, &spec[k]->idle_timer, (uint64_t)idle_sec * 1000,
+                      spectator_idle_expired, (void *)(intptr_t)k);
+        }
+        return k;
+    }
+    return -1;
+}
+
+// 관전자에게 버퍼를 큐잉하고 즉시 전송 시도 (io_uring이면 큐잉만, 루프가 한 바퀴분을 모아 제출)
+// 큐가 넘치거나 소켓 에러가 나면 느린/끊긴 관전자로 보고 제거
+static void spectator_send(int k, msgbuf_t *m) {
+    TRACE_BEGIN("spectator_send", spec[k]->fd);
+    int failed = !outq_push(&spec[k]->q, m) || (!use_uring && outq_flush(&spec[k]->q, spec[k]->fd) < 0);
+    TRACE_END("spectator_send");
+    if (failed) remove_spectator(k);
+}
+
+// 연결이 지금 속한 곳에 맞게 응답을 보냄 (관전자는 방송과 순서가 섞이지 않도록 송신 큐로)
+static void conn_reply(int fd, const char *data, int len) {
+    int k = spectator_slot(fd);
+    if (k < 0) {
+        conn_write(fd, data, len);
+        return;
+    }
+    msgbuf_t *m = msgbuf_new(data, len);
+    if (!m) return;
+    spectator_send(k, m);
+    msgbuf_unref(m);
+}
+
+// 이벤트 추적 켜기(on=1) / 끄고 trace_path에 저장(on=0)
+static void trace_switch(int on) {
+    if (on) {
+        trace_start();
+        log_write("Tracing started");
+        return;
+    }
+    trace_stop();
+    long n = trace_dump(trace_path);
+    if (n < 0) log_write("Failed to write trace file: %s", trace_path);
+    else log_write("Tracing stopped: %ld events written to %s", n, trace_path);
+}
+
+// SYNC 요청에 대한 응답 버퍼 생성
+// - "SYNC" 또는 너무 오래된 "SYNC <n>": 판 변형과 전체 스냅샷
+//   VARIANT <판 크기> <승리 길이> <규칙>
+//   SYNC <수순 번호> <현재 턴> <게임 종료 여부> <인코딩된 보드>
+// - 최근 수만 놓친 "SYNC <n>": DELTA <n> <현재 수순> 뒤에 놓친 MOVE 줄들
+static msgbuf_t *build_sync_reply(const char *req, int current_turn, int game_over) {
+    char out[1024];
+    int len = 0;
+    int count = board_move_count();
+    int since = -1;
+
+    if (req && sscanf(req, "SYNC %d", &since) != 1) since = -1;
+
+    if (since >= 0 && since <= count && count - since <= SYNC_DELTA_MAX) {
+        len += snprintf(out + len, sizeof(out) - len, "DELTA %d %d\n", since, count);
+        for (int idx = since; idx < count; idx++) {
+            int mx, my, mp;
+            board_get_move(idx, &mx, &my, &mp);
+            len += snprintf(out + len, sizeof(out) - len, "MOVE %d %d %d\n", mp, mx, my);
+        }
+        if (!game_over) {
+            len += snprintf(out + len, sizeof(out) - len, "TURN %d\n", current_turn);
+        }
+        return msgbuf_new(out, len);
+    }
+
+    int cells[BOARD_MAX * BOARD_MAX];
+    char enc[BOARD_MAX * BOARD_MAX + 1];
+    int ncells = board_snapshot(cells);
+    if (sync_encode(cells, ncells, enc, sizeof(enc)) < 0) return NULL;
+
+    // 판 변형을 먼저 알려야 클라이언트가 칸 수에 맞게 복원할 수 있음
+    len = snprintf(out, sizeof(out), "VARIANT %d %d %d\nSYNC %d %d %d %s\n",
+                   board_get_size(), board_get_win_len(), board_get_rule(),
+                   count, current_turn, game_over, enc);
+    return msgbuf_new(out, len);
+}
+
+// 관전 시작 시 현재 판 스냅샷과 턴 정보를 전달
+static void send_spectator_snapshot(int k, int current_turn, int game_over) {
+    msgbuf_t *m = msgbuf_new("SPECTATING\n", 11);
+    if (!m) return;
+    spectator_send(k, m);
+    msgbuf_unref(m);
+
+    if (!spec[k]) return;
+    m = build_sync_reply(NULL, current_turn, game_over);
+    if (!m) return;
+    spectator_send(k, m);
+    msgbuf_unref(m);
+}
+
+// 분석 결과 응답
+// ANALYSIS <캐시 적중 여부> <둘 차례> <AI 선택 x> <AI 선택 y> <후보 수> [<x> <y> <점수>]...
+static void analyze_reply(int fd, const analysis_t *a, int top, int cached) {
+    char out[512];
+    int n = a->count < top ? a->count : top;
+    int len = snprintf(out, sizeof(out), "ANALYSIS %d %d %d %d %d",
+                       cached, a->player, a->best_x, a->best_y, n);
+    for (int k = 0; k < n; k++) {
+        len += snprintf(out + len, sizeof(out) - len, " %d %d %d",
+                        a->moves[k][0], a->moves[k][1], a->moves[k][2]);
+    }
+    len += snprintf(out + len, sizeof(out) - len, "\n");
+    conn_reply(fd, out, len);
+}
+
+// ANALYZE 요청: 캐시에 있으면 바로 응답, 없으면 대기열에 넣음 (같은 국면의 작업이 있으면 거기에 묶음)
+static void analyze_request(int fd, const char *req) {
+    static analyze_job_t j;
+    int top;
+    if (!analyze_parse(req, &j, &top) || !analyze_build(&j, &analyze_state)) {
+        conn_reply(fd, "ERR BAD_POSITION\n", 17);
+        return;
+    }
+    j.key = analyze_key(&analyze_state, j.hx, j.hy);
+
+    analysis_t a;
+    if (evalcache_get(j.key, &a)) {
+        analyze_reply(fd, &a, top, 1);
+        return;
+    }
+    for (int n = 0; n < analyze_len; n++) {
+        analyze_job_t *q = &analyze_queue[(analyze_head + n) % ANALYZE_QUEUE_MAX];
+        if (q->key != j.key) continue;
+        if (q->nwait == ANALYZE_WAITERS) break;
+        q->fd[q->nwait] = fd;
+        q->top[q->nwait++] = top;
+        return;
+    }
+    if (analyze_len == ANALYZE_QUEUE_MAX) {
+        conn_reply(fd, "ERR ANALYZE_BUSY\n", 17);
+        return;
+    }
+    j.nwait = 1;
+    j.fd[0] = fd;
+    j.top[0] = top;
+    analyze_queue[(analyze_head + analyze_len++) % ANALYZE_QUEUE_MAX] = j;
+}
+
+// 대기열 맨 앞 작업 하나를 계산 (analyze_pending()이 1일 때만 호출)
+// 입력이 와서 탐색이 멈추면 결과를 버리고 작업을 남겨 둠 (쓴 CPU는 그래도 청구)
+static void analyze_step() {
+    analyze_job_t *j = &analyze_queue[analyze_head];
+    analysis_t a;
+    int cancelled = 0;
+
+    if (j->nwait > 0) {
+        ponder_watch();
+        memset(&a, 0, sizeof(a));
+        a.player = analyze_build(j, &analyze_state);
+
+        game_state_t *live = board_state();
+        board_bind(&analyze_state);
+        uint64_t start = thread_cpu_us();
+        TRACE_BEGIN("analyze", j->nmoves);
+        a.count = ai_rank_moves(&ai_eval_default, a.player, a.moves, ANALYSIS_TOP_MAX);
+        vcf_set_abort(ponder_interrupted);
+        ai_choose_move(&ai_levels[ANALYZE_LEVEL], &ai_eval_default, a.player, j->hx, j->hy,
+                       &a.best_x, &a.best_y);
+        TRACE_END("analyze");
+        cancelled = vcf_aborted();
+        vcf_set_abort(NULL);
+        uint64_t used = thread_cpu_us() - start;
+        board_bind(live);
+
+        analyze_cpu_us += used;
+        analyze_window_us += used;
+        if (cancelled) return;
+
+        evalcache_put(j->key, &a);
+        analyze_done++;
+        for (int w = 0; w < j->nwait; w++) analyze_reply(j->fd[w], &a, j->top[w], 0);
+    }
+    analyze_head = (analyze_head + 1) % ANALYZE_QUEUE_MAX;
+    analyze_len--;
 }
 
 // 현재 접속 중인 모든 클라이언트에게 동일한 메시지를 방송(broadcast)
+// 메시지는 msgbuf 하나로 한 번만 만들어지고, 관전자 큐는 이를 공유함
 void broadcast(int *client_fds, const char *msg) {
+    msgbuf_t *m = msgbuf_new(msg, strlen(msg));
+    if (!m) return;
+
+    TRACE_BEGIN("broadcast", spec_count);
     for (int i = 0; i < MAX_CLIENTS; i++) {
-        if (client_fds[i] != -1) {
-            write(client_fds[i], msg, strlen(msg));
+        if (client_fds[i] == -1) continue;
+        if (conn_queued(client_fds[i]) && !conn_shm(client_fds[i])) conn_queue(client_fds[i], m);
+        else conn_write(client_fds[i], m->data, m->len);
+    }
+
+    if (spec_count > 0) {
+        for (int k = 0; k < MAX_SPECTATORS; k++) {
+            if (spec[k] && spec[k]->attached) {
+                spectator_send(k, m);
+            }
         }
     }
+    TRACE_END("broadcast");
+    msgbuf_unref(m);
 }
 
-int main() {
-    // 1. 데몬화 실행
-    daemonize();
+// 영속화 레코드 만들기 (로그와 스냅샷이 같은 형식을 씀)
+static void rec_init(wal_rec_t *r, int type) {
+    memset(r, 0, sizeof(*r));
+    r->type = type;
+}
 
-    // ★ rand 초기화 (필요 시 AI에 난수 요소를 넣기 위해 사용 가능)
-    if (!rand_initialized) {
-        srand((unsigned int)time(NULL));
-        rand_initialized = 1;
+static void rec_game(wal_rec_t *r) {
+    rec_init(r, WAL_GAME);
+    r->arg[0] = game_mode;
+    r->arg[1] = cur_game->state.variant;
+    r->arg[2] = cur_game->state.rule;
+    r->arg[3] = ai_level;
+}
+
+static void rec_move(wal_rec_t *r, int x, int y, int player) {
+    rec_init(r, WAL_MOVE);
+    r->arg[0] = x;
+    r->arg[1] = y;
+    r->arg[2] = player;
+    r->arg[3] = bank_ms[0];
+    r->arg[4] = bank_ms[1];
+}
+
+static void rec_seat(wal_rec_t *r, int i) {
+    rec_init(r, WAL_SEAT);
+    r->arg[0] = i;
+    snprintf(r->text, sizeof(r->text), "%.*s", (int)sizeof(seat_token[i]) - 1, seat_token[i]);
+}
+
+// 받아들인 사건을 로그에 덧붙임 (-w가 없으면 wal_append가 무시)
+static void persist_game() {
+    wal_rec_t r;
+    rec_game(&r);
+    wal_append(&r);
+}
+
+static void persist_move(int x, int y, int player) {
+    wal_rec_t r;
+    rec_move(&r, x, y, player);
+    wal_append(&r);
+}
+
+static int last_winner = 0;   // 스냅샷의 WAL_END에 다시 쓰기 위해 보관
+
+static void persist_end(int winner) {
+    wal_rec_t r;
+    rec_init(&r, WAL_END);
+    r.arg[0] = last_winner = winner;
+    wal_append(&r);
+}
+
+static void persist_seat(int i) {
+    wal_rec_t r;
+    rec_seat(&r, i);
+    wal_append(&r);
+}
+
+static void persist_clear() {
+    wal_rec_t r;
+    rec_init(&r, WAL_CLEAR);
+    wal_append(&r);
+}
+
+// 방송(다른 연결이 알게 되는 것) 전에 이번 수의 레코드를 디스크에 내림
+// 실패하면 레코드는 wal.c 버퍼에 남아 다음 커밋에서 다시 쓰이고, 그동안 새 수는 persist_ready가 막음
+static void persist_sync() {
+    if (wal_dir && !wal_commit()) log_write("Failed to commit game log in %s", wal_dir);
+}
+
+// 새 수를 받아도 되는지 (밀린 레코드가 있으면 먼저 커밋을 다시 시도)
+static int persist_ready() {
+    return !wal_dir || wal_commit();
+}
+
+// 좌석 토큰 발급 (JOIN 성공 시 호출, 클라이언트는 재접속 때 RESUME <token>으로 사용)
+static void issue_token(int i) {
+    unsigned char raw[8];
+    int fd = open("/dev/urandom", O_RDONLY);
+    if (fd == -1 || read(fd, raw, sizeof(raw)) != (ssize_t)sizeof(raw)) {
+        for (int k = 0; k < 8; k++) raw[k] = (unsigned char)rand();
     }
+    if (fd != -1) close(fd);
 
-    // 2. 로그 시스템 시작
-    if (!log_open(LOG_FILE)) {
-        exit(EXIT_FAILURE); // 로그 파일을 열지 못하면 서버 종료
+    for (int k = 0; k < 8; k++) snprintf(seat_token[i] + k * 2, 3, "%02x", raw[k]);
+    persist_seat(i);
+
+    char msg[32];
+    int len = snprintf(msg, sizeof(msg), "TOKEN %s\n", seat_token[i]);
+    conn_write(client_fd[i], msg, len);
+}
+
+// 턴 시계 정지 (돌고 있던 플레이어의 남은 시간에서 사용한 시간을 차감)
+static void clock_stop() {
+    if (clock_player == 0) return;
+    bank_ms[clock_player - 1] -= (int64_t)(timer_now_ms() - turn_started_ms);
+    if (bank_ms[clock_player - 1] < 0) bank_ms[clock_player - 1] = 0;
+    timer_cancel(&timers, &turn_timer);
+    clock_player = 0;
+}
+
+// 끝난 게임을 기록 파일에 한 줄로 남김 (book.h의 기록 형식, winner 0: 무승부)
+// 줄은 게임 아레나에 만들어 한 번에 씀 (수 하나는 " x,y" 최대 6바이트)
+static void record_game(int winner) {
+    if (!record_fp) return;
+    size_t cap = 32 + (size_t)board_move_count() * 8;
+    char *line = arena_alloc(&cur_game->arena, cap);
+    if (!line) return;
+
+    int len = snprintf(line, cap, BOOK_RECORD_PREFIX " %d %d %d %d",
+                       board_get_size(), board_get_win_len(), board_get_rule(), winner);
+    int x, y, p;
+    for (int k = 0; board_get_move(k, &x, &y, &p); k++) {
+        len += snprintf(line + len, cap - len, " %d,%d", x, y);
     }
-    log_write("Server Daemon Started. PID: %d", getpid());
+    line[len++] = '\n';
+    fwrite(line, 1, len, record_fp);
+    fflush(record_fp);
+}
 
-    // 3. 종료 관련 시그널 등록 (SIGTERM, SIGINT)
-    signal(SIGTERM, handle_signal);
-    signal(SIGINT, handle_signal);
+// 남은 시간을 모두 쓴 플레이어는 패배
+static void turn_timeout(void *arg) {
+    (void)arg;
+    int loser = clock_player;
+    int winner = (loser == 1) ? 2 : 1;
+
+    bank_ms[loser - 1] = 0;
+    clock_player = 0;
+    game_over = 1;
+    persist_end(winner);
+    persist_sync();
+
+    char msg[64];
+    snprintf(msg, sizeof(msg), "TIMEOUT P%d\nWIN P%d\nGAME_OVER\n", loser, winner);
+    broadcast(client_fd, msg);
+    log_write("Game Over. P%d ran out of time. Winner: P%d", loser, winner);
+    record_game(winner);
+}
 
-    int client_fd[MAX_CLIENTS] = { -1, -1 }; // 클라이언트 소켓 FD
-    int joined[MAX_CLIENTS]    = { 0, 0 };   // 각 클라이언트의 JOIN 여부
-    int current_turn = 1;                    // 현재 턴인 플레이어 (1 또는 2)
-    int game_over = 0;                       // 게임 종료 여부 플래그
-    struct sockaddr_un addr;
+// 양쪽 남은 시간 방송 (CLOCK <P1 ms> <P2 ms>)
+static void broadcast_clock() {
+    char msg[64];
+    snprintf(msg, sizeof(msg), "CLOCK %lld %lld\n",
+             (long long)bank_ms[0], (long long)bank_ms[1]);
+    broadcast(client_fd, msg);
+}
 
-    // 서버용 유닉스 도메인 소켓 생성
-    server_fd = socket(AF_UNIX, SOCK_STREAM, 0);
-    if (server_fd == -1) {
-        log_write("Socket creation failed");
-        return 1;
+// 현재 판 변형과 규칙 방송 (START 직전에 보내 클라이언트가 판 크기를 맞추도록 함)
+static void broadcast_variant() {
+    char msg[32];
+    snprintf(msg, sizeof(msg), "VARIANT %d %d %d\n",
+             board_get_size(), board_get_win_len(), board_get_rule());
+    broadcast(client_fd, msg);
+}
+
+// player의 턴 시계 시작 (PVAI의 AI 수는 즉시 처리되므로 사람 쪽만 시계가 돎)
+static void clock_start(int player) {
+    if (time_bank_sec <= 0 || game_over) return;
+    clock_stop();
+    clock_player = player;
+    turn_started_ms = timer_now_ms();
+    timer_add(&timers, &turn_timer, (uint64_t)bank_ms[player - 1], turn_timeout, NULL);
+    broadcast_clock();
+}
+
+// 게임 기록의 아레나는 풀에서 슬랩을 만들 때 한 번만 초기화 (반납해도 청크 유지)
+static void game_ctor(void *obj) {
+    arena_init(&((game_t *)obj)->arena, GAME_ARENA_CHUNK);
+}
+
+// 풀에서 게임 기록을 얻어 빈 기본 판으로 만들고 현재 판으로 지정
+static game_t *game_acquire() {
+    game_t *g = pool_alloc(&game_pool);
+    if (!g) {
+        log_write("Out of memory for game record");
+        exit(EXIT_FAILURE);
+    }
+    game_init(&g->state, VARIANT_GOMOKU15, RULE_FREESTYLE);
+    arena_reset(&g->arena);
+    board_bind(&g->state);
+    return g;
+}
+
+static void game_release(game_t *g) {
+    board_bind(NULL);
+    pool_free(&game_pool, g);
+}
+
+// 게임 시작(START/RESET) 직후 호출: 시계를 채우고 P1 시계 시작
+// 이전 게임이 아레나에 남긴 것은 여기서 한꺼번에 비움
+static void on_game_start() {
+    in_game = 1;
+    arena_reset(&cur_game->arena);
+    clock_stop();
+    for (int i = 0; i < MAX_CLIENTS; i++) bank_ms[i] = (int64_t)time_bank_sec * 1000;
+    persist_game();
+    clock_start(1);
+}
+
+// 게임 상태를 새 게임 대기 상태로 되돌림
+static void reset_game_state() {
+    clock_stop();
+    if (in_game) persist_clear();
+    in_game = 0;
+    game_release(cur_game);
+    cur_game = game_acquire();
+    current_turn = 1;
+    game_over = 0;
+}
+
+// 좌석 완전 해제 (유예 중이던 자리 포함)
+static void release_seat(int i) {
+    if (seat_held[i]) {
+        timer_cancel(&timers, &seat_timer[i]);
+        seat_held[i] = 0;
+        player_count--;
+    }
+    joined[i] = 0;
+    if (seat_token[i][0]) {
+        seat_token[i][0] = '\0';
+        persist_seat(i);
     }
+}
 
-    // 기존에 남아 있을 수 있는 소켓 파일 제거
-    unlink(SOCK_PATH);
+// JOIN하지 않은 조용한 플레이어 연결 정리
+// JOIN한 좌석은 상대를 기다리거나, 상대 차례이거나, 끝난 판을 보고 있을 수 있으므로
+// (클라이언트는 keepalive를 보내지 않음) 정리하지 않고 턴 시계와 연결 끊김 처리에 맡김
+static void player_idle_expired(void *arg) {
+    int i = (int)(intptr_t)arg;
+    if (client_fd[i] == -1 || joined[i]) return;
+
+    log_write("Idle timeout: FD=%d (Slot %d)", client_fd[i], i);
+    conn_write(client_fd[i], "ERR IDLE_TIMEOUT\n", 17);
+    conn_close(client_fd[i]);
+    client_fd[i] = -1;
+    release_seat(i);
+    player_count--;
+}
 
-    // 소켓 주소 구조체 초기화 및 경로 설정
-    memset(&addr, 0, sizeof(addr));
-    addr.sun_family = AF_UNIX;
-    strcpy(addr.sun_path, SOCK_PATH);
+// 플레이어 연결에서 명령을 받을 때마다 유휴 타이머 재설정 (JOIN한 좌석은 정리 대상이 아님)
+static void touch_player(int i) {
+    if (idle_sec <= 0 || joined[i]) return;
+    timer_add(&timers, &idle_timer[i], (uint64_t)idle_sec * 1000,
+              player_idle_expired, (void *)(intptr_t)i);
+}
 
-    // 소켓 bind
-    if (bind(server_fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
-        log_write("Bind failed");
-        close(server_fd);
-        return 1;
+// 유예 시간 만료: 돌아오지 않은 플레이어는 EXIT와 같게 처리
+static void seat_grace_expired(void *arg) {
+    int i = (int)(intptr_t)arg;
+    int other = (i == 0) ? 1 : 0;
+
+    log_write("Player %d did not resume within %d sec. Releasing seat.", i + 1, grace_sec);
+    release_seat(i);
+    if (client_fd[other] != -1) {
+        conn_write(client_fd[other], "OPPONENT_EXIT\n", 14);
     }
+    reset_game_state();
+}
 
-    // 클라이언트 접속 대기 (listen)
-    if (listen(server_fd, 5) == -1) {
-        log_write("Listen failed");
-        close(server_fd);
-        return 1;
+// 게임 참가 중이던 플레이어의 연결이 끊긴 경우 자리를 유지하고 유예 타이머 시작
+static void hold_seat(int i) {
+    int other = (i == 0) ? 1 : 0;
+
+    conn_close(client_fd[i]);
+    client_fd[i] = -1;
+    seat_held[i] = 1;
+    timer_add(&timers, &seat_timer[i], (uint64_t)grace_sec * 1000,
+              seat_grace_expired, (void *)(intptr_t)i);
+
+    if (client_fd[other] != -1) {
+        char msg[48];
+        int len = snprintf(msg, sizeof(msg), "OPPONENT_DISCONNECTED %d\n", grace_sec);
+        conn_write(client_fd[other], msg, len);
     }
+    log_write("Player %d disconnected. Holding seat for %d sec.", i + 1, grace_sec);
+}
 
-    log_write("Server listening on %s", SOCK_PATH);
+// RESUME <token> 처리: 토큰이 맞는 유예 좌석에 fd를 다시 연결
+// 성공 시 좌석 인덱스, 실패 시 -1 (호출자는 성공 시 fd를 기존 위치에서 떼어내야 함)
+static int resume_seat(int fd, const char *req) {
+    char token[32];
+    if (sscanf(req, "RESUME %31s", token) != 1) return -1;
 
-    init_board();          // 게임 보드 초기화
-    int player_count = 0;  // 현재 접속 중인 클라이언트 수
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (!seat_held[i] || strcmp(seat_token[i], token) != 0) continue;
+
+        timer_cancel(&timers, &seat_timer[i]);
+        seat_held[i] = 0;
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) & ~O_NONBLOCK);
+        client_fd[i] = fd;
+        touch_player(i);
+
+        char msg[32];
+        int len = snprintf(msg, sizeof(msg), "OK PLAYER%d\nRESUMED\n", i + 1);
+        conn_write(fd, msg, len);
+
+        msgbuf_t *m = build_sync_reply(NULL, current_turn, game_over);
+        if (m) {
+            conn_write(fd, m->data, m->len);
+            msgbuf_unref(m);
+        }
 
-    // 메인 루프 (running 플래그로 제어)
-    while (running) {
-        fd_set readfds;
-        FD_ZERO(&readfds);
+        int other = (i == 0) ? 1 : 0;
+        if (client_fd[other] != -1) {
+            conn_write(client_fd[other], "OPPONENT_RESUMED\n", 17);
+        }
+        log_write("Player %d resumed on FD=%d", i + 1, fd);
+        return i;
+    }
+    return -1;
+}
 
-        // 서버 소켓을 감시 집합에 추가
-        FD_SET(server_fd, &readfds);
-        int maxfd = server_fd;
+// 복구 중 레코드 하나 적용 (wal_recover의 콜백, 스냅샷과 로그 꼬리 순서로 불림)
+static void persist_apply(const wal_rec_t *r) {
+    if (r->type == WAL_GAME) {
+        game_mode = (int)r->arg[0];
+        if (!board_set_variant((int)r->arg[1])) board_set_variant(VARIANT_GOMOKU15);
+        if (!board_set_rule((int)r->arg[2])) board_set_rule(RULE_FREESTYLE);
+        init_board();
+        ai_level = (int)r->arg[3];
+        if (ai_level < AI_LEVEL_MIN || ai_level > AI_LEVEL_MAX) ai_level = AI_LEVEL_DEFAULT;
+        for (int i = 0; i < MAX_CLIENTS; i++) bank_ms[i] = (int64_t)time_bank_sec * 1000;
+        current_turn = 1;
+        game_over = 0;
+        in_game = 1;
+    } else if (r->type == WAL_MOVE) {
+        int player = (int)r->arg[2];
+        if (!in_game || (player != 1 && player != 2)) return;
+        place_stone((int)r->arg[0], (int)r->arg[1], player);
+        bank_ms[0] = r->arg[3];
+        bank_ms[1] = r->arg[4];
+        current_turn = (player == 1) ? 2 : 1;
+    } else if (r->type == WAL_END) {
+        last_winner = (int)r->arg[0];
+        game_over = 1;
+    } else if (r->type == WAL_SEAT) {
+        int i = (int)r->arg[0];
+        if (i < 0 || i >= MAX_CLIENTS) return;
+        snprintf(seat_token[i], sizeof(seat_token[i]), "%.16s", r->text);
+    } else if (r->type == WAL_CLEAR) {
+        init_board();
+        current_turn = 1;
+        game_over = 0;
+        in_game = 0;
+    }
+}
 
-        // 각 클라이언트 소켓도 감시 집합에 추가
+// 시작 시 복구: 진행 중이던 게임이 있으면 토큰이 남은 좌석을 유예 상태로 잡고 시계를 다시 돌림
+// (서버가 내려가 있던 시간은 남은 시간에서 빼지 않음)
+static void persist_recover() {
+    long n = wal_recover(persist_apply);
+    if (!in_game) {
+        for (int i = 0; i < MAX_CLIENTS; i++) seat_token[i][0] = '\0';
+        if (n > 0) log_write("Recovered %ld log records, no game in progress", n);
+        return;
+    }
+
+    int held = 0;
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (!seat_token[i][0] || grace_sec <= 0) {
+            seat_token[i][0] = '\0';
+            continue;
+        }
+        joined[i] = 1;
+        seat_held[i] = 1;
+        player_count++;
+        held++;
+        timer_add(&timers, &seat_timer[i], (uint64_t)grace_sec * 1000,
+                  seat_grace_expired, (void *)(intptr_t)i);
+    }
+    if (held == 0) {
+        log_write("Recovered game has no seat to resume. Discarding it.");
+        reset_game_state();
+        return;
+    }
+
+    if (!game_over && !(game_mode == MODE_PVAI && current_turn == 2)) clock_start(current_turn);
+    log_write("Recovered game: mode %d, %d moves, turn P%d%s (%ld records, %d seats held)",
+              game_mode, board_move_count(), current_turn, game_over ? ", over" : "", n, held);
+}
+
+// 살아 있는 게임을 최소 레코드열(게임 시작, 좌석, 수순, 종료)로 만듦 (스냅샷과 핫 재시작 인계에 사용)
+// recs는 GAME_RECS_MAX개 이상, 반환: 레코드 수 (게임 중이 아니면 0)
+#define GAME_RECS_MAX (BOARD_MAX * BOARD_MAX + MAX_CLIENTS + 2)
+
+static int build_game_recs(wal_rec_t *recs) {
+    int n = 0;
+    if (in_game) {
+        rec_game(&recs[n++]);
         for (int i = 0; i < MAX_CLIENTS; i++) {
-            if (client_fd[i] != -1) {
-                FD_SET(client_fd[i], &readfds);
-                if (client_fd[i] > maxfd) maxfd = client_fd[i];
+            if (seat_token[i][0]) rec_seat(&recs[n++], i);
+        }
+        int x, y, p;
+        for (int k = 0; board_get_move(k, &x, &y, &p); k++) rec_move(&recs[n++], x, y, p);
+        if (game_over) {
+            rec_init(&recs[n], WAL_END);
+            recs[n++].arg[0] = last_winner;
+        }
+    }
+    return n;
+}
+
+static void persist_snapshot() {
+    static wal_rec_t recs[GAME_RECS_MAX];
+    int n = build_game_recs(recs);
+    if (!wal_snapshot(recs, n)) log_write("Failed to write snapshot in %s", wal_dir);
+}
+
+// 이벤트 루프 한 바퀴 동안 쌓인 레코드를 한 번에 커밋 (때가 되면 스냅샷으로 대신함)
+static void persist_flush() {
+    if (wal_snapshot_due()) persist_snapshot();
+    else if (!wal_commit()) log_write("Failed to commit game log in %s", wal_dir);
+}
+
+// 새 연결: 플레이어 자리가 있으면 좌석, 없으면 관전 대기 슬롯
+static void on_accept(int new_fd) {
+    if (new_fd >= FD_SETSIZE) {
+        close(new_fd);
+        return;
+    }
+    rate_reset(&conn_rate[new_fd]);
+    conn_in[new_fd].len = conn_in[new_fd].discard = 0;
+    if (player_count < MAX_CLIENTS) {
+        // 재접속을 기다리는 좌석은 건너뜀
+        int slot = (client_fd[0] == -1 && !seat_held[0]) ? 0 : 1;
+        client_fd[slot] = new_fd;
+        log_write("Client connected: FD=%d (Slot %d)", new_fd, slot);
+        player_count++;
+        touch_player(slot);
+        io_watch(new_fd);
+    } else if (add_spectator(new_fd) >= 0) {
+        // 플레이어 자리가 없으면 관전 대기 슬롯에 등록 (SPECTATE를 보내야 방송 수신)
+        log_write("Client connected: FD=%d (spectator pending)", new_fd);
+        io_watch(new_fd);
+    } else {
+        // 관전 자리까지 꽉 찬 경우 새 연결은 바로 종료
+        close(new_fd);
+    }
+}
+
+// 관전자 슬롯 k의 연결에서 받은 데이터 처리 (n <= 0: 연결 끊김)
+static void on_spectator_input(int k, char *sbuf, int n) {
+    if (n <= 0) {
+        remove_spectator(k);
+        return;
+    }
+    sbuf[n] = '\0';
+
+    TRACE_BEGIN("parse", spec[k]->fd);
+    int scmd = parse_command(sbuf);
+    TRACE_END("parse");
+    if (scmd == CMD_RESUME) {
+        int fd_k = spec[k]->fd;
+        if (resume_seat(fd_k, sbuf) >= 0) {
+            detach_spectator(k);
+        } else {
+            conn_write(fd_k, "ERR INVALID_TOKEN\n", 18);
+        }
+    } else if (scmd == CMD_SPECTATE && !spec[k]->attached) {
+        spec[k]->attached = 1;
+        timer_cancel(&timers, &spec[k]->idle_timer);
+        log_write("Spectator attached: FD=%d (%d watching)", spec[k]->fd, spec_count);
+        send_spectator_snapshot(k, current_turn, game_over);
+    } else if (scmd == CMD_SYNC && spec[k]->attached) {
+        msgbuf_t *m = build_sync_reply(sbuf, current_turn, game_over);
+        if (m) {
+            spectator_send(k, m);
+            msgbuf_unref(m);
+        }
+    } else if (scmd == CMD_STATS) {
+        msgbuf_t *m = build_stats_reply();
+        if (m) {
+            spectator_send(k, m);
+            msgbuf_unref(m);
+        }
+    } else if (scmd == CMD_ANALYZE) {
+        analyze_request(spec[k]->fd, sbuf);
+    } else if (scmd == CMD_EXIT) {
+        remove_spectator(k);
+    } else if (spec[k]->attached) {
+        // 관전자는 읽기 전용
+        msgbuf_t *m = msgbuf_new("ERR SPECTATOR_READ_ONLY\n", 24);
+        if (m) {
+            spectator_send(k, m);
+            msgbuf_unref(m);
+        }
+    } else {
+        // 자리가 없는데 JOIN 등을 보낸 경우
+        conn_write(spec[k]->fd, "ERR SERVER_FULL\n", 16);
+        remove_spectator(k);
+    }
+}
+
+// 플레이어 좌석 i의 연결에서 받은 데이터 처리 (n <= 0: 연결 끊김)
+static void on_player_input(int i, char *buf, int n) {
+    if (n <= 0) {
+        // 게임에 참가 중이었다면 바로 정리하지 않고 재접속을 기다림
+        timer_cancel(&timers, &idle_timer[i]);
+        if (joined[i] && grace_sec > 0) {
+            hold_seat(i);
+            return;
+        }
+        // 클라이언트 연결 종료 처리
+        log_write("Client disconnected: FD=%d", client_fd[i]);
+        conn_close(client_fd[i]);
+        client_fd[i] = -1;
+        release_seat(i);
+        player_count--;
+        return;
+    }
+
+    buf[n] = '\0';
+    char *newline = strchr(buf, '\n');
+    if (newline) *newline = '\0';
+
+    log_write("Client[%d]: %s", i, buf);
+
+    touch_player(i);
+    TRACE_BEGIN("parse", client_fd[i]);
+    int cmd = parse_command(buf); // protocol.c에서 명령어 파싱
+    TRACE_END("parse");
+    int player_id = i + 1;        // 클라이언트 인덱스를 기반으로 1 또는 2로 매핑
+
+    // CMD_SPECTATE: 아직 JOIN하지 않은 연결은 플레이어 슬롯을 비우고 관전자로 전환
+    if (cmd == CMD_SPECTATE) {
+        if (joined[i]) {
+            conn_write(client_fd[i], "ERR ALREADY_JOINED\n", 19);
+            return;
+        }
+        // 관전 방송은 소켓 송신 큐로 나가므로 공유 메모리 채널은 닫음
+        shm_detach(client_fd[i], "SHM_OFF\n");
+        int k = add_spectator(client_fd[i]);
+        if (k < 0) {
+            conn_write(client_fd[i], "ERR SERVER_FULL\n", 16);
+            return;
+        }
+        // io_uring 송신 큐에 남은 응답은 관전자 큐 앞에 그대로 이어 감 (제출 중인 송신 포함)
+        if (use_uring) {
+            spec[k]->q = conn_outq[client_fd[i]];
+            outq_init(&conn_outq[client_fd[i]]);
+        }
+        timer_cancel(&timers, &idle_timer[i]);
+        client_fd[i] = -1;
+        player_count--;
+        spec[k]->attached = 1;
+        timer_cancel(&timers, &spec[k]->idle_timer);
+        log_write("Spectator attached: FD=%d (%d watching)", spec[k]->fd, spec_count);
+        send_spectator_snapshot(k, current_turn, game_over);
+        return;
+    }
+
+    // CMD_RESUME: 아직 JOIN하지 않은 연결이 끊겼던 좌석으로 복귀
+    if (cmd == CMD_RESUME) {
+        int fd_i = client_fd[i];
+        if (joined[i] || resume_seat(fd_i, buf) < 0) {
+            conn_write(fd_i, "ERR INVALID_TOKEN\n", 18);
+            return;
+        }
+        // 임시로 차지했던 플레이어 슬롯 반납
+        timer_cancel(&timers, &idle_timer[i]);
+        client_fd[i] = -1;
+        player_count--;
+        return;
+    }
+
+    // CMD_SHM: 공유 메모리 전송으로 전환 (같은 호스트의 봇용, 응답 줄과 함께 fd를 넘김)
+    if (cmd == CMD_SHM) {
+        if (!shm_attach(client_fd[i])) conn_write(client_fd[i], "ERR SHM_UNAVAILABLE\n", 20);
+        return;
+    }
+
+    // CMD_SYNC: 현재 판 상태 전송 (재접속한 클라이언트의 보드 복원용)
+    if (cmd == CMD_SYNC) {
+        msgbuf_t *m = build_sync_reply(buf, current_turn, game_over);
+        if (m) {
+            conn_write(client_fd[i], m->data, m->len);
+            msgbuf_unref(m);
+        }
+        return;
+    }
+
+    // CMD_STATS: 서버 상태 조회 (AI 난이도별 CPU 사용량)
+    if (cmd == CMD_STATS) {
+        msgbuf_t *m = build_stats_reply();
+        if (m) {
+            conn_write(client_fd[i], m->data, m->len);
+            msgbuf_unref(m);
+        }
+        return;
+    }
+
+    // CMD_ANALYZE: 국면 분석 (상위 후보 수와 점수, 빈 시간에 계산하므로 응답은 나중에 올 수 있음)
+    if (cmd == CMD_ANALYZE) {
+        analyze_request(client_fd[i], buf);
+        return;
+    }
+
+    // CMD_JOIN 처리: 클라이언트가 게임에 참가 요청
+    if (cmd == CMD_JOIN) {
+        // 과부하 중에는 새 플레이어를 받지 않음 (연결은 유지, 클라이언트가 재시도)
+        if (!joined[i] && overload_reject(client_fd[i])) {
+            log_write("JOIN from FD=%d rejected: server busy", client_fd[i]);
+            return;
+        }
+        joined[i] = 1;
+        timer_cancel(&timers, &idle_timer[i]);
+        int fd_i = client_fd[i];
+
+        if (i == 0) {
+            // 첫 번째 플레이어
+            conn_write(fd_i, "OK PLAYER1\n", 11);
+            issue_token(i);
+
+            // ★ 모드 선택 요청 보내기 (P1만 선택)
+            send_mode_select_message(fd_i);
+
+            log_write("Player 1 joined. Waiting for mode selection.");
+        } else {
+            // 두 번째 플레이어
+            conn_write(fd_i, "OK PLAYER2\n", 11);
+            issue_token(i);
+            log_write("Player 2 joined.");
+
+            // ★ PVP 모드에서만 두 번째가 들어왔을 때 바로 시작
+            if (game_mode == MODE_PVP && joined[0] && joined[1]) {
+                log_write("All players joined in PVP mode. Starting game.");
+                broadcast_variant();
+                broadcast(client_fd, "START\n");
+                broadcast(client_fd, "TURN 1\n");
+                on_game_start();
             }
         }
+        return;
+    }
 
-        // 타임아웃 설정 (1초마다 깨어나 시그널 처리 여부 확인)
-        struct timeval timeout;
-        timeout.tv_sec = 1;
-        timeout.tv_usec = 0;
+    // ★ CMD_MODE: 플레이어 1이 모드 선택 (1: PVAI, 2: PVP)
+    if (cmd == CMD_MODE) {
+        int mode_num = 0;
+        if (sscanf(buf, "MODE %d", &mode_num) != 1) {
+            conn_write(client_fd[i], "ERR INVALID_MODE\n", 18);
+            log_write("Invalid MODE from P%d: %s", player_id, buf);
+            return;
+        }
 
-        int activity = select(maxfd + 1, &readfds, NULL, NULL, &timeout);
+        // 진행 중인 게임은 모드 선택으로 다시 시작하지 않음 (끝난 뒤나 RESTART 뒤에만)
+        if (in_game && !game_over) {
+            conn_write(client_fd[i], "ERR GAME_IN_PROGRESS\n", 21);
+            log_write("MODE from P%d rejected: game in progress", player_id);
+            return;
+        }
 
-        if (activity < 0 && running) {
-            // select가 시그널 등으로 인터럽트된 경우를 제외한 에러 처리
-            log_write("Select error");
-            continue;
+        // 과부하 중에는 AI 게임을 새로 시작하지 않음 (PVP는 AI를 쓰지 않으므로 허용)
+        if (mode_num == 1 && overload_reject(client_fd[i])) {
+            log_write("PVAI mode from P%d rejected: server busy", player_id);
+            return;
         }
 
-        if (activity == 0) continue; // 타임아웃 시 다시 루프
-
-        // 새 클라이언트 접속 처리
-        if (FD_ISSET(server_fd, &readfds)) {
-            int new_fd = accept(server_fd, NULL, NULL);
-            if (new_fd != -1) {
-                if (player_count < MAX_CLIENTS) {
-                    int slot = (client_fd[0] == -1) ? 0 : 1;
-                    client_fd[slot] = new_fd;
-                    log_write("Client connected: FD=%d (Slot %d)", new_fd, slot);
-                    player_count++;
-                } else {
-                    // 인원이 꽉 찬 경우 새 연결은 바로 종료
-                    close(new_fd);
-                }
+        // 선택적으로 판 변형과 규칙 지정: MODE <모드> <판 크기> <승리 길이> <규칙>
+        // (생략하면 기본 15x15/5목, 규칙 0: 자유룰 1: 렌주룰)
+        if (mode_num == 1 || mode_num == 2) {
+            int size = BOARD_SIZE, win = WIN_LEN, rule = RULE_FREESTYLE, level = AI_LEVEL_DEFAULT;
+            sscanf(buf, "MODE %d %d %d %d %d", &mode_num, &size, &win, &rule, &level);
+            if (level < AI_LEVEL_MIN || level > AI_LEVEL_MAX) {
+                conn_write(client_fd[i], "ERR BAD_LEVEL\n", 14);
+                log_write("Unsupported AI level from P%d: %d", player_id, level);
+                return;
             }
+            // 판 크기, 승리 길이, 규칙을 모두 확인한 뒤에만 판을 바꿈
+            int variant = board_find_variant(size, win);
+            if (variant < 0) {
+                conn_write(client_fd[i], "ERR BAD_VARIANT\n", 16);
+                log_write("Unsupported variant from P%d: %dx%d/%d", player_id, size, size, win);
+                return;
+            }
+            if (!board_rule_ok(variant, rule)) {
+                conn_write(client_fd[i], "ERR BAD_RULE\n", 13);
+                log_write("Unsupported rule from P%d: %d", player_id, rule);
+                return;
+            }
+            board_set_variant(variant);
+            board_set_rule(rule);
+            init_board();
+            ai_level = level;
+            log_write("Variant selected: %dx%d, %d in a row, rule %d, AI level %d",
+                      size, size, win, rule, level);
         }
 
-        // 각 클라이언트로부터 온 메시지 처리
-        for (int i = 0; i < MAX_CLIENTS; i++) {
-            if (client_fd[i] == -1) continue;
-            if (!FD_ISSET(client_fd[i], &readfds)) continue;
+        if (mode_num == 1) {
+            // 사람 vs AI 모드 선택
+            game_mode = MODE_PVAI;
+            log_write("Player %d selected PVAI mode.", player_id);
 
-            char buf[256] = {0};
-            int n = read(client_fd[i], buf, sizeof(buf) - 1);
-            
-            if (n <= 0) {
-                // 클라이언트 연결 종료 처리
-                log_write("Client disconnected: FD=%d", client_fd[i]);
-                close(client_fd[i]);
-                client_fd[i] = -1;
-                joined[i] = 0;
-                player_count--;
-                continue;
+            init_board();
+            current_turn = 1;
+            game_over = 0;
+
+            broadcast_variant();
+
+            broadcast(client_fd, "START\n");
+            broadcast(client_fd, "TURN 1\n");
+
+            on_game_start();
+            return;
+
+        } else if (mode_num == 2) {
+            // 사람 vs 사람 모드 선택
+            game_mode = MODE_PVP;
+            log_write("Player %d selected PVP mode. Waiting for opponent.", player_id);
+
+            conn_write(client_fd[i],
+                  "상대방을 기다리는 중입니다...\n",
+                  strlen("상대방을 기다리는 중입니다...\n"));
+
+            // 이미 2명이 접속해 있다면 바로 게임 시작
+            if (joined[0] && joined[1]) {
+                log_write("Second player already joined. Starting PVP game.");
+                broadcast_variant();
+                broadcast(client_fd, "START\n");
+                broadcast(client_fd, "TURN 1\n");
+                on_game_start();
             }
+            return;
+
+        } else {
+            // 허용되지 않는 모드 번호
+            conn_write(client_fd[i], "ERR MODE_MUST_BE_1_OR_2\n", 24);
+            log_write("Out-of-range MODE from P%d: %d", player_id, mode_num);
+            return;
+        }
+    }
+
+    // CMD_MOVE: 돌 두기 요청 처리
+    if (cmd == CMD_MOVE) {
+        if (game_over) {
+            conn_write(client_fd[i], "ERR GAME_OVER\n", 14);
+            return;
+        }
+        if (player_id != current_turn) {
+            conn_write(client_fd[i], "ERR NOT_YOUR_TURN\n", 19);
+            return;
+        }
+
+        int x, y;
+        if (sscanf(buf + 5, "%d %d", &x, &y) != 2) {
+            conn_write(client_fd[i], "ERR BAD_FORMAT\n", 16);
+            return;
+        }
+
+        // 게임 로그를 디스크에 쓸 수 없으면 받아들인 수를 잃을 수 있으므로 새 수를 받지 않음
+        if (!persist_ready()) {
+            conn_write(client_fd[i], "ERR STORAGE_FAILED\n", 19);
+            log_write("Move by P%d refused: game log commit failing", player_id);
+            return;
+        }
+
+        // 렌주룰의 흑 금수 (장목, 4-4, 3-3)
+        if (board_is_forbidden(x, y, player_id)) {
+            conn_write(client_fd[i], "ERR FORBIDDEN_MOVE\n", 19);
+            log_write("Forbidden move by P%d at (%d, %d)", player_id, x, y);
+            return;
+        }
+
+        // 1) 먼저 사람의 수 처리 (모든 모드 공통)
+        TRACE_BEGIN("place_stone", player_id);
+        int valid = place_stone(x, y, player_id);
+        TRACE_END("place_stone");
+        if (!valid) {
+            conn_write(client_fd[i], "ERR INVALID_MOVE\n", 18);
+            return;
+        }
 
-            buf[n] = '\0';
-            char *newline = strchr(buf, '\n');
-            if (newline) *newline = '\0';
-            
-            log_write("Client[%d]: %s", i, buf);
-
-            int cmd = parse_command(buf); // protocol.c에서 명령어 파싱
-            int player_id = i + 1;        // 클라이언트 인덱스를 기반으로 1 또는 2로 매핑
-
-            // CMD_JOIN 처리: 클라이언트가 게임에 참가 요청
-            if (cmd == CMD_JOIN) {
-                joined[i] = 1;
-                int fd_i = client_fd[i];
-
-                if (i == 0) {
-                    // 첫 번째 플레이어
-                    write(fd_i, "OK PLAYER1\n", 11);
-
-                    // ★ 모드 선택 요청 보내기 (P1만 선택)
-                    send_mode_select_message(fd_i);
-
-                    log_write("Player 1 joined. Waiting for mode selection.");
-                } else {
-                    // 두 번째 플레이어
-                    write(fd_i, "OK PLAYER2\n", 11);
-                    log_write("Player 2 joined.");
-
-                    // ★ PVP 모드에서만 두 번째가 들어왔을 때 바로 시작
-                    if (game_mode == MODE_PVP && joined[0] && joined[1]) {
-                        log_write("All players joined in PVP mode. Starting game.");
-                        broadcast(client_fd, "START\n");
-                        broadcast(client_fd, "TURN 1\n");
+        clock_stop();  // 둔 사람의 시계 정지
+        persist_move(x, y, player_id);
+        log_write("Player %d move (%d, %d)", player_id, x, y);
+
+        // 2) 사람이 이겼는지 먼저 확인 (결과까지 로그에 내린 뒤 방송)
+        TRACE_BEGIN("check_win", player_id);
+        int won = check_win(player_id);
+        TRACE_END("check_win");
+        if (won) persist_end(player_id);
+        persist_sync();
+
+        // 모든 클라이언트에게 방금 둔 수를 방송
+        char move_msg[64];
+        snprintf(move_msg, sizeof(move_msg), "MOVE %d %d %d\n", player_id, x, y);
+        broadcast(client_fd, move_msg);
+
+        if (won) {
+            char win_msg[32];
+            snprintf(win_msg, sizeof(win_msg), "WIN P%d\n", player_id);
+            broadcast(client_fd, win_msg);
+            broadcast(client_fd, "GAME_OVER\n");
+            game_over = 1;
+            log_write("Game Over. Winner: P%d", player_id);
+            record_game(player_id);
+            return;
+        }
+
+        // ===============================
+        //  모드별 분기
+        // ===============================
+
+        // (1) 사람 vs 사람(PVP) 모드: 턴만 교대로 변경
+        if (game_mode == MODE_PVP) {
+            current_turn = (current_turn == 1) ? 2 : 1;
+            char turn_msg[32];
+            snprintf(turn_msg, sizeof(turn_msg), "TURN %d\n", current_turn);
+            broadcast(client_fd, turn_msg);
+            clock_start(current_turn);
+            return;
+        }
+
+        // (2) 사람 vs AI(PVAI) 모드: AI의 수를 바로 계산 및 처리
+        if (game_mode == MODE_PVAI) {
+            int ai_player = 2;
+            int ax = -1, ay = -1;
+
+            // ★ 방금 사람(P1)이 둔 좌표 (x, y)를 기준으로
+            //   AI가 둘 최적의 자리를 계산
+            ai_move(ai_level, x, y, &ax, &ay);
+
+            // 안전 장치: 혹시라도 선택 좌표가 유효하지 않으면
+            if (!in_range(ax, ay) || get_stone(ax, ay) != 0) {
+                // fallback: 가장 왼쪽 위부터 빈칸을 찾는 간단한 전략
+                int placed = 0;
+                int n = board_get_size();
+                for (int yy = 0; yy < n && !placed; yy++) {
+                    for (int xx = 0; xx < n && !placed; xx++) {
+                        if (place_stone(xx, yy, ai_player)) {
+                            ax = xx;
+                            ay = yy;
+                            placed = 1;
+                        }
                     }
                 }
-                continue;
+                // 둘 곳이 없는 경우 (무승부)
+                if (!placed) {
+                    persist_end(0);
+                    persist_sync();
+                    broadcast(client_fd, "GAME_OVER\n");
+                    game_over = 1;
+                    log_write("Game Over. Board full (draw).");
+                    record_game(0);
+                    return;
+                }
+            } else {
+                // 정상적으로 선택된 좌표에 AI 돌을 놓음
+                TRACE_BEGIN("place_stone", ai_player);
+                place_stone(ax, ay, ai_player);
+                TRACE_END("place_stone");
+            }
+            persist_move(ax, ay, ai_player);
+
+            // AI 승리 여부 판정 (결과까지 로그에 내린 뒤 방송)
+            TRACE_BEGIN("check_win", ai_player);
+            won = check_win(ai_player);
+            TRACE_END("check_win");
+            if (won) persist_end(ai_player);
+            persist_sync();
+
+            // AI가 둔 수를 클라이언트에 알림
+            char ai_move_msg[64];
+            snprintf(ai_move_msg, sizeof(ai_move_msg),
+                     "MOVE %d %d %d\n", ai_player, ax, ay);
+            broadcast(client_fd, ai_move_msg);
+
+            if (won) {
+                char win_msg[32];
+                snprintf(win_msg, sizeof(win_msg), "WIN P%d\n", ai_player);
+                broadcast(client_fd, win_msg);
+                broadcast(client_fd, "GAME_OVER\n");
+                game_over = 1;
+                log_write("Game Over. Winner: AI(P2)");
+                record_game(ai_player);
+                return;
             }
 
-	    // ★ CMD_MODE: 플레이어 1이 모드 선택 (1: PVAI, 2: PVP)
-            if (cmd == CMD_MODE) {
-                int mode_num = 0;
-                if (sscanf(buf, "MODE %d", &mode_num) != 1) {
-                    write(client_fd[i], "ERR INVALID_MODE\n", 18);
-                    log_write("Invalid MODE from P%d: %s", player_id, buf);
-                    continue;
-                }
+            // 게임이 계속되면 다시 사람 차례로 되돌림
+            current_turn = player_id;  // 보통 1
+            char turn_msg[32];
+            snprintf(turn_msg, sizeof(turn_msg), "TURN %d\n", current_turn);
+            broadcast(client_fd, turn_msg);
+            clock_start(current_turn);
+            return;
+            }
+        // (예외) 모드가 설정되지 않은 경우: 기본적으로 PVP와 동일하게 턴 교대
+        current_turn = (current_turn == 1) ? 2 : 1;
+        char turn_msg[32];
+        snprintf(turn_msg, sizeof(turn_msg), "TURN %d\n", current_turn);
+        broadcast(client_fd, turn_msg);
+        clock_start(current_turn);
+        return;
+    }
 
-                if (mode_num == 1) {
-                    // 사람 vs AI 모드 선택
-                    game_mode = MODE_PVAI;
-                    log_write("Player %d selected PVAI mode.", player_id);
-
-                    init_board();
-                    current_turn = 1;
-                    game_over = 0;
-
-                    broadcast(client_fd, "START\n");
-                    broadcast(client_fd, "TURN 1\n");
-                    continue;
-
-                } else if (mode_num == 2) {
-                    // 사람 vs 사람 모드 선택
-                    game_mode = MODE_PVP;
-                    log_write("Player %d selected PVP mode. Waiting for opponent.", player_id);
-
-                    write(client_fd[i],
-                          "상대방을 기다리는 중입니다...\n",
-                          strlen("상대방을 기다리는 중입니다...\n"));
-
-                    // 이미 2명이 접속해 있다면 바로 게임 시작
-                    if (joined[0] && joined[1]) {
-                        log_write("Second player already joined. Starting PVP game.");
-                        broadcast(client_fd, "START\n");
-                        broadcast(client_fd, "TURN 1\n");
-                    }
-                    continue;
 
-                } else {
-                    // 허용되지 않는 모드 번호
-                    write(client_fd[i], "ERR MODE_MUST_BE_1_OR_2\n", 24);
-                    log_write("Out-of-range MODE from P%d: %d", player_id, mode_num);
-                    continue;
-                }
+
+    // CMD_RESTART: 게임이 끝난 뒤 재시작 요청
+    if (cmd == CMD_RESTART) {
+        if (!game_over) {
+            conn_write(client_fd[i], "ERR NOT_GAME_OVER\n", 18);
+            return;
+        }
+        log_write("Game Restart requested by P%d", player_id);
+
+        // 1. 보드 초기화
+        init_board();
+
+        // 2. 상태 초기화
+        current_turn = 1;
+        game_over = 0;
+
+        // 3. 클라이언트에 알림
+        broadcast(client_fd, "RESET\n");
+        broadcast(client_fd, "TURN 1\n");
+        on_game_start();
+        return;
+    }
+
+    // CMD_EXIT: 한 플레이어가 종료를 요청한 경우 처리
+    if (cmd == CMD_EXIT) {
+        log_write("Player %d exited", player_id);
+
+        // 상대 플레이어 인덱스 계산 (0 ↔ 1)
+        int other = (i == 0) ? 1 : 0;
+
+        // 상대에게 "상대가 나갔습니다" 알림
+        if (client_fd[other] != -1) {
+            conn_write(client_fd[other], "OPPONENT_EXIT\n", 14);
+        }
+
+        // 나간 쪽 정리
+        timer_cancel(&timers, &idle_timer[i]);
+        conn_close(client_fd[i]);
+        client_fd[i] = -1;
+        release_seat(i);
+        player_count--;
+
+        // 상대가 재접속 대기 중이었다면 그 자리도 정리 (돌아올 게임이 없음)
+        if (seat_held[other]) release_seat(other);
+
+        // 게임 상태 초기화 (새 게임을 위해 보드/턴/종료 상태 재설정)
+        reset_game_state();
+
+        /* 이전 버전: 단순히 GAME_OVER 방송만 하고 종료시켰던 코드
+        close(client_fd[i]);
+        client_fd[i] = -1;
+        joined[i] = 0;
+        player_count--;
+        broadcast(client_fd, "GAME_OVER\n"); // 상대방에게 종료 알림
+        game_over = 1;*/
+        return;
+    }
+}
+
+// 연결이 지금 플레이어 좌석이나 관전자 슬롯에 있는지
+static int conn_known(int fd) {
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (client_fd[i] == fd) return 1;
+    }
+    return spectator_slot(fd) >= 0;
+}
+
+// 받은 데이터를 연결이 지금 속한 곳(좌석 / 관전자 슬롯)의 처리로 넘김 (이미 정리된 연결이면 무시)
+static void on_conn_line(int fd, char *buf, int n) {
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (client_fd[i] == fd) {
+            on_player_input(i, buf, n);
+            return;
+        }
+    }
+    int k = spectator_slot(fd);
+    if (k >= 0) on_spectator_input(k, buf, n);
+}
+
+// 명령의 속도 제한 분류 (분류가 없는 명령은 "모든 명령" 버킷만 씀)
+static int rate_class(int cmd) {
+    if (cmd == CMD_MOVE) return RATE_MOVE;
+    if (cmd == CMD_ANALYZE) return RATE_ANALYZE;
+    if (cmd == CMD_STATS) return RATE_STATS;
+    if (cmd == CMD_SYNC) return RATE_SYNC;
+    return -1;
+}
+
+// 명령 한 줄의 속도 제한 확인 (처리할 줄이면 1)
+// 한도를 넘으면 로그도 남기지 않고 ERR RATE_LIMITED로 거절하고, 거절이 계속되면(strike 소진)
+// 소켓을 끊음 (다음 바퀴에 끊긴 연결로 정리되고, 그 사이에 온 줄은 모두 버림)
+static int rate_admit(int fd, const char *line) {
+    if (fd >= FD_SETSIZE) return 1;
+    rate_state_t *s = &conn_rate[fd];
+    if (s->blocked) return 0;
+
+    uint64_t now = timer_now_ms();
+    int cls = rate_class(parse_command(line));
+    if (rate_take(s, RATE_ALL, now) && (cls < 0 || rate_take(s, cls, now))) return 1;
+
+    rate_limited++;
+    conn_reply(fd, "ERR RATE_LIMITED\n", 17);
+    if (!conn_known(fd) || rate_take(s, RATE_STRIKE, now)) return 0;
+    s->blocked = 1;
+    rate_disconnects++;
+    log_write("Rate limit exceeded repeatedly, disconnecting: FD=%d", fd);
+    shutdown(fd, SHUT_RDWR);
+    return 0;
+}
+
+// 받은 데이터를 연결의 줄 버퍼에 이어 붙이고, 개행까지 온 줄마다 따로 처리
+// (명령을 몰아 보내는 봇은 한 번에 여러 줄, 긴 ANALYZE 요청은 여러 번의 읽기에 걸쳐 옴)
+// 줄마다 연결을 다시 찾으므로 앞 줄에서 좌석/관전자가 바뀌거나 닫혀도 안전함
+static void on_conn_input(int fd, char *buf, int n) {
+    if (n <= 0 || fd >= FD_SETSIZE) {
+        on_conn_line(fd, buf, n);
+        return;
+    }
+    conn_inbuf_t *in = &conn_in[fd];
+    int off = 0;
+    while (off < n) {
+        const char *nl = memchr(buf + off, '\n', n - off);
+        int chunk = nl ? (int)(nl - (buf + off)) + 1 : n - off;
+        const char *src = buf + off;
+        off += chunk;
+
+        if (!in->discard && in->len + chunk > CONN_LINE_MAX - 1) {
+            in->len = 0;
+            in->discard = 1;
+            conn_reply(fd, "ERR LINE_TOO_LONG\n", 18);
+        }
+        if (in->discard) {
+            if (nl) in->discard = 0;
+            continue;
+        }
+        memcpy(in->data + in->len, src, chunk);
+        in->len += chunk;
+        if (!nl) break;   // 줄의 나머지는 다음 읽기에서
+
+        char line[CONN_LINE_MAX];
+        int len = in->len;
+        memcpy(line, in->data, len);
+        line[len] = '\0';
+        in->len = 0;
+        if (len == 1 && line[0] == '\n') continue;
+        if (!conn_known(fd)) return;
+        if (!rate_admit(fd, line)) continue;
+        TRACE_BEGIN("command", fd);
+        on_conn_line(fd, line, len);
+        TRACE_END("command");
+    }
+}
+
+// 공유 메모리 채널로 들어온 명령 처리 (소켓으로 받은 것과 같은 처리 함수로). 반환: 처리한 줄 수
+static int shm_dispatch() {
+    int handled = 0;
+    for (int k = 0; k < SHM_MAX_CONNS && shm_count > 0; k++) {
+        if (!shm_conns[k].active) continue;
+        shm_wait_done(&shm_conns[k].chan);
+        int fd = shm_conns[k].fd;
+        for (int l = 0; l < SHM_DISPATCH_MAX; l++) {
+            // 처리 중에 연결이 닫혔으면(EXIT 등) 그만 읽음
+            if (!shm_conns[k].active || shm_conns[k].fd != fd) break;
+            char buf[SHM_LINE_MAX];
+            int n = shm_read_line(&shm_conns[k].chan, buf, sizeof(buf));
+            if (n < 0) {
+                log_write("Shared memory ring corrupted, closing channel: FD=%d", fd);
+                shm_detach(fd, "SHM_OFF\n");
+                break;
             }
+            if (n == 0) break;
+            shm_lines_in++;
+            handled++;
+            on_conn_input(fd, buf, n);
+        }
+    }
+    return handled;
+}
 
-            // CMD_MOVE: 돌 두기 요청 처리
-            if (cmd == CMD_MOVE) {
-                if (game_over) {
-                    write(client_fd[i], "ERR GAME_OVER\n", 14);
-                    continue;
-                }
-                if (player_id != current_turn) {
-                    write(client_fd[i], "ERR NOT_YOUR_TURN\n", 19);
-                    continue;
-                }
+// select 백엔드: 읽을 것이 있는 연결을 먼저 모두 모은 뒤 처리
+// (처리 중 연결이 관전자 슬롯과 좌석 사이를 옮겨도 이번 바퀴에 한 번만 읽음)
+// 반환: select 결과 (시그널로 깨어났으면 0)
+static int select_poll(uint64_t wait_ms) {
+    fd_set readfds, writefds;
+    FD_ZERO(&readfds);
+    FD_ZERO(&writefds);
 
-                int x, y;
-                if (sscanf(buf + 5, "%d %d", &x, &y) != 2) {
-                    write(client_fd[i], "ERR BAD_FORMAT\n", 16);
-                    continue;
-                }
+    // 서버 소켓을 감시 집합에 추가
+    FD_SET(server_fd, &readfds);
+    int maxfd = server_fd;
 
-                // 1) 먼저 사람의 수 처리 (모든 모드 공통)
-                if (!place_stone(x, y, player_id)) {
-                    write(client_fd[i], "ERR INVALID_MOVE\n", 18);
-                    continue;
-                }
+    // 각 클라이언트 소켓도 감시 집합에 추가
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (client_fd[i] != -1) {
+            FD_SET(client_fd[i], &readfds);
+            if (client_fd[i] > maxfd) maxfd = client_fd[i];
+        }
+    }
 
-                log_write("Player %d move (%d, %d)", player_id, x, y);
+    // 관전자 소켓 추가 (보낼 데이터가 밀려 있으면 쓰기 가능 여부도 감시)
+    for (int k = 0; k < MAX_SPECTATORS && spec_count > 0; k++) {
+        if (!spec[k]) continue;
+        FD_SET(spec[k]->fd, &readfds);
+        if (outq_pending(&spec[k]->q)) FD_SET(spec[k]->fd, &writefds);
+        if (spec[k]->fd > maxfd) maxfd = spec[k]->fd;
+    }
 
-                // 모든 클라이언트에게 방금 둔 수를 방송
-                char move_msg[64];
-                snprintf(move_msg, sizeof(move_msg), "MOVE %d %d %d\n", player_id, x, y);
-                broadcast(client_fd, move_msg);
+    // 공유 메모리 채널의 깨우기 eventfd
+    for (int k = 0; k < SHM_MAX_CONNS && shm_count > 0; k++) {
+        if (!shm_conns[k].active) continue;
+        FD_SET(shm_conns[k].chan.rx_efd, &readfds);
+        if (shm_conns[k].chan.rx_efd > maxfd) maxfd = shm_conns[k].chan.rx_efd;
+    }
 
-                // 2) 사람이 이겼는지 먼저 확인
-                if (check_win(player_id)) {
-                    char win_msg[32];
-                    snprintf(win_msg, sizeof(win_msg), "WIN P%d\n", player_id);
-                    broadcast(client_fd, win_msg);
-                    broadcast(client_fd, "GAME_OVER\n");
-                    game_over = 1;
-                    log_write("Game Over. Winner: P%d", player_id);
-                    continue;
-                }
+    struct timeval timeout;
+    timeout.tv_sec = wait_ms / 1000;
+    timeout.tv_usec = (wait_ms % 1000) * 1000;
+
+    uint64_t wait_start = mono_us();
+    TRACE_BEGIN("io_wait", maxfd);
+    int activity = select(maxfd + 1, &readfds, &writefds, NULL, &timeout);
+    TRACE_END("io_wait");
+    io_wait_us += mono_us() - wait_start;
+    if (activity < 0 && errno == EINTR) return 0;
+    if (activity <= 0) return activity;
+
+    for (int k = 0; k < SHM_MAX_CONNS && shm_count > 0; k++) {
+        if (shm_conns[k].active && FD_ISSET(shm_conns[k].chan.rx_efd, &readfds)) {
+            shm_clear_signal(&shm_conns[k].chan);
+        }
+    }
 
-                // ===============================
-                //  모드별 분기
-                // ===============================
-
-                // (1) 사람 vs 사람(PVP) 모드: 턴만 교대로 변경
-                if (game_mode == MODE_PVP) {
-                    current_turn = (current_turn == 1) ? 2 : 1;
-                    char turn_msg[32];
-                    snprintf(turn_msg, sizeof(turn_msg), "TURN %d\n", current_turn);
-                    broadcast(client_fd, turn_msg);
-                    continue;
-                }
+    // 새 클라이언트 접속 처리
+    if (FD_ISSET(server_fd, &readfds)) {
+        TRACE_BEGIN("accept", -1);
+        int new_fd = accept(server_fd, NULL, NULL);
+        if (new_fd != -1) on_accept(new_fd);
+        TRACE_END("accept");
+    }
 
-                // (2) 사람 vs AI(PVAI) 모드: AI의 수를 바로 계산 및 처리
-                if (game_mode == MODE_PVAI) {
-                    int ai_player = 2;
-                    int ax = -1, ay = -1;
-
-                    // ★ 방금 사람(P1)이 둔 좌표 (x, y)를 기준으로
-                    //   AI가 둘 최적의 자리를 계산
-                    choose_ai_move(x, y, &ax, &ay);
-
-                    // 안전 장치: 혹시라도 선택 좌표가 유효하지 않으면
-                    if (!in_range(ax, ay) || get_stone(ax, ay) != 0) {
-                        // fallback: 가장 왼쪽 위부터 빈칸을 찾는 간단한 전략
-                        int placed = 0;
-                        for (int yy = 0; yy < BOARD_SIZE && !placed; yy++) {
-                            for (int xx = 0; xx < BOARD_SIZE && !placed; xx++) {
-                                if (place_stone(xx, yy, ai_player)) {
-                                    ax = xx;
-                                    ay = yy;
-                                    placed = 1;
-                                }
-                            }
-                        }
-                        // 둘 곳이 없는 경우 (무승부)
-                        if (!placed) {
-                            broadcast(client_fd, "GAME_OVER\n");
-                            game_over = 1;
-                            log_write("Game Over. Board full (draw).");
-                            continue;
-                        }
-                    } else {
-                        // 정상적으로 선택된 좌표에 AI 돌을 놓음
-                        place_stone(ax, ay, ai_player);
-                    }
+    // 관전자 밀린 송신, 읽을 연결 모으기 (관전자 먼저, 플레이어 나중)
+    int ready[MAX_SPECTATORS + MAX_CLIENTS];
+    int nready = 0;
+    for (int k = 0; k < MAX_SPECTATORS && spec_count > 0; k++) {
+        if (!spec[k]) continue;
+        if (FD_ISSET(spec[k]->fd, &writefds) && outq_flush(&spec[k]->q, spec[k]->fd) < 0) {
+            remove_spectator(k);
+            continue;
+        }
+        if (FD_ISSET(spec[k]->fd, &readfds)) ready[nready++] = spec[k]->fd;
+    }
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (client_fd[i] != -1 && FD_ISSET(client_fd[i], &readfds)) ready[nready++] = client_fd[i];
+    }
 
-                    // AI가 둔 수를 클라이언트에 알림
-                    char ai_move_msg[64];
-                    snprintf(ai_move_msg, sizeof(ai_move_msg),
-                             "MOVE %d %d %d\n", ai_player, ax, ay);
-                    broadcast(client_fd, ai_move_msg);
-
-                    // AI 승리 여부 판정
-                    if (check_win(ai_player)) {
-                        char win_msg[32];
-                        snprintf(win_msg, sizeof(win_msg), "WIN P%d\n", ai_player);
-                        broadcast(client_fd, win_msg);
-                        broadcast(client_fd, "GAME_OVER\n");
-                        game_over = 1;
-                        log_write("Game Over. Winner: AI(P2)");
-                        continue;
-                    }
+    // 각 연결로부터 온 메시지 처리 (앞선 처리에서 닫힌 연결은 건너뜀)
+    for (int r = 0; r < nready; r++) {
+        if (!conn_known(ready[r])) continue;
+        char buf[256] = {0};
+        TRACE_BEGIN("read", ready[r]);
+        int n = read(ready[r], buf, sizeof(buf) - 1);
+        TRACE_END("read");
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) continue;
+        on_conn_input(ready[r], buf, n);
+    }
+    return activity;
+}
 
-                    // 게임이 계속되면 다시 사람 차례로 되돌림
-                    current_turn = player_id;  // 보통 1
-                    char turn_msg[32];
-                    snprintf(turn_msg, sizeof(turn_msg), "TURN %d\n", current_turn);
-                    broadcast(client_fd, turn_msg);
-                    continue;
-                    }
-                // (예외) 모드가 설정되지 않은 경우: 기본적으로 PVP와 동일하게 턴 교대
-                current_turn = (current_turn == 1) ? 2 : 1;
-                char turn_msg[32];
-                snprintf(turn_msg, sizeof(turn_msg), "TURN %d\n", current_turn);
-                broadcast(client_fd, turn_msg);
+// io_uring 완료 처리 (받은 데이터는 select 경로와 같은 처리 함수로). 반환: 처리한 이벤트 수
+// 멀티샷 recv 완료는 처리하는 도중에도 계속 올라오므로 최대 max개까지만 처리
+// (응답을 받자마자 다음 명령을 보내는 봇이 한 바퀴를 끝없이 늘려 관전자 송신 제출을 굶기지 않도록)
+static int uring_dispatch(int max) {
+    uring_event_t ev;
+    int handled = 0;
+    while (handled < max && uring_next(&ev)) {
+        handled++;
+        if (ev.type == URING_EV_ACCEPT) {
+            TRACE_BEGIN("accept", ev.fd);
+            on_accept(ev.fd);
+            TRACE_END("accept");
+        } else if (ev.type == URING_EV_RECV) {
+            // 제공 버퍼는 복사한 뒤 바로 돌려줌 (처리 중에 다른 연결이 버퍼를 쓸 수 있도록)
+            char buf[256] = {0};
+            if (ev.res > 0) memcpy(buf, ev.data, ev.res);
+            uring_event_done(&ev);
+            on_conn_input(ev.fd, buf, ev.res);
+        } else if (ev.type == URING_EV_SENT) {
+            int k = spectator_slot(ev.fd);
+            if (k < 0) {
+                // 플레이어 연결: 에러면 소켓을 끊어 다음 recv 완료에서 연결 끊김으로 정리
+                if (ev.fd >= FD_SETSIZE) continue;
+                if (ev.res < 0) shutdown(ev.fd, SHUT_RDWR);
+                else outq_consume(&conn_outq[ev.fd], (size_t)ev.res);
                 continue;
             }
+            if (ev.res < 0) remove_spectator(k);
+            else outq_consume(&spec[k]->q, (size_t)ev.res);
+        } else if (ev.type == URING_EV_POLL) {
+            shm_signaled(ev.fd);
+        }
+    }
+    return handled;
+}
 
+// io_uring 백엔드: 이번 바퀴에 쌓인 응답과 방송을 연결마다 sendmsg 하나로 묶어
+// 완료 대기와 같은 io_uring_enter로 제출한 뒤 완료를 처리
+static int uring_poll(uint64_t wait_ms) {
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        int fd = client_fd[i];
+        if (fd != -1 && fd < FD_SETSIZE && outq_pending(&conn_outq[fd])) uring_send(fd, &conn_outq[fd]);
+    }
+    for (int k = 0; k < MAX_SPECTATORS && spec_count > 0; k++) {
+        if (spec[k] && outq_pending(&spec[k]->q)) uring_send(spec[k]->fd, &spec[k]->q);
+    }
+    uint64_t wait_start = mono_us();
+    TRACE_BEGIN("io_wait", -1);
+    int ready = uring_wait(wait_ms);
+    TRACE_END("io_wait");
+    io_wait_us += mono_us() - wait_start;
+    if (ready < 0) return -1;
+    return uring_dispatch(ready);
+}
 
-	    
-            // CMD_RESTART: 게임이 끝난 뒤 재시작 요청
-            if (cmd == CMD_RESTART) {
-                if (!game_over) {
-                    write(client_fd[i], "ERR NOT_GAME_OVER\n", 18);
-                    continue;
-                }
-                log_write("Game Restart requested by P%d", player_id);
-                
-                // 1. 보드 초기화
-                init_board();
-                
-                // 2. 상태 초기화
-                current_turn = 1;
-                game_over = 0;
-
-                // 3. 클라이언트에 알림
-                broadcast(client_fd, "RESET\n");
-                broadcast(client_fd, "TURN 1\n");
-                continue;
+// 핫 재시작 인계 상태 (게임 판은 뒤따르는 build_game_recs 레코드로 넘김)
+// fd 순서: 듣기 소켓, 연결된 플레이어 좌석(0, 1 순), 관전자 슬롯(k 순)
+#define HANDOFF_MAGIC   0x4f4d4b48   // "OMKH"
+#define HANDOFF_VERSION 1
+
+typedef struct handoff_state {
+    uint32_t magic, version;
+    int32_t  game_mode, in_game, game_over, current_turn, last_winner;
+    int32_t  variant, rule, ai_level;           // 게임 전(모드만 고른 상태)에도 유지할 판 설정
+    int32_t  clock_player;                      // 인계 직전에 시계가 돌던 플레이어 (0: 정지)
+    int64_t  bank_ms[MAX_CLIENTS];
+    int32_t  has_fd[MAX_CLIENTS], joined[MAX_CLIENTS], seat_held[MAX_CLIENTS];
+    char     token[MAX_CLIENTS][17];
+    int32_t  spec_n;                            // 넘기는 관전자 수
+    uint8_t  spec_attached[MAX_SPECTATORS];     // 넘기는 순서대로
+    int32_t  rec_n;                             // 뒤따르는 게임 레코드 수
+} handoff_state_t;
+
+// 인계 실패 뒤 io_uring 요청을 다시 검 (듣기 소켓과 모든 연결)
+static void io_rearm() {
+    uring_resume();
+    uring_listen(server_fd);
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (client_fd[i] != -1) uring_watch(client_fd[i]);
+    }
+    for (int k = 0; k < MAX_SPECTATORS; k++) {
+        if (spec[k]) uring_watch(spec[k]->fd);
+    }
+}
+
+// 송신 큐를 비움 (메시지 중간에서 끊긴 채 넘기지 않도록, 시간 안에 못 비운 관전자는 닫음)
+// 플레이어 소켓은 블로킹이므로 io_uring 큐에 남은 응답을 그대로 씀
+static void drain_spectators(int timeout_ms) {
+    uint64_t deadline = timer_now_ms() + (uint64_t)timeout_ms;
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        int fd = client_fd[i];
+        if (fd == -1 || fd >= FD_SETSIZE) continue;
+        int left = outq_pending(&conn_outq[fd]);
+        while (left > 0) left = outq_flush(&conn_outq[fd], fd);
+        if (left < 0) shutdown(fd, SHUT_RDWR);
+        outq_clear(&conn_outq[fd]);
+    }
+    for (int k = 0; k < MAX_SPECTATORS; k++) {
+        while (spec[k] && outq_pending(&spec[k]->q)) {
+            uint64_t now = timer_now_ms();
+            struct pollfd p = { spec[k]->fd, POLLOUT, 0 };
+            if (now >= deadline || poll(&p, 1, (int)(deadline - now)) <= 0 ||
+                outq_flush(&spec[k]->q, spec[k]->fd) < 0) {
+                remove_spectator(k);
+            }
+        }
+    }
+}
+
+// SIGUSR2 처리: 새 바이너리를 띄워 상태와 fd를 넘기고, 준비 완료 응답을 받으면 1 (호출자는 루프 종료)
+// 실패하면 0을 반환하고 이 프로세스가 계속 서비스함
+static int hot_restart() {
+    static handoff_state_t st;
+    static wal_rec_t recs[GAME_RECS_MAX];
+    int fds[1 + MAX_CLIENTS + MAX_SPECTATORS];
+    int nfds = 0;
+
+    // io_uring: 걸어 둔 요청을 모두 거두고 이미 받은 완료까지 처리해야 fd를 넘길 수 있음
+    if (use_uring) {
+        uring_cancel_all();
+        uring_dispatch(URING_CQ_ENTRIES);
+    }
+    // 공유 메모리 채널은 넘기지 않음: 링에 SHM_OFF를 남겨 봇이 소켓으로 이어 가게 함
+    for (int k = 0; k < SHM_MAX_CONNS; k++) {
+        if (shm_conns[k].active) shm_detach(shm_conns[k].fd, "SHM_OFF\n");
+    }
+    persist_flush();
+    drain_spectators(500);
+    int clock_was = clock_player;
+    clock_stop();
+
+    memset(&st, 0, sizeof(st));
+    st.magic = HANDOFF_MAGIC;
+    st.version = HANDOFF_VERSION;
+    st.game_mode = game_mode;
+    st.in_game = in_game;
+    st.game_over = game_over;
+    st.current_turn = current_turn;
+    st.last_winner = last_winner;
+    st.variant = cur_game->state.variant;
+    st.rule = cur_game->state.rule;
+    st.ai_level = ai_level;
+    st.clock_player = clock_was;
+    fds[nfds++] = server_fd;
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        st.bank_ms[i] = bank_ms[i];
+        st.has_fd[i] = (client_fd[i] != -1);
+        st.joined[i] = joined[i];
+        st.seat_held[i] = seat_held[i];
+        memcpy(st.token[i], seat_token[i], sizeof(st.token[i]));
+        if (client_fd[i] != -1) fds[nfds++] = client_fd[i];
+    }
+    for (int k = 0; k < MAX_SPECTATORS; k++) {
+        if (!spec[k]) continue;
+        st.spec_attached[st.spec_n++] = (uint8_t)spec[k]->attached;
+        fds[nfds++] = spec[k]->fd;
+    }
+    st.rec_n = build_game_recs(recs);
+
+    pid_t pid;
+    int ctl = handoff_spawn(saved_argv, &pid);
+    int ok = ctl != -1 &&
+             handoff_send(ctl, &st, sizeof(st)) &&
+             handoff_send(ctl, recs, sizeof(wal_rec_t) * st.rec_n) &&
+             handoff_send_fds(ctl, fds, nfds) &&
+             handoff_wait_ack(ctl, HANDOFF_TIMEOUT_MS) == 'R';
+    if (ctl != -1) close(ctl);
+
+    if (!ok) {
+        if (ctl != -1) kill(pid, SIGKILL);
+        log_write("Hot restart failed. Continuing with PID %d", getpid());
+        if (clock_was) clock_start(clock_was);
+        if (use_uring) io_rearm();
+        return 0;
+    }
+    log_write("Handed off %d connections to PID %d", nfds - 1, pid);
+    return 1;
+}
+
+// 인계 받기 (-H <fd>): 옛 프로세스의 상태와 fd로 게임과 연결을 되살리고 준비 완료 응답
+static int hot_restart_receive(int ctl) {
+    static handoff_state_t st;
+    static wal_rec_t recs[GAME_RECS_MAX];
+    int fds[1 + MAX_CLIENTS + MAX_SPECTATORS];
+
+    if (!handoff_recv(ctl, &st, sizeof(st)) || st.magic != HANDOFF_MAGIC ||
+        st.version != HANDOFF_VERSION || st.rec_n < 0 || st.rec_n > GAME_RECS_MAX ||
+        st.spec_n < 0 || st.spec_n > MAX_SPECTATORS ||
+        !handoff_recv(ctl, recs, sizeof(wal_rec_t) * st.rec_n)) {
+        return 0;
+    }
+    int nfds = 1 + st.spec_n;
+    for (int i = 0; i < MAX_CLIENTS; i++) nfds += st.has_fd[i] ? 1 : 0;
+    if (!handoff_recv_fds(ctl, fds, nfds)) return 0;
+
+    // 게임 판: 스냅샷 복구와 같은 경로로 적용한 뒤 인계 시점 값으로 덮어씀
+    board_set_variant(st.variant);
+    board_set_rule(st.rule);
+    init_board();
+    for (int k = 0; k < st.rec_n; k++) persist_apply(&recs[k]);
+    game_mode = st.game_mode;
+    in_game = st.in_game;
+    game_over = st.game_over;
+    current_turn = st.current_turn;
+    last_winner = st.last_winner;
+    ai_level = st.ai_level;
+
+    int nf = 0;
+    server_fd = fds[nf++];
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        bank_ms[i] = st.bank_ms[i];
+        joined[i] = st.joined[i];
+        memcpy(seat_token[i], st.token[i], sizeof(seat_token[i]));
+        seat_token[i][sizeof(seat_token[i]) - 1] = '\0';
+        if (st.has_fd[i]) {
+            client_fd[i] = fds[nf++];
+            player_count++;
+            touch_player(i);
+            io_watch(client_fd[i]);
+        } else if (st.seat_held[i]) {
+            // 남은 유예 시간은 넘기지 않고 새로 채움
+            seat_held[i] = 1;
+            player_count++;
+            timer_add(&timers, &seat_timer[i], (uint64_t)grace_sec * 1000,
+                      seat_grace_expired, (void *)(intptr_t)i);
+        }
+    }
+    for (int s = 0; s < st.spec_n; s++) {
+        int fd = fds[nf++];
+        int k = add_spectator(fd);
+        if (k < 0) {
+            close(fd);
+            continue;
+        }
+        io_watch(fd);
+        if (st.spec_attached[s]) {
+            spec[k]->attached = 1;
+            timer_cancel(&timers, &spec[k]->idle_timer);
+        }
+    }
+    if (st.clock_player) clock_start(st.clock_player);
+
+    unsigned char ack = 'R';
+    if (write(ctl, &ack, 1) != 1) return 0;
+    close(ctl);
+    write_pid_file();
+    log_write("Took over from previous server: %d players, %d spectators, %d moves",
+              player_count, spec_count, board_move_count());
+    return 1;
+}
+
+int main(int argc, char *argv[]) {
+    // 0. 옵션 처리
+    //    -g <초>: 연결이 끊긴 플레이어의 자리 유지 시간
+    //    -t <초>: 플레이어별 제한 시간 (0이면 턴 시계 없음)
+    //    -i <초>: 유휴 연결 정리 시간 (0이면 정리 안 함)
+    //    -b <파일>: AI가 사용할 오프닝 북 (tools/build_book으로 생성)
+    //    -r <파일>: 끝난 게임을 기록할 파일 (북 빌드 입력)
+    //    -w <디렉토리>: 게임 로그와 스냅샷을 둘 곳 (재시작 시 진행 중이던 게임 복구)
+    //    -u: io_uring 입출력 백엔드 사용 (지원하지 않는 커널이면 select)
+    //    -O <ms>: 과부하로 보는 루프 지연 (0이면 과부하 판단과 입장 제어를 하지 않음)
+    //    -L <한도>: 연결별 명령 속도 제한 ("off" 또는 "move=30/60,stats=5/10" 형식, ratelimit.h)
+    //    -T <파일>: 이벤트 추적을 끌 때 저장할 Chrome trace JSON 파일 (기본 omok-trace.json)
+    //    -H <fd>: 핫 재시작 때 옛 프로세스가 붙이는 내부 옵션 (제어 소켓)
+    const char *record_path = NULL;
+    int handoff_fd = -1;
+    int opt;
+    saved_argv = argv;
+    while ((opt = getopt(argc, argv, "g:t:i:b:r:w:uL:O:T:H:")) != -1) {
+        if (opt == 'g') {
+            grace_sec = atoi(optarg);
+            if (grace_sec < 0) grace_sec = 0;
+        } else if (opt == 't') {
+            time_bank_sec = atoi(optarg);
+            if (time_bank_sec < 0) time_bank_sec = 0;
+        } else if (opt == 'i') {
+            idle_sec = atoi(optarg);
+            if (idle_sec < 0) idle_sec = 0;
+        } else if (opt == 'b') {
+            book_path = optarg;
+        } else if (opt == 'r') {
+            record_path = optarg;
+        } else if (opt == 'w') {
+            wal_dir = optarg;
+        } else if (opt == 'u') {
+            use_uring = 1;
+        } else if (opt == 'L') {
+            if (!rate_parse(optarg)) {
+                fprintf(stderr, "Invalid rate limits: %s\n", optarg);
+                exit(EXIT_FAILURE);
             }
+        } else if (opt == 'O') {
+            overload_lag_ms = atoi(optarg);
+            if (overload_lag_ms < 0) overload_lag_ms = 0;
+        } else if (opt == 'T') {
+            trace_path = optarg;
+        } else if (opt == 'H') {
+            handoff_fd = atoi(optarg);
+        } else {
+            fprintf(stderr, "Usage: %s [-g grace_sec] [-t time_bank_sec] [-i idle_sec] [-b book_file] [-r record_file] [-w wal_dir] [-u] [-L rate_limits] [-O overload_lag_ms] [-T trace_file]\n", argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // 1. 데몬화 실행 (인계로 띄워진 경우는 옛 데몬의 자식이라 이미 분리되어 있음)
+    if (handoff_fd < 0) daemonize();
+
+    // ★ rand 초기화 (필요 시 AI에 난수 요소를 넣기 위해 사용 가능)
+    if (!rand_initialized) {
+        srand((unsigned int)time(NULL));
+        rand_initialized = 1;
+    }
+
+    // 2. 로그 시스템 시작
+    if (!log_open(LOG_FILE)) {
+        exit(EXIT_FAILURE); // 로그 파일을 열지 못하면 서버 종료
+    }
+    log_write("Server Daemon Started. PID: %d", getpid());
+
+    // 오프닝 북과 게임 기록 파일 (실패해도 서버는 계속 동작)
+    if (book_path) {
+        if (book_open(book_path)) log_write("Opening book loaded: %s (%d positions)", book_path, book_size());
+        else log_write("Failed to load opening book: %s", book_path);
+    }
+    if (record_path) {
+        record_fp = fopen(record_path, "a");
+        if (!record_fp) log_write("Failed to open record file: %s", record_path);
+    }
+    if (wal_dir && !wal_open(wal_dir)) {
+        log_write("Failed to open game log in %s", wal_dir);
+        wal_dir = NULL;
+    }
+
+    // 3. 종료 관련 시그널 등록 (SIGTERM, SIGINT)과 핫 재시작 시그널 (SIGUSR2), 이벤트 추적 시그널 (SIGUSR1)
+    signal(SIGTERM, handle_signal);
+    signal(SIGINT, handle_signal);
+    signal(SIGUSR2, handle_signal);
+    signal(SIGUSR1, handle_signal);
+
+    // 듣기 소켓 (인계로 띄워진 경우는 옛 프로세스의 소켓을 그대로 받음)
+    if (handoff_fd < 0) {
+        struct sockaddr_un addr;
+
+        // 서버용 유닉스 도메인 소켓 생성
+        server_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (server_fd == -1) {
+            log_write("Socket creation failed");
+            return 1;
+        }
+
+        // 기존에 남아 있을 수 있는 소켓 파일 제거
+        unlink(SOCK_PATH);
 
-           // CMD_EXIT: 한 플레이어가 종료를 요청한 경우 처리
-            if (cmd == CMD_EXIT) {
-		    log_write("Player %d exited", player_id);
-
-   		    // 상대 플레이어 인덱스 계산 (0 ↔ 1)
-   		    int other = (i == 0) ? 1 : 0;
-
-		    // 상대에게 "상대가 나갔습니다" 알림
-		    if (client_fd[other] != -1) {
-        		write(client_fd[other], "OPPONENT_EXIT\n", 14);
-    			}
-
-		    // 나간 쪽 정리
-		    close(client_fd[i]);
-		    client_fd[i] = -1;
- 		    joined[i] = 0;
-		    player_count--;
-
-		    // 게임 상태 초기화 (새 게임을 위해 보드/턴/종료 상태 재설정)
-		    init_board();
-		    current_turn = 1;
-		    game_over = 0;
-
-                 /* 이전 버전: 단순히 GAME_OVER 방송만 하고 종료시켰던 코드
-                 close(client_fd[i]);
-                 client_fd[i] = -1;
-                 joined[i] = 0;
-                 player_count--;
-                 broadcast(client_fd, "GAME_OVER\n"); // 상대방에게 종료 알림
-                 game_over = 1;*/
-                 continue;
+        // 소켓 주소 구조체 초기화 및 경로 설정
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strcpy(addr.sun_path, SOCK_PATH);
+
+        // 소켓 bind
+        if (bind(server_fd, (struct sockaddr *)&addr, sizeof(addr)) == -1) {
+            log_write("Bind failed");
+            close(server_fd);
+            return 1;
+        }
+
+        // 클라이언트 접속 대기 (listen)
+        if (listen(server_fd, 5) == -1) {
+            log_write("Listen failed");
+            close(server_fd);
+            return 1;
+        }
+
+        log_write("Server listening on %s", SOCK_PATH);
+    }
+
+    // 연결/게임 기록 풀과 첫 게임 기록 (게임 보드 초기화)
+    pool_init(&conn_pool, "conn", sizeof(spec_conn_t), CONN_PER_SLAB, MAX_SPECTATORS, NULL);
+    pool_init(&game_pool, "game", sizeof(game_t), GAME_PER_SLAB, 0, game_ctor);
+    cur_game = game_acquire();
+    timer_wheel_init(&timers);
+    timer_add(&timers, &ai_quota_timer, AI_QUOTA_WINDOW_SEC * 1000, ai_quota_window_expired, NULL);
+    evalcache_init();
+    if (overload_lag_ms > 0) {
+        sample_start_us = mono_us();
+        timer_add(&timers, &overload_timer, OVERLOAD_SAMPLE_MS, overload_sample, NULL);
+    }
+    if (use_uring) {
+        if (uring_init()) log_write("I/O backend: io_uring");
+        else {
+            log_write("io_uring unavailable. Falling back to select.");
+            use_uring = 0;
+        }
+    }
+    if (handoff_fd >= 0) {
+        if (!hot_restart_receive(handoff_fd)) {
+            log_write("Hot restart handoff failed. Exiting.");
+            exit(EXIT_FAILURE);
+        }
+        if (wal_dir) wal_recover(NULL);   // 게임은 인계로 받았으므로 로그 순번만 이어 받음
+    } else if (wal_dir) {
+        persist_recover();
+    }
+    if (use_uring) uring_listen(server_fd);
+
+    // 메인 루프 (running 플래그로 제어)
+    while (running) {
+        // 핫 재시작 요청: 인계에 성공하면 연결을 건드리지 않고 빠져나감
+        if (upgrade_requested) {
+            upgrade_requested = 0;
+            if (hot_restart()) {
+                handed_off = 1;
+                break;
             }
         }
+
+        // 이벤트 추적 켜기/끄기 (SIGUSR1)
+        if (trace_toggle_requested) {
+            trace_toggle_requested = 0;
+            trace_switch(!trace_enabled);
+        }
+
+        // 이번 바퀴의 처리 시간 측정 시작 (입출력 대기와 AI 수 계산 시간은 뒤에서 뺌)
+        uint64_t loop_start = mono_us();
+        uint64_t wait_mark = io_wait_us;
+        uint64_t ai_mark = ai_live_us;
+
+        // 만료된 타이머(재접속 유예, 턴 시계, 유휴 연결) 처리
+        // fd 집합을 만들기 전에 처리해야 콜백이 닫은 fd를 이번 select에서 보지 않음
+        TRACE_BEGIN("timers", -1);
+        timer_wheel_advance(&timers);
+        TRACE_END("timers");
+
+        // 지난 바퀴와 방금 처리한 타이머가 남긴 레코드를 한 번의 fdatasync로 커밋
+        TRACE_BEGIN("wal_flush", -1);
+        persist_flush();
+        TRACE_END("wal_flush");
+
+        // 타임아웃 설정 (최대 1초마다 깨어나 시그널 처리 여부 확인, 타이머가 있으면 더 빨리)
+        // 미리 계산할 일이 있으면 기다리지 않고 확인만 한 뒤, 할 일이 없을 때 한 수 계산
+        // 국면 분석은 미리 계산할 일이 없을 때만
+        int pondering = ponder_pending();
+        int analyzing = !pondering && analyze_pending();
+        uint64_t wait_ms = (pondering || analyzing) ? 0 : timer_next_timeout(&timers, 1000);
+        if (shm_arm()) wait_ms = 0;   // 공유 메모리 링에 이미 명령이 있으면 기다리지 않음
+
+        // 입출력 대기와 처리 (백엔드만 다르고 접속/명령 처리는 같은 함수)
+        int activity = use_uring ? uring_poll(wait_ms) : select_poll(wait_ms);
+        int shm_lines = shm_dispatch();
+        overload_note(mono_us() - loop_start - (io_wait_us - wait_mark) - (ai_live_us - ai_mark));
+
+        if (activity < 0 && running) {
+            log_write(use_uring ? "io_uring wait error" : "Select error");
+            continue;
+        }
+        if (activity == 0 && shm_lines == 0) {
+            if (pondering) ponder_step();
+            else if (analyzing) analyze_step();
+        }
     }
 
     // 서버 종료 처리
+    // 인계한 경우: 소켓 파일, PID 파일, 게임 로그는 새 프로세스의 것이므로 그대로 두고
+    //              연결은 이 프로세스의 fd 사본만 닫음
+    if (handed_off) {
+        log_write("Server exiting after handoff.");
+        wal_close();
+        for (int k = 0; k < MAX_SPECTATORS; k++) {
+            if (spec[k]) close(spec[k]->fd);
+        }
+        for (int i = 0; i < MAX_CLIENTS; i++) {
+            if (client_fd[i] != -1) close(client_fd[i]);
+        }
+        close(server_fd);
+        if (use_uring) uring_close();
+        book_close();
+        if (record_fp) fclose(record_fp);
+        log_close();
+        return 0;
+    }
+
     log_write("Server shutting down...");
+    if (trace_enabled) trace_switch(0);
+    if (wal_dir) persist_snapshot();
+    wal_close();
+    for (int k = 0; k < MAX_SPECTATORS; k++) remove_spectator(k);
+    pool_destroy(&conn_pool);
+    if (use_uring) uring_close();
     close(server_fd);
     unlink(SOCK_PATH);   // 소켓 파일 삭제
     unlink(PID_FILE);    // PID 파일 삭제
+    book_close();
+    if (record_fp) fclose(record_fp);
     log_close();         // 로그 파일 정리
     
     return 0;
@@ -0,0 +1,205 @@
+// 경로: src/shmring.c
+// 역할: 공유 메모리 전송(단일 생산자/단일 소비자 링 + eventfd 깨우기) 구현.
+//       깨우기 순서 (잃어버린 깨우기가 없도록 양쪽 모두 쓰기 → 전체 배리어 → 읽기):
+//         생산자: 데이터 쓰기 → tail 공개 → 배리어 → waiting이면 eventfd
+//         소비자: waiting = 1 → 배리어 → 링이 비었을 때만 잠듦
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include "shmring.h"
+
+#define SHM_MAGIC   0x4f4d4b53   // "OMKS"
+#define SHM_VERSION 1
+#define RING_MASK   (SHM_RING_SIZE - 1)
+
+int shm_chan_create(shm_chan_t *c, int fds[SHM_FDS]) {
+    memset(c, 0, sizeof(*c));
+    c->tx_efd = c->rx_efd = -1;
+    int mfd = memfd_create("omok-shm", MFD_CLOEXEC);
+    if (mfd == -1) return 0;
+    if (ftruncate(mfd, sizeof(shm_area_t)) == -1) {
+        close(mfd);
+        return 0;
+    }
+    c->area = mmap(NULL, sizeof(shm_area_t), PROT_READ | PROT_WRITE, MAP_SHARED, mfd, 0);
+    if (c->area == MAP_FAILED) {
+        c->area = NULL;
+        close(mfd);
+        return 0;
+    }
+    c->rx_efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);   // up: 서버가 기다림
+    c->tx_efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);   // down: 클라이언트가 기다림
+    if (c->rx_efd == -1 || c->tx_efd == -1) {
+        close(mfd);
+        shm_chan_close(c);
+        return 0;
+    }
+    c->area->magic = SHM_MAGIC;
+    c->area->version = SHM_VERSION;
+    c->tx = &c->area->down;
+    c->rx = &c->area->up;
+    fds[0] = mfd;
+    fds[1] = c->rx_efd;
+    fds[2] = c->tx_efd;
+    return 1;
+}
+
+int shm_chan_attach(shm_chan_t *c, int fds[SHM_FDS]) {
+    memset(c, 0, sizeof(*c));
+    c->area = mmap(NULL, sizeof(shm_area_t), PROT_READ | PROT_WRITE, MAP_SHARED, fds[0], 0);
+    close(fds[0]);
+    c->tx_efd = fds[1];
+    c->rx_efd = fds[2];
+    if (c->area == MAP_FAILED || c->area->magic != SHM_MAGIC || c->area->version != SHM_VERSION) {
+        if (c->area == MAP_FAILED) c->area = NULL;
+        shm_chan_close(c);
+        return 0;
+    }
+    c->tx = &c->area->up;
+    c->rx = &c->area->down;
+    return 1;
+}
+
+void shm_chan_close(shm_chan_t *c) {
+    if (c->area) munmap(c->area, sizeof(shm_area_t));
+    if (c->tx_efd != -1) close(c->tx_efd);
+    if (c->rx_efd != -1) close(c->rx_efd);
+    c->area = NULL;
+    c->tx = c->rx = NULL;
+    c->tx_efd = c->rx_efd = -1;
+}
+
+int shm_send_fds(int sock, const char *line, const int *fds, int n) {
+    char cbuf[CMSG_SPACE(sizeof(int) * SHM_FDS)];
+    if (n > SHM_FDS) return 0;
+    struct iovec iov = { (void *)line, strlen(line) };
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    memset(cbuf, 0, sizeof(cbuf));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cbuf;
+    msg.msg_controllen = CMSG_SPACE(sizeof(int) * n);
+    struct cmsghdr *cm = CMSG_FIRSTHDR(&msg);
+    cm->cmsg_level = SOL_SOCKET;
+    cm->cmsg_type = SCM_RIGHTS;
+    cm->cmsg_len = CMSG_LEN(sizeof(int) * n);
+    memcpy(CMSG_DATA(cm), fds, sizeof(int) * n);
+
+    ssize_t r;
+    do {
+        r = sendmsg(sock, &msg, MSG_NOSIGNAL);
+    } while (r < 0 && errno == EINTR);
+    return r == (ssize_t)iov.iov_len;
+}
+
+int shm_recv_fds(int sock, char *line, size_t size, int *fds, int n) {
+    size_t got = 0;
+    int have_fds = 0;
+    while (got + 1 < size) {
+        char cbuf[CMSG_SPACE(sizeof(int) * SHM_FDS)];
+        struct iovec iov = { line + got, 1 };     // 줄 끝을 넘어 다음 메시지를 먹지 않도록 한 바이트씩
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = cbuf;
+        msg.msg_controllen = sizeof(cbuf);
+        ssize_t r = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) break;
+        for (struct cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm)) {
+            if (cm->cmsg_level != SOL_SOCKET || cm->cmsg_type != SCM_RIGHTS) continue;
+            int cnt = (int)((cm->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+            int *in = (int *)CMSG_DATA(cm);
+            for (int k = 0; k < cnt; k++) {
+                if (!have_fds && k < n) fds[k] = in[k];
+                else close(in[k]);
+            }
+            if (!have_fds && cnt >= n) have_fds = 1;
+        }
+        if (line[got++] == '\n') break;
+    }
+    line[got] = '\0';
+    return have_fds;
+}
+
+static uint32_t ring_used(const shm_ring_t *r) {
+    return __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE) - __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+}
+
+int shm_write(shm_chan_t *c, const char *data, size_t len) {
+    shm_ring_t *r = c->tx;
+    uint32_t tail = r->tail;
+    uint32_t head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+    if (len > SHM_RING_SIZE - (tail - head)) return 0;
+
+    uint32_t pos = tail & RING_MASK;
+    size_t first = SHM_RING_SIZE - pos;
+    if (first > len) first = len;
+    memcpy(r->data + pos, data, first);
+    memcpy(r->data, data + first, len - first);
+    __atomic_store_n(&r->tail, tail + (uint32_t)len, __ATOMIC_RELEASE);
+
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&r->waiting, __ATOMIC_RELAXED)) {
+        uint64_t one = 1;
+        if (write(c->tx_efd, &one, sizeof(one)) == sizeof(one)) c->wakeups++;
+    }
+    return 1;
+}
+
+int shm_read_line(shm_chan_t *c, char *buf, size_t size) {
+    shm_ring_t *r = c->rx;
+    uint32_t head = r->head;
+    uint32_t avail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE) - head;
+    // tail은 상대가 쓰는 값이므로 믿지 않음 (링보다 많이 쌓였다는 것은 깨진 채널)
+    if (avail > SHM_RING_SIZE) return -1;
+
+    // 개행은 꺼낼 수 있는 길이까지만 찾음 (더 긴 줄은 조각으로 나눠 꺼냄)
+    uint32_t limit = avail < size - 1 ? avail : (uint32_t)(size - 1);
+    uint32_t n = 0;
+    while (n < limit && r->data[(head + n) & RING_MASK] != '\n') n++;
+    if (n < limit) n++;          // 개행 포함
+    else if (n < size - 1) return 0;   // 아직 줄이 다 오지 않음
+
+    for (uint32_t k = 0; k < n; k++) buf[k] = r->data[(head + k) & RING_MASK];
+    buf[n] = '\0';
+    __atomic_store_n(&r->head, head + n, __ATOMIC_RELEASE);
+    return (int)n;
+}
+
+int shm_pending(const shm_chan_t *c) {
+    return ring_used(c->rx) > 0;
+}
+
+int shm_wait_prepare(shm_chan_t *c) {
+    __atomic_store_n(&c->rx->waiting, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    return !shm_pending(c);
+}
+
+void shm_wait_done(shm_chan_t *c) {
+    __atomic_store_n(&c->rx->waiting, 0, __ATOMIC_RELAXED);
+}
+
+void shm_clear_signal(shm_chan_t *c) {
+    uint64_t v;
+    while (read(c->rx_efd, &v, sizeof(v)) < 0 && errno == EINTR) {}
+}
+
+int shm_wait(shm_chan_t *c, int timeout_ms) {
+    if (shm_wait_prepare(c)) {
+        struct pollfd p = { c->rx_efd, POLLIN, 0 };
+        if (poll(&p, 1, timeout_ms) > 0) shm_clear_signal(c);
+    }
+    shm_wait_done(c);
+    return shm_pending(c);
+}
@@ -0,0 +1,50 @@
+// 경로: src/sync.c
+// 역할: 보드 스냅샷 코덱 구현 (칸당 2비트 + 런 길이 인코딩, base64 문자 사용).
+
+#include <string.h>
+#include "sync.h"
+
+static const char b64[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// base64 문자 → 6비트 값 (해당 없으면 -1)
+static int b64_value(char c) {
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '+') return 62;
+    if (c == '/') return 63;
+    return -1;
+}
+
+int sync_encode(const int *cells, int n, char *out, int size) {
+    int len = 0;
+    int i = 0;
+    while (i < n) {
+        int v = cells[i] & 3;
+        int run = 1;
+        while (i + run < n && run < 16 && (cells[i + run] & 3) == v) run++;
+
+        if (len + 1 >= size) return -1;
+        out[len++] = b64[(v << 4) | (run - 1)];
+        i += run;
+    }
+    if (len >= size) return -1;
+    out[len] = '\0';
+    return len;
+}
+
+int sync_decode(const char *in, int *cells, int n) {
+    int pos = 0;
+    for (const char *p = in; *p && *p != ' ' && *p != '\n' && *p != '\r'; p++) {
+        int sym = b64_value(*p);
+        if (sym < 0) return 0;
+
+        int v = sym >> 4;
+        int run = (sym & 15) + 1;
+        if (v > 2 || pos + run > n) return 0;
+
+        for (int k = 0; k < run; k++) cells[pos++] = v;
+    }
+    return pos == n;
+}
@@ -0,0 +1,198 @@
+// 경로: src/threat.c
+// 역할: 판 전체 위협 스캔 커널.
+//       방향마다 두 단계로 처리함
+//       1) 5칸 윈도우 시작점마다 자기 돌/빈칸 수를 세어
+//          "돌 4 + 빈칸 1"(빈칸에 두면 5목), "돌 3 + 빈칸 2"(빈칸에 두면 4) 윈도우를 표시
+//       2) 빈칸마다 자신을 포함하는 윈도우 5개의 표시를 OR
+//       격자 한 행(32바이트)을 통째로 더하고 비교하므로 SIMD 커널은 행 하나를
+//       AVX2 명령 몇 개(SSE2는 그 두 배)로 처리함. 스칼라 커널은 같은 계산을 칸 단위로 수행.
+
+#include <string.h>
+#include "threat.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define THREAT_X86 1
+#endif
+
+// 방향별 한 칸 이동량 (dx, dy), board_line_index와 같은 순서
+static const int steps[4][2] = { {1, 0}, {0, 1}, {1, 1}, {1, -1} };
+
+// 1단계에서 계산할 윈도우 시작 행 범위 (판 위/아래로 WIN_LEN-1칸까지)
+#define ROW_BEGIN  (THREAT_TOP - (WIN_LEN - 1))
+#define ROW_END(n) (THREAT_TOP + (n) + (WIN_LEN - 1))
+
+void threat_scan_scalar(const threat_grid_t *g, int n, threat_map_t *out) {
+    static const threat_map_t empty;
+    unsigned char w5[THREAT_ROWS][THREAT_COLS];
+    unsigned char w4[THREAT_ROWS][THREAT_COLS];
+
+    *out = empty;
+    for (int d = 0; d < 4; d++) {
+        int dx = steps[d][0], dy = steps[d][1];
+
+        for (int r = ROW_BEGIN; r < ROW_END(n); r++) {
+            for (int c = 0; c < THREAT_LEFT + n; c++) {
+                int o = 0, e = 0;
+                for (int j = 0; j < WIN_LEN; j++) {
+                    o += g->own[r + j * dy][c + j * dx];
+                    e += g->avail[r + j * dy][c + j * dx];
+                }
+                w5[r][c] = (o == WIN_LEN - 1 && e == 1);
+                w4[r][c] = (o == WIN_LEN - 2 && e == 2);
+            }
+        }
+
+        for (int y = 0; y < n; y++) {
+            for (int x = 0; x < n; x++) {
+                int r = THREAT_TOP + y, c = THREAT_LEFT + x;
+                if (!g->avail[r][c]) continue;
+
+                int f = 0, t = 0;
+                for (int k = 0; k < WIN_LEN; k++) {
+                    f |= w5[r - k * dy][c - k * dx];
+                    t |= w4[r - k * dy][c - k * dx];
+                }
+                if (f)      out->five[y][x] |= 1 << d;
+                else if (t) out->four[y][x] |= 1 << d;
+            }
+        }
+    }
+}
+
+#ifdef THREAT_X86
+
+// SIMD 커널 공통: 누적한 격자 행에서 판 칸만 결과로 복사
+static void copy_out(unsigned char acc5[][THREAT_COLS], unsigned char acc4[][THREAT_COLS],
+                     int n, threat_map_t *out) {
+    for (int y = 0; y < n; y++) {
+        memcpy(out->five[y], &acc5[THREAT_TOP + y][THREAT_LEFT], n);
+        memcpy(out->four[y], &acc4[THREAT_TOP + y][THREAT_LEFT], n);
+        memset(out->five[y] + n, 0, BOARD_MAX - n);
+        memset(out->four[y] + n, 0, BOARD_MAX - n);
+    }
+    for (int y = n; y < BOARD_MAX; y++) {
+        memset(out->five[y], 0, BOARD_MAX);
+        memset(out->four[y], 0, BOARD_MAX);
+    }
+}
+
+// 행 단위 비정렬 로드는 다음 행 앞부분까지 읽을 수 있으므로 격자를 1차원 포인터로 다룸
+// (그렇게 읽힌 바이트는 판 밖 열의 결과에만 섞이고, 마지막에 빈칸 마스크로 지워짐)
+#define AT(base, r, c) ((base) + (r) * THREAT_COLS + (c))
+
+__attribute__((target("sse2")))
+void threat_scan_sse2(const threat_grid_t *g, int n, threat_map_t *out) {
+    unsigned char w5[THREAT_ROWS][THREAT_COLS] __attribute__((aligned(16))) = {{0}};
+    unsigned char w4[THREAT_ROWS][THREAT_COLS] __attribute__((aligned(16))) = {{0}};
+    unsigned char acc5[THREAT_ROWS][THREAT_COLS] __attribute__((aligned(16))) = {{0}};
+    unsigned char acc4[THREAT_ROWS][THREAT_COLS] __attribute__((aligned(16))) = {{0}};
+    const unsigned char *own = &g->own[0][0], *avail = &g->avail[0][0];
+    const __m128i four = _mm_set1_epi8(WIN_LEN - 1), three = _mm_set1_epi8(WIN_LEN - 2);
+    const __m128i one = _mm_set1_epi8(1), two = _mm_set1_epi8(2);
+
+    for (int d = 0; d < 4; d++) {
+        int dx = steps[d][0], dy = steps[d][1];
+        const __m128i bit = _mm_set1_epi8((char)(1 << d));
+
+        for (int r = ROW_BEGIN; r < ROW_END(n); r++) {
+            for (int h = 0; h < THREAT_COLS; h += 16) {
+                __m128i o = _mm_setzero_si128(), e = _mm_setzero_si128();
+                for (int j = 0; j < WIN_LEN; j++) {
+                    o = _mm_add_epi8(o, _mm_loadu_si128((const __m128i *)AT(own, r + j * dy, h + j * dx)));
+                    e = _mm_add_epi8(e, _mm_loadu_si128((const __m128i *)AT(avail, r + j * dy, h + j * dx)));
+                }
+                __m128i m5 = _mm_and_si128(_mm_cmpeq_epi8(o, four), _mm_cmpeq_epi8(e, one));
+                __m128i m4 = _mm_and_si128(_mm_cmpeq_epi8(o, three), _mm_cmpeq_epi8(e, two));
+                _mm_store_si128((__m128i *)&w5[r][h], m5);
+                _mm_store_si128((__m128i *)&w4[r][h], m4);
+            }
+        }
+
+        for (int r = THREAT_TOP; r < THREAT_TOP + n; r++) {
+            for (int h = 0; h < THREAT_COLS; h += 16) {
+                __m128i f = _mm_setzero_si128(), t = _mm_setzero_si128();
+                for (int k = 0; k < WIN_LEN; k++) {
+                    f = _mm_or_si128(f, _mm_loadu_si128((const __m128i *)AT(&w5[0][0], r - k * dy, h - k * dx)));
+                    t = _mm_or_si128(t, _mm_loadu_si128((const __m128i *)AT(&w4[0][0], r - k * dy, h - k * dx)));
+                }
+                __m128i av = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)AT(avail, r, h)), one);
+                f = _mm_and_si128(f, av);
+                t = _mm_and_si128(_mm_andnot_si128(f, t), av);
+
+                __m128i *a5 = (__m128i *)&acc5[r][h], *a4 = (__m128i *)&acc4[r][h];
+                _mm_store_si128(a5, _mm_or_si128(_mm_load_si128(a5), _mm_and_si128(f, bit)));
+                _mm_store_si128(a4, _mm_or_si128(_mm_load_si128(a4), _mm_and_si128(t, bit)));
+            }
+        }
+    }
+    copy_out(acc5, acc4, n, out);
+}
+
+__attribute__((target("avx2")))
+void threat_scan_avx2(const threat_grid_t *g, int n, threat_map_t *out) {
+    unsigned char w5[THREAT_ROWS][THREAT_COLS] __attribute__((aligned(32))) = {{0}};
+    unsigned char w4[THREAT_ROWS][THREAT_COLS] __attribute__((aligned(32))) = {{0}};
+    unsigned char acc5[THREAT_ROWS][THREAT_COLS] __attribute__((aligned(32))) = {{0}};
+    unsigned char acc4[THREAT_ROWS][THREAT_COLS] __attribute__((aligned(32))) = {{0}};
+    const unsigned char *own = &g->own[0][0], *avail = &g->avail[0][0];
+    const __m256i four = _mm256_set1_epi8(WIN_LEN - 1), three = _mm256_set1_epi8(WIN_LEN - 2);
+    const __m256i one = _mm256_set1_epi8(1), two = _mm256_set1_epi8(2);
+
+    for (int d = 0; d < 4; d++) {
+        int dx = steps[d][0], dy = steps[d][1];
+        const __m256i bit = _mm256_set1_epi8((char)(1 << d));
+
+        for (int r = ROW_BEGIN; r < ROW_END(n); r++) {
+            __m256i o = _mm256_setzero_si256(), e = _mm256_setzero_si256();
+            for (int j = 0; j < WIN_LEN; j++) {
+                o = _mm256_add_epi8(o, _mm256_loadu_si256((const __m256i *)AT(own, r + j * dy, j * dx)));
+                e = _mm256_add_epi8(e, _mm256_loadu_si256((const __m256i *)AT(avail, r + j * dy, j * dx)));
+            }
+            __m256i m5 = _mm256_and_si256(_mm256_cmpeq_epi8(o, four), _mm256_cmpeq_epi8(e, one));
+            __m256i m4 = _mm256_and_si256(_mm256_cmpeq_epi8(o, three), _mm256_cmpeq_epi8(e, two));
+            _mm256_store_si256((__m256i *)w5[r], m5);
+            _mm256_store_si256((__m256i *)w4[r], m4);
+        }
+
+        for (int r = THREAT_TOP; r < THREAT_TOP + n; r++) {
+            __m256i f = _mm256_setzero_si256(), t = _mm256_setzero_si256();
+            for (int k = 0; k < WIN_LEN; k++) {
+                f = _mm256_or_si256(f, _mm256_loadu_si256((const __m256i *)AT(&w5[0][0], r - k * dy, -k * dx)));
+                t = _mm256_or_si256(t, _mm256_loadu_si256((const __m256i *)AT(&w4[0][0], r - k * dy, -k * dx)));
+            }
+            __m256i av = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)AT(avail, r, 0)), one);
+            f = _mm256_and_si256(f, av);
+            t = _mm256_and_si256(_mm256_andnot_si256(f, t), av);
+
+            __m256i *a5 = (__m256i *)acc5[r], *a4 = (__m256i *)acc4[r];
+            _mm256_store_si256(a5, _mm256_or_si256(_mm256_load_si256(a5), _mm256_and_si256(f, bit)));
+            _mm256_store_si256(a4, _mm256_or_si256(_mm256_load_si256(a4), _mm256_and_si256(t, bit)));
+        }
+    }
+    copy_out(acc5, acc4, n, out);
+}
+
+int threat_cpu_supports(int impl) {
+    __builtin_cpu_init();
+    if (impl == THREAT_IMPL_AVX2) return __builtin_cpu_supports("avx2");
+    if (impl == THREAT_IMPL_SSE2) return __builtin_cpu_supports("sse2");
+    return impl == THREAT_IMPL_SCALAR;
+}
+
+#else
+
+// x86이 아니면 스칼라 커널만 사용
+void threat_scan_sse2(const threat_grid_t *g, int n, threat_map_t *out) {
+    threat_scan_scalar(g, n, out);
+}
+
+void threat_scan_avx2(const threat_grid_t *g, int n, threat_map_t *out) {
+    threat_scan_scalar(g, n, out);
+}
+
+int threat_cpu_supports(int impl) {
+    return impl == THREAT_IMPL_SCALAR;
+}
+
+#endif
@@ -0,0 +1,133 @@
+// 경로: src/timer.c
+// 역할: 계층형 타이머 휠 구현.
+//       - 만료까지 남은 tick 수에 따라 단계(level)를 고르고, 만료 tick의 해당 자릿수 칸에 등록
+//       - 등록/취소는 O(1), tick 처리 시에는 0단계의 현재 칸만 확인
+//       - 0단계 칸에 있는 타이머는 모두 이번 tick에 만료되므로 빈 순회가 없음
+
+#include <time.h>
+#include <stddef.h>
+#include "timer.h"
+
+#define LEVEL_MASK (TIMER_LEVEL_SIZE - 1)
+
+uint64_t timer_now_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+void timer_wheel_init(timer_wheel_t *w) {
+    for (int l = 0; l < TIMER_LEVELS; l++)
+        for (int i = 0; i < TIMER_LEVEL_SIZE; i++)
+            w->slots[l][i] = NULL;
+    w->now = 0;
+    w->base_ms = timer_now_ms();
+    w->count = 0;
+}
+
+// 만료 tick에 맞는 칸에 연결 (active/count는 호출자가 관리)
+static void wheel_link(timer_wheel_t *w, wtimer_t *t) {
+    uint64_t delta = t->expires - w->now;
+    int level = 0;
+    while (level < TIMER_LEVELS - 1 &&
+           delta >= ((uint64_t)1 << (TIMER_LEVEL_BITS * (level + 1)))) {
+        level++;
+    }
+    // 최상위 단계 범위를 넘는 타이머는 마지막 칸에 두고 cascade 때 다시 배치
+    uint64_t max_delta = ((uint64_t)1 << (TIMER_LEVEL_BITS * TIMER_LEVELS)) - 1;
+    uint64_t at = (delta > max_delta) ? w->now + max_delta : t->expires;
+    int idx = (int)((at >> (TIMER_LEVEL_BITS * level)) & LEVEL_MASK);
+
+    wtimer_t **head = &w->slots[level][idx];
+    t->head = head;
+    t->prev = NULL;
+    t->next = *head;
+    if (*head) (*head)->prev = t;
+    *head = t;
+}
+
+static void wheel_unlink(wtimer_t *t) {
+    if (t->prev) t->prev->next = t->next;
+    else *t->head = t->next;
+    if (t->next) t->next->prev = t->prev;
+    t->next = t->prev = NULL;
+    t->head = NULL;
+}
+
+void timer_add(timer_wheel_t *w, wtimer_t *t, uint64_t delay_ms, timer_cb cb, void *arg) {
+    timer_cancel(w, t);
+
+    // 최소 1 tick 뒤에 만료 (현재 tick은 이미 처리 중일 수 있으므로)
+    uint64_t ticks = (delay_ms + TIMER_TICK_MS - 1) / TIMER_TICK_MS;
+    if (ticks == 0) ticks = 1;
+
+    t->expires = w->now + ticks;
+    t->cb = cb;
+    t->arg = arg;
+    t->active = 1;
+    wheel_link(w, t);
+    w->count++;
+}
+
+void timer_cancel(timer_wheel_t *w, wtimer_t *t) {
+    if (!t->active) return;
+    wheel_unlink(t);
+    t->active = 0;
+    w->count--;
+}
+
+// level 단계의 현재 칸을 통째로 떼어 하위 단계에 다시 배치
+static void cascade(timer_wheel_t *w, int level) {
+    int idx = (int)((w->now >> (TIMER_LEVEL_BITS * level)) & LEVEL_MASK);
+    wtimer_t *t = w->slots[level][idx];
+    w->slots[level][idx] = NULL;
+
+    while (t) {
+        wtimer_t *next = t->next;
+        wheel_link(w, t);
+        t = next;
+    }
+}
+
+void timer_wheel_advance(timer_wheel_t *w) {
+    uint64_t target = (timer_now_ms() - w->base_ms) / TIMER_TICK_MS;
+
+    while (w->now < target) {
+        w->now++;
+
+        // 하위 단계가 한 바퀴 돌았으면 상위 단계의 칸을 내려보냄 (상위부터)
+        int top = 0;
+        while (top < TIMER_LEVELS - 1 &&
+               ((w->now >> (TIMER_LEVEL_BITS * (top + 1))) << (TIMER_LEVEL_BITS * (top + 1))) == w->now) {
+            top++;
+        }
+        for (int l = top; l >= 1; l--) cascade(w, l);
+
+        if (w->count == 0) continue;
+
+        // 0단계 현재 칸은 모두 이번 tick 만료
+        // 콜백이 다른 타이머를 추가/취소할 수 있으므로 하나씩 꺼낸 뒤 호출
+        wtimer_t **slot = &w->slots[0][w->now & LEVEL_MASK];
+        while (*slot) {
+            wtimer_t *t = *slot;
+            timer_cancel(w, t);
+            t->cb(t->arg);
+        }
+    }
+}
+
+uint64_t timer_next_timeout(timer_wheel_t *w, uint64_t max_ms) {
+    if (w->count == 0) return max_ms;
+
+    // 0단계에서 다음으로 비어 있지 않은 칸을 찾음 (최대 64칸)
+    // 다음 cascade 경계까지 없으면 그 경계에서 한 번 깨어나 상위 단계를 내려보냄
+    uint64_t next_tick = w->now + 1;
+    while (w->slots[0][next_tick & LEVEL_MASK] == NULL && (next_tick & LEVEL_MASK) != 0) {
+        next_tick++;
+    }
+
+    uint64_t elapsed = timer_now_ms() - w->base_ms;
+    uint64_t next_ms = next_tick * TIMER_TICK_MS;
+    uint64_t wait = (next_ms > elapsed) ? next_ms - elapsed : 0;
+    return wait < max_ms ? wait : max_ms;
+}
@@ -0,0 +1,141 @@
+// 경로: src/trace.c
+// 역할: 스레드별 원형 버퍼 이벤트 추적 구현.
+//       - 버퍼는 스레드가 처음 이벤트를 남길 때 만들어 전역 목록에 CAS로 붙임 (해제하지 않음)
+//       - 쓰는 쪽은 칸을 채운 뒤 head를 release로 올리고, 내보내는 쪽은 acquire로 읽음
+//         (보통 trace_stop 뒤에 내보내므로 덮어쓰는 중인 칸을 읽는 일은 없음)
+//       - x86-64에서는 TSC 값을 그대로 저장하고, 내보낼 때 시작/끝 시점의 TSC와 단조 시계로
+//         ns로 환산 (이벤트마다 clock_gettime을 부르지 않음)
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+#include "trace.h"
+
+#define TRACE_MASK (TRACE_RING_EVENTS - 1)
+
+typedef struct trace_event {
+    uint64_t    t;        // TSC 또는 ns
+    const char *name;
+    int32_t     arg;
+    char        phase;    // 'B' / 'E'
+} trace_event_t;
+
+typedef struct trace_ring {
+    struct trace_ring *next;
+    uint64_t head;        // 지금까지 쓴 이벤트 수 (칸은 head & TRACE_MASK)
+    uint64_t start;       // trace_start 때의 head (이전 기록은 내보내지 않음)
+    int      tid;
+    trace_event_t ev[TRACE_RING_EVENTS];
+} trace_ring_t;
+
+int trace_enabled = 0;
+
+static trace_ring_t *rings = NULL;
+static __thread trace_ring_t *my_ring = NULL;
+
+// 시간 기준점 (시작/중지 때의 원시 시각과 ns)
+static uint64_t raw_start, ns_start, raw_stop, ns_stop;
+
+static uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+static inline uint64_t now_raw() {
+#if defined(__x86_64__)
+    return __rdtsc();
+#else
+    return now_ns();
+#endif
+}
+
+static trace_ring_t *ring_create() {
+    trace_ring_t *r = calloc(1, sizeof(*r));
+    if (!r) return NULL;
+    r->tid = (int)syscall(SYS_gettid);
+    r->next = __atomic_load_n(&rings, __ATOMIC_ACQUIRE);
+    while (!__atomic_compare_exchange_n(&rings, &r->next, r, 0, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE)) {
+    }
+    return r;
+}
+
+void trace_emit(const char *name, char phase, int arg) {
+    trace_ring_t *r = my_ring;
+    if (!r) {
+        r = my_ring = ring_create();
+        if (!r) return;
+    }
+    uint64_t h = r->head;
+    trace_event_t *e = &r->ev[h & TRACE_MASK];
+    e->t = now_raw();
+    e->name = name;
+    e->arg = arg;
+    e->phase = phase;
+    __atomic_store_n(&r->head, h + 1, __ATOMIC_RELEASE);
+}
+
+void trace_start() {
+    if (trace_enabled) return;
+    for (trace_ring_t *r = __atomic_load_n(&rings, __ATOMIC_ACQUIRE); r; r = r->next) {
+        r->start = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+    }
+    raw_start = now_raw();
+    ns_start = now_ns();
+    raw_stop = 0;
+    __atomic_store_n(&trace_enabled, 1, __ATOMIC_RELEASE);
+}
+
+void trace_stop() {
+    if (!trace_enabled) return;
+    __atomic_store_n(&trace_enabled, 0, __ATOMIC_RELEASE);
+    raw_stop = now_raw();
+    ns_stop = now_ns();
+}
+
+// 원시 시각을 시작 시점 기준 ns로
+static uint64_t to_ns(uint64_t t, double scale) {
+    if (t <= raw_start) return 0;
+    return (uint64_t)((double)(t - raw_start) * scale);
+}
+
+long trace_dump(const char *path) {
+    uint64_t rs = raw_stop, ns = ns_stop;
+    if (trace_enabled || rs == 0) {
+        rs = now_raw();
+        ns = now_ns();
+    }
+    double scale = (rs > raw_start) ? (double)(ns - ns_start) / (double)(rs - raw_start) : 1.0;
+
+    FILE *fp = fopen(path, "w");
+    if (!fp) return -1;
+
+    int pid = (int)getpid();
+    long count = 0;
+    fprintf(fp, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    for (trace_ring_t *r = __atomic_load_n(&rings, __ATOMIC_ACQUIRE); r; r = r->next) {
+        uint64_t head = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+        uint64_t from = r->start;
+        if (head - from > TRACE_RING_EVENTS) from = head - TRACE_RING_EVENTS;
+        for (uint64_t i = from; i < head; i++) {
+            const trace_event_t *e = &r->ev[i & TRACE_MASK];
+            uint64_t t = to_ns(e->t, scale);
+            fprintf(fp, "%s{\"name\":\"%s\",\"ph\":\"%c\",\"pid\":%d,\"tid\":%d,\"ts\":%llu.%03llu",
+                    count > 0 ? ",\n" : "", e->name, e->phase, pid, r->tid,
+                    (unsigned long long)(t / 1000), (unsigned long long)(t % 1000));
+            if (e->arg >= 0) fprintf(fp, ",\"args\":{\"arg\":%d}", e->arg);
+            fputc('}', fp);
+            count++;
+        }
+    }
+    fprintf(fp, "\n]}\n");
+    if (fclose(fp) != 0) return -1;
+    return count;
+}
@@ -0,0 +1,439 @@
+// 경로: src/uring.c
+// 역할: io_uring 입출력 백엔드 구현.
+//       - 링: 제출 큐/완료 큐를 mmap으로 공유, 완료 큐 머리/꼬리는 acquire/release로 읽고 씀
+//       - user_data: [63..56] 요청 종류, [55..32] 연결 세대, [31..0] fd
+//       - recv는 멀티샷 + 제공 버퍼 링(그룹 0). 커널이 멀티샷을 끝내면(F_MORE 없음) 다시 검
+//       - 송신은 연결마다 sendmsg 하나만 진행 (순서 보장). 보내는 동안 msgbuf 참조를 잡아 둠
+//       - 취소된 요청의 완료(-ECANCELED)는 이벤트로 내보내지 않음
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#include "uring.h"
+
+#define OP_ACCEPT 1
+#define OP_RECV   2
+#define OP_SEND   3
+#define OP_POLL   4
+#define BUF_GROUP 0
+#define URING_MAX_FD FD_SETSIZE
+
+#define TAG(op, gen, fd) (((uint64_t)(op) << 56) | ((uint64_t)((gen) & 0xFFFFFF) << 32) | (uint32_t)(fd))
+#define TAG_OP(t)  ((int)((t) >> 56))
+#define TAG_GEN(t) ((uint32_t)(((t) >> 32) & 0xFFFFFF))
+#define TAG_FD(t)  ((int)(uint32_t)(t))
+
+// 연결별 상태 (처음 쓸 때 만듦)
+typedef struct uring_conn {
+    uint32_t      gen;                 // uring_forget마다 증가 (늦은 완료 구분)
+    int           recv_armed;          // 멀티샷 recv(또는 poll)가 걸려 있음
+    int           sending;
+    int           nrefs;               // 보내는 중인 버퍼 수
+    msgbuf_t     *refs[OUTQ_MAX];
+    struct iovec  iov[OUTQ_MAX];
+    struct msghdr msg;
+} uring_conn_t;
+
+static int ring_fd = -1;
+static void *ring_ptr = NULL;
+static size_t ring_sz = 0;
+static struct io_uring_sqe *sqes = NULL;
+static size_t sqes_sz = 0;
+
+static unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+static unsigned *cq_head, *cq_tail, *cq_mask;
+static struct io_uring_cqe *cqes;
+static unsigned sq_entries;
+static unsigned sq_local_tail = 0;     // 아직 커널에 알리지 않은 꼬리
+static unsigned to_submit = 0;
+
+static struct io_uring_buf_ring *buf_ring = NULL;
+static size_t buf_ring_sz = 0;
+static unsigned short buf_tail = 0;
+static char *bufs = NULL;
+
+static int listen_fd = -1;
+static int paused = 0;                 // uring_cancel_all 뒤 uring_resume 전까지 새 요청을 걸지 않음
+static uring_conn_t *conns[URING_MAX_FD];
+static uring_stats_t stats;
+
+static int sys_setup(unsigned entries, struct io_uring_params *p) {
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int sys_enter(unsigned submit, unsigned min_complete, unsigned flags, void *arg, size_t argsz) {
+    return (int)syscall(__NR_io_uring_enter, ring_fd, submit, min_complete, flags, arg, argsz);
+}
+
+static int sys_register(unsigned opcode, void *arg, unsigned nr) {
+    return (int)syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr);
+}
+
+static uring_conn_t *conn_of(int fd, int create) {
+    if (fd < 0 || fd >= URING_MAX_FD) return NULL;
+    if (!conns[fd] && create) conns[fd] = calloc(1, sizeof(uring_conn_t));
+    return conns[fd];
+}
+
+// 제출 대기 중인 요청을 커널에 넘김 (완료는 기다리지 않음)
+static int submit_pending(unsigned min_complete, unsigned flags, void *arg, size_t argsz) {
+    __atomic_store_n(sq_tail, sq_local_tail, __ATOMIC_RELEASE);
+    int ret;
+    do {
+        ret = sys_enter(to_submit, min_complete, flags, arg, argsz);
+    } while (ret < 0 && errno == EINTR && min_complete == 0);
+    stats.enters++;
+    if (ret > 0) {
+        stats.submitted += ret;
+        to_submit -= (unsigned)ret > to_submit ? to_submit : (unsigned)ret;
+    }
+    return ret;
+}
+
+// 빈 SQE 하나 (제출 큐가 가득 차면 먼저 제출)
+static struct io_uring_sqe *get_sqe() {
+    unsigned head = __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+    if (sq_local_tail - head >= sq_entries) {
+        submit_pending(0, 0, NULL, 0);
+        head = __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+        if (sq_local_tail - head >= sq_entries) return NULL;
+    }
+    unsigned idx = sq_local_tail & *sq_mask;
+    struct io_uring_sqe *sqe = &sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    sq_array[idx] = idx;
+    sq_local_tail++;
+    to_submit++;
+    return sqe;
+}
+
+static void buf_recycle(int bid) {
+    struct io_uring_buf *b = &buf_ring->bufs[buf_tail & (URING_BUFS - 1)];
+    b->addr = (uint64_t)(uintptr_t)(bufs + (size_t)bid * URING_BUF_SIZE);
+    b->len = URING_BUF_SIZE;
+    b->bid = (unsigned short)bid;
+    buf_tail++;
+    __atomic_store_n(&buf_ring->tail, buf_tail, __ATOMIC_RELEASE);
+}
+
+// 보내는 중인 버퍼 참조 해제
+static void release_send(uring_conn_t *c) {
+    for (int k = 0; k < c->nrefs; k++) msgbuf_unref(c->refs[k]);
+    c->nrefs = 0;
+    c->sending = 0;
+}
+
+int uring_init() {
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    p.flags = IORING_SETUP_CQSIZE;
+    p.cq_entries = URING_CQ_ENTRIES;
+    ring_fd = sys_setup(URING_ENTRIES, &p);
+    if (ring_fd < 0) return 0;
+    if (!(p.features & IORING_FEAT_SINGLE_MMAP) || !(p.features & IORING_FEAT_EXT_ARG)) goto fail;
+
+    size_t sq_sz = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    size_t cq_sz = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    ring_sz = sq_sz > cq_sz ? sq_sz : cq_sz;
+    ring_ptr = mmap(NULL, ring_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    ring_fd, IORING_OFF_SQ_RING);
+    if (ring_ptr == MAP_FAILED) {
+        ring_ptr = NULL;
+        goto fail;
+    }
+    sqes_sz = p.sq_entries * sizeof(struct io_uring_sqe);
+    sqes = mmap(NULL, sqes_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                ring_fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        sqes = NULL;
+        goto fail;
+    }
+
+    char *base = ring_ptr;
+    sq_head  = (unsigned *)(base + p.sq_off.head);
+    sq_tail  = (unsigned *)(base + p.sq_off.tail);
+    sq_mask  = (unsigned *)(base + p.sq_off.ring_mask);
+    sq_array = (unsigned *)(base + p.sq_off.array);
+    cq_head  = (unsigned *)(base + p.cq_off.head);
+    cq_tail  = (unsigned *)(base + p.cq_off.tail);
+    cq_mask  = (unsigned *)(base + p.cq_off.ring_mask);
+    cqes     = (struct io_uring_cqe *)(base + p.cq_off.cqes);
+    sq_entries = p.sq_entries;
+    sq_local_tail = *sq_tail;
+    to_submit = 0;
+
+    // 제공 버퍼 링 (링 메모리는 페이지 정렬이어야 함)
+    buf_ring_sz = URING_BUFS * sizeof(struct io_uring_buf);
+    buf_ring = mmap(NULL, buf_ring_sz, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buf_ring == MAP_FAILED) {
+        buf_ring = NULL;
+        goto fail;
+    }
+    bufs = malloc((size_t)URING_BUFS * URING_BUF_SIZE);
+    if (!bufs) goto fail;
+
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (uint64_t)(uintptr_t)buf_ring;
+    reg.ring_entries = URING_BUFS;
+    reg.bgid = BUF_GROUP;
+    if (sys_register(IORING_REGISTER_PBUF_RING, &reg, 1) < 0) goto fail;
+    buf_tail = 0;
+    for (int b = 0; b < URING_BUFS; b++) buf_recycle(b);
+
+    // 동기 취소가 없는 커널(6.0 미만)은 멀티샷 recv도 없으므로 select로 둠
+    struct io_uring_sync_cancel_reg probe;
+    memset(&probe, 0, sizeof(probe));
+    probe.fd = -1;
+    probe.flags = IORING_ASYNC_CANCEL_FD;
+    probe.timeout.tv_sec = -1;
+    probe.timeout.tv_nsec = -1;
+    if (sys_register(IORING_REGISTER_SYNC_CANCEL, &probe, 1) < 0 && errno == EINVAL) goto fail;
+
+    memset(&stats, 0, sizeof(stats));
+    return 1;
+
+fail:
+    uring_close();
+    return 0;
+}
+
+void uring_close() {
+    for (int fd = 0; fd < URING_MAX_FD; fd++) {
+        if (!conns[fd]) continue;
+        release_send(conns[fd]);
+        free(conns[fd]);
+        conns[fd] = NULL;
+    }
+    if (ring_fd >= 0) close(ring_fd);
+    if (sqes) munmap(sqes, sqes_sz);
+    if (ring_ptr) munmap(ring_ptr, ring_sz);
+    if (buf_ring) munmap(buf_ring, buf_ring_sz);
+    free(bufs);
+    ring_fd = -1;
+    sqes = NULL;
+    ring_ptr = NULL;
+    buf_ring = NULL;
+    bufs = NULL;
+    listen_fd = -1;
+    paused = 0;
+}
+
+int uring_listen(int fd) {
+    if (paused) return 0;
+    struct io_uring_sqe *sqe = get_sqe();
+    if (!sqe) return 0;
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = fd;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->user_data = TAG(OP_ACCEPT, 0, fd);
+    listen_fd = fd;
+    return 1;
+}
+
+int uring_watch(int fd) {
+    uring_conn_t *c = conn_of(fd, 1);
+    if (!c || paused) return 0;
+    if (c->recv_armed) return 1;
+    struct io_uring_sqe *sqe = get_sqe();
+    if (!sqe) return 0;
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUF_GROUP;
+    sqe->user_data = TAG(OP_RECV, c->gen, fd);
+    c->recv_armed = 1;
+    return 1;
+}
+
+int uring_watch_poll(int fd) {
+    uring_conn_t *c = conn_of(fd, 1);
+    if (!c || paused) return 0;
+    if (c->recv_armed) return 1;
+    struct io_uring_sqe *sqe = get_sqe();
+    if (!sqe) return 0;
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->len = IORING_POLL_ADD_MULTI;
+    sqe->poll32_events = POLLIN;
+    sqe->user_data = TAG(OP_POLL, c->gen, fd);
+    c->recv_armed = 1;
+    return 1;
+}
+
+int uring_send(int fd, const outq_t *q) {
+    uring_conn_t *c = conn_of(fd, 1);
+    if (!c || paused || c->sending || !outq_pending(q)) return 0;
+    struct io_uring_sqe *sqe = get_sqe();
+    if (!sqe) return 0;
+
+    int cnt = outq_iov(q, c->iov);
+    for (int k = 0; k < cnt; k++) c->refs[k] = msgbuf_ref(q->items[(q->head + k) % OUTQ_MAX]);
+    c->nrefs = cnt;
+    memset(&c->msg, 0, sizeof(c->msg));
+    c->msg.msg_iov = c->iov;
+    c->msg.msg_iovlen = cnt;
+
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t)(uintptr_t)&c->msg;
+    sqe->len = 1;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = TAG(OP_SEND, c->gen, fd);
+    c->sending = 1;
+    return 1;
+}
+
+int uring_sending(int fd) {
+    uring_conn_t *c = conn_of(fd, 0);
+    return c && c->sending;
+}
+
+static void sync_cancel(int fd, unsigned flags) {
+    if (to_submit > 0) submit_pending(0, 0, NULL, 0);
+    struct io_uring_sync_cancel_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.fd = fd;
+    reg.flags = flags | IORING_ASYNC_CANCEL_ALL;
+    reg.timeout.tv_sec = -1;
+    reg.timeout.tv_nsec = -1;
+    while (sys_register(IORING_REGISTER_SYNC_CANCEL, &reg, 1) < 0 && errno == EINTR) {}
+}
+
+void uring_forget(int fd) {
+    uring_conn_t *c = conn_of(fd, 0);
+    if (!c || ring_fd < 0) return;
+    if (c->recv_armed || c->sending) sync_cancel(fd, IORING_ASYNC_CANCEL_FD);
+    release_send(c);
+    c->recv_armed = 0;
+    c->gen++;
+}
+
+void uring_cancel_all() {
+    if (ring_fd < 0) return;
+    paused = 1;
+    sync_cancel(-1, IORING_ASYNC_CANCEL_ANY);
+    // 취소 완료가 완료 큐에 모두 올라오도록 한 번 더 들어갔다 나옴
+    submit_pending(0, IORING_ENTER_GETEVENTS, NULL, 0);
+}
+
+void uring_resume() {
+    paused = 0;
+}
+
+int uring_wait(uint64_t wait_ms) {
+    if (ring_fd < 0) return -1;
+    if (uring_ready()) {
+        if (to_submit > 0) submit_pending(0, 0, NULL, 0);
+        return (int)(__atomic_load_n(cq_tail, __ATOMIC_ACQUIRE) - *cq_head);
+    }
+
+    struct __kernel_timespec ts;
+    ts.tv_sec = (long long)(wait_ms / 1000);
+    ts.tv_nsec = (long long)(wait_ms % 1000) * 1000000;
+    struct io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(arg));
+    arg.ts = (uint64_t)(uintptr_t)&ts;
+
+    int ret = submit_pending(wait_ms > 0 ? 1 : 0, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG,
+                             &arg, sizeof(arg));
+    if (ret < 0 && errno != ETIME && errno != EINTR) return -1;
+    return (int)(__atomic_load_n(cq_tail, __ATOMIC_ACQUIRE) - *cq_head);
+}
+
+int uring_ready() {
+    return ring_fd >= 0 && __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE) != *cq_head;
+}
+
+int uring_next(uring_event_t *ev) {
+    while (uring_ready()) {
+        unsigned head = *cq_head;
+        struct io_uring_cqe cqe = cqes[head & *cq_mask];
+        __atomic_store_n(cq_head, head + 1, __ATOMIC_RELEASE);
+        stats.completions++;
+
+        uint64_t tag = cqe.user_data;
+        int fd = TAG_FD(tag);
+        int more = (cqe.flags & IORING_CQE_F_MORE) != 0;
+        int bid = (cqe.flags & IORING_CQE_F_BUFFER) ? (int)(cqe.flags >> IORING_CQE_BUFFER_SHIFT) : -1;
+
+        if (TAG_OP(tag) == OP_ACCEPT) {
+            if (!more && fd == listen_fd && cqe.res != -ECANCELED) uring_listen(fd);
+            if (cqe.res < 0) continue;
+            ev->type = URING_EV_ACCEPT;
+            ev->fd = cqe.res;
+            ev->res = 0;
+            ev->data = NULL;
+            ev->bid = -1;
+            return 1;
+        }
+
+        uring_conn_t *c = conn_of(fd, 0);
+        if (!c || TAG_GEN(tag) != (c->gen & 0xFFFFFF)) {
+            // 이미 잊은 연결의 늦은 완료: 버퍼만 돌려줌
+            if (bid >= 0) buf_recycle(bid);
+            continue;
+        }
+
+        if (TAG_OP(tag) == OP_RECV) {
+            if (!more) c->recv_armed = 0;
+            if (cqe.res == -ECANCELED) continue;
+            if (cqe.res == -ENOBUFS) {
+                // 제공 버퍼가 바닥나 멀티샷이 끝남: 처리 중인 버퍼가 돌아오면 다시 받음
+                uring_watch(fd);
+                continue;
+            }
+            if (cqe.res > 0 && !more) uring_watch(fd);
+            stats.recvs++;
+            ev->type = URING_EV_RECV;
+            ev->fd = fd;
+            ev->res = cqe.res;
+            ev->bid = bid;
+            ev->data = bid >= 0 ? bufs + (size_t)bid * URING_BUF_SIZE : NULL;
+            if (cqe.res > 0 && bid < 0) continue;
+            return 1;
+        }
+
+        if (TAG_OP(tag) == OP_POLL) {
+            if (!more) c->recv_armed = 0;
+            if (cqe.res < 0) continue;
+            if (!more) uring_watch_poll(fd);
+            ev->type = URING_EV_POLL;
+            ev->fd = fd;
+            ev->res = cqe.res;
+            ev->data = NULL;
+            ev->bid = -1;
+            return 1;
+        }
+
+        if (TAG_OP(tag) == OP_SEND) {
+            release_send(c);
+            stats.sends++;
+            ev->type = URING_EV_SENT;
+            ev->fd = fd;
+            ev->res = cqe.res == -ECANCELED ? 0 : cqe.res;
+            ev->data = NULL;
+            ev->bid = -1;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void uring_event_done(uring_event_t *ev) {
+    if (ev->bid >= 0) buf_recycle(ev->bid);
+    ev->bid = -1;
+}
+
+void uring_get_stats(uring_stats_t *out) {
+    *out = stats;
+}
@@ -0,0 +1,362 @@
+// 경로: src/vcf.c
+// 역할: 위협 공간 탐색(VCF/VCT) 구현.
+//       공격 노드: 5목 자리가 있으면 승리 → 상대 5목 자리가 둘 이상이면 실패 →
+//                  하나면 그 자리를 막는 위협수만 → 없으면 모든 위협수
+//       수비 노드: 4에는 5목 자리 한 곳으로 강제, 열린 3에는 막는 자리 + 자기 4를 모두 시도
+//       위협수 후보는 판 전체 위협 스캔(board_threat_scan)으로 뽑고 규칙이 적용된 패턴 표로 확정.
+
+#include <stddef.h>
+#include "vcf.h"
+#include "board.h"
+#include "pattern.h"
+#include "timer.h"
+
+#define MAX_CELLS     (BOARD_MAX * BOARD_MAX)
+#define VCT_VCF_DEPTH 10   // VCT 공격 노드마다 먼저 시도하는 VCF 깊이
+
+static const int dirs[4][2] = { {1, 0}, {0, 1}, {1, 1}, {1, -1} };
+
+#define DEADLINE_CHECK_MASK 63   // 노드 64개마다 한 번 시계(와 중단 함수) 확인
+
+static long nodes;
+static long node_limit;
+static uint64_t deadline_ms = 0;
+static int (*abort_fn)(void) = NULL;
+static int aborted;               // abort_fn이 1을 반환했으면 1 (vcf_set_abort 전까지 유지)
+static int stopped;               // 노드 상한이나 마감 시각을 넘기면 1 (이후 탐색은 모두 실패로 끝남)
+static vcf_result_t *result;
+
+void vcf_set_deadline(uint64_t ms) {
+    deadline_ms = ms;
+}
+
+void vcf_set_abort(int (*fn)(void)) {
+    abort_fn = fn;
+    aborted = 0;
+}
+
+int vcf_aborted() {
+    return aborted;
+}
+
+// 노드 하나를 세고 예산을 넘었는지 확인
+static int tick() {
+    nodes++;
+    if (nodes > node_limit) {
+        stopped = 1;
+    } else if ((nodes & DEADLINE_CHECK_MASK) == 0) {
+        if (deadline_ms && timer_now_ms() >= deadline_ms) stopped = 1;
+        if (abort_fn && abort_fn()) stopped = aborted = 1;
+    }
+    return stopped;
+}
+
+// (x,y)에 player가 두었을 때 네 방향 중 가장 강한 패턴 종류 (규칙 적용)
+static int best_pattern(int x, int y, int player) {
+    unsigned char pat[4];
+    board_line_patterns(x, y, player, pat);
+    int best = PAT_NONE;
+    for (int d = 0; d < 4; d++) {
+        int t = pat[d] & PAT_TYPE_MASK;
+        if (t > best) best = t;
+    }
+    return best;
+}
+
+// 위협이 여러 줄에 걸친 수(4-3, 3-3 등)를 먼저 보도록 정렬
+// 키: 줄마다 4 이상이면 2, 열린 3이면 1을 더한 값 (큰 것부터, 같으면 원래 순서)
+static void order_moves(int player, int cells[][2], int n) {
+    int keys[MAX_CELLS];
+    for (int i = 0; i < n; i++) {
+        unsigned char pat[4];
+        board_line_patterns(cells[i][0], cells[i][1], player, pat);
+        int key = 0;
+        for (int d = 0; d < 4; d++) {
+            int t = pat[d] & PAT_TYPE_MASK;
+            if (t >= PAT_FOUR) key += 2;
+            else if (t == PAT_OPEN_THREE) key += 1;
+        }
+        int x = cells[i][0], y = cells[i][1];
+        int j = i;
+        while (j > 0 && keys[j - 1] < key) {
+            keys[j] = keys[j - 1];
+            cells[j][0] = cells[j - 1][0];
+            cells[j][1] = cells[j - 1][1];
+            j--;
+        }
+        keys[j] = key;
+        cells[j][0] = x;
+        cells[j][1] = y;
+    }
+}
+
+// 위협 스캔 결과에서 player가 두면 바로 이기는 자리 (최대 max개)
+static int find_fives(const threat_map_t *m, int player, int cells[][2], int max) {
+    int n = board_get_size(), cnt = 0;
+    for (int y = 0; y < n && cnt < max; y++) {
+        for (int x = 0; x < n && cnt < max; x++) {
+            // 스캔은 "5목 이상" 기준이므로 렌주 흑의 장목은 표로 걸러냄
+            if (m->five[y][x] && best_pattern(x, y, player) == PAT_FIVE) {
+                cells[cnt][0] = x;
+                cells[cnt][1] = y;
+                cnt++;
+            }
+        }
+    }
+    return cnt;
+}
+
+// 위협 스캔 결과에서 player가 둘 수 있는 4 자리 (금수 제외, 위협이 많은 순)
+static int find_fours(const threat_map_t *m, int player, int cells[][2]) {
+    int n = board_get_size(), cnt = 0;
+    for (int y = 0; y < n; y++) {
+        for (int x = 0; x < n; x++) {
+            if (!m->four[y][x]) continue;
+            int t = best_pattern(x, y, player);
+            if ((t == PAT_FOUR || t == PAT_OPEN_FOUR) && !board_is_forbidden(x, y, player)) {
+                cells[cnt][0] = x;
+                cells[cnt][1] = y;
+                cnt++;
+            }
+        }
+    }
+    order_moves(player, cells, cnt);
+    return cnt;
+}
+
+// 방금 (x,y)에 둔 4가 만든 5목 자리: (x,y)를 지나는 네 줄에서만 찾음 (최대 max개)
+static int fives_near(int x, int y, int player, int cells[][2], int max) {
+    int cnt = 0;
+    for (int d = 0; d < 4 && cnt < max; d++) {
+        for (int off = -(WIN_LEN - 1); off <= WIN_LEN - 1 && cnt < max; off++) {
+            int nx = x + dirs[d][0] * off, ny = y + dirs[d][1] * off;
+            if (off == 0 || get_stone(nx, ny) != 0) continue;
+            if (best_pattern(nx, ny, player) != PAT_FIVE) continue;
+
+            // 두 줄이 만나는 칸은 한 번만 셈
+            int dup = 0;
+            for (int k = 0; k < cnt; k++) dup |= (cells[k][0] == nx && cells[k][1] == ny);
+            if (dup) continue;
+            cells[cnt][0] = nx;
+            cells[cnt][1] = ny;
+            cnt++;
+        }
+    }
+    return cnt;
+}
+
+// player가 둘 수 있는 열린 3 자리 (4 이상이 되는 자리와 금수 제외)
+static int find_threes(int player, int cells[][2]) {
+    int n = board_get_size(), cnt = 0;
+    for (int y = 0; y < n; y++) {
+        for (int x = 0; x < n; x++) {
+            if (get_stone(x, y) != 0) continue;
+            if (best_pattern(x, y, player) != PAT_OPEN_THREE) continue;
+            if (board_is_forbidden(x, y, player)) continue;
+            cells[cnt][0] = x;
+            cells[cnt][1] = y;
+            cnt++;
+        }
+    }
+    order_moves(player, cells, cnt);
+    return cnt;
+}
+
+// (x,y)의 열린 3을 막는 후보: 같은 줄에서 공격 측이 두면 4 이상이 되는 빈칸
+static int three_defenses(int x, int y, int att, int cells[][2]) {
+    int cnt = 0;
+    for (int d = 0; d < 4; d++) {
+        for (int off = -PAT_HALF + 1; off <= PAT_HALF - 1; off++) {
+            int nx = x + dirs[d][0] * off, ny = y + dirs[d][1] * off;
+            if (off == 0 || get_stone(nx, ny) != 0) continue;
+
+            unsigned char pat[4];
+            board_line_patterns(nx, ny, att, pat);
+            int t = pat[d] & PAT_TYPE_MASK;
+            if (t == PAT_FOUR || t == PAT_OPEN_FOUR) {
+                cells[cnt][0] = nx;
+                cells[cnt][1] = ny;
+                cnt++;
+            }
+        }
+    }
+    return cnt;
+}
+
+// 탐색 함수는 이기는 데 필요한 공격 측 수(0이면 실패)를 돌려주고, 루트에서만 첫 수를 기록
+static void record(int ply, int x, int y) {
+    if (ply != 0) return;
+    result->x = x;
+    result->y = y;
+}
+
+// 공격 측이 방금 4를 둔 뒤: 수비 측은 5목 자리를 막을 수밖에 없음
+// 반환: 1 공격 승리 확정, 0 실패, -1 막은 뒤 계속 탐색 필요 (막은 수는 판에 남아 있음)
+static int after_four(int x, int y, int att) {
+    int def = 3 - att;
+    int fives[2][2];
+    int nf = fives_near(x, y, att, fives, 2);
+    if (nf == 0) return 0;
+    if (nf >= 2) return 1;  // 5목 자리가 둘: 막을 수 없음
+
+    int bx = fives[0][0], by = fives[0][1];
+    if (board_is_forbidden(bx, by, def)) return 1;  // 렌주: 흑이 금수라 막을 수 없음
+
+    place_stone(bx, by, def);
+    if (check_win(def)) {
+        board_undo();
+        return 0;
+    }
+    return -1;
+}
+
+// 4를 하나씩 두어 보며 next로 이어 탐색 (VCF/VCT 공통, m: 공격 측 위협 스캔)
+static int try_fours(const threat_map_t *m, int att, int depth, int ply,
+                     const int threat[2][2], int nthreat, int (*next)(int, int, int)) {
+    int cells[MAX_CELLS][2];
+    int nc = find_fours(m, att, cells);
+    for (int i = 0; i < nc; i++) {
+        int x = cells[i][0], y = cells[i][1];
+        if (nthreat == 1 && (x != threat[0][0] || y != threat[0][1])) continue;
+
+        place_stone(x, y, att);
+        int win = 0;
+        int r = after_four(x, y, att);
+        if (r < 0) {
+            int sub = next(att, depth - 1, ply + 1);
+            if (sub) win = sub + 1;
+            board_undo();  // 수비 측의 막은 수
+        } else if (r) {
+            win = 2;
+        }
+        board_undo();
+
+        if (win) {
+            record(ply, x, y);
+            return win;
+        }
+        if (stopped) return 0;
+    }
+    return 0;
+}
+
+// 공격 노드 공통 준비: 양쪽 위협 스캔 후 공격 측 5목 자리와 수비 측 5목 자리 확인
+// 반환: 1 바로 5목, 0 계속 탐색, -1 수비 측 5목 자리가 둘 이상(실패)
+static int attack_prologue(threat_map_t *m, int att, int ply, int threat[2][2], int *nthreat) {
+    static threat_map_t dm;
+    board_threat_scan(att, m);
+
+    int five[1][2];
+    if (find_fives(m, att, five, 1)) {
+        record(ply, five[0][0], five[0][1]);
+        return 1;
+    }
+
+    // 상대가 5목 자리를 가지고 있으면 그 자리를 막는 위협수만 가능
+    board_threat_scan(3 - att, &dm);
+    *nthreat = find_fives(&dm, 3 - att, threat, 2);
+    return (*nthreat >= 2) ? -1 : 0;
+}
+
+static int vcf_attack(int att, int depth, int ply) {
+    if (tick()) return 0;
+
+    threat_map_t m;
+    int threat[2][2], nthreat;
+    int r = attack_prologue(&m, att, ply, threat, &nthreat);
+    if (r) return r > 0;
+    if (depth <= 0) return 0;
+
+    return try_fours(&m, att, depth, ply, threat, nthreat, vcf_attack);
+}
+
+static int vct_attack(int att, int depth, int ply) {
+    int def = 3 - att;
+
+    // VCF로 끝나면 그대로 승리 (바로 5목인 경우 포함)
+    int win = vcf_attack(att, VCT_VCF_DEPTH, ply);
+    if (win) return win;
+    if (depth <= 0 || tick()) return 0;
+
+    threat_map_t m;
+    int threat[2][2], nthreat;
+    if (attack_prologue(&m, att, ply, threat, &nthreat) < 0) return 0;
+
+    // 1) 4: 수비가 강제되므로 VCF와 같지만 이후를 VCT로 탐색
+    win = try_fours(&m, att, depth, ply, threat, nthreat, vct_attack);
+    if (win || stopped) return win;
+
+    // 2) 열린 3: 수비 측의 모든 응수(막는 자리, 자기 4)에 대해 이겨야 함
+    int cells[MAX_CELLS][2];
+    int nc = find_threes(att, cells);
+    for (int i = 0; i < nc; i++) {
+        int x = cells[i][0], y = cells[i][1];
+        if (nthreat == 1 && (x != threat[0][0] || y != threat[0][1])) continue;
+
+        place_stone(x, y, att);
+
+        // 수비 측 응수: 3을 막는 자리 + 수비 측의 4 (3을 둔 뒤의 판에서 스캔)
+        threat_map_t dm;
+        board_threat_scan(def, &dm);
+        int replies[MAX_CELLS * 2][2];
+        int nr = three_defenses(x, y, att, replies);
+        nr += find_fours(&dm, def, replies + nr);
+
+        // 예산이 다 되어 응수를 다 보지 못했으면(cut) 이긴 것으로 치지 않음
+        int worst = 0, tried = 0, cut = 0;
+        for (int k = 0; k < nr; k++) {
+            int rx = replies[k][0], ry = replies[k][1];
+            if (get_stone(rx, ry) != 0 || board_is_forbidden(rx, ry, def)) continue;
+
+            if (tick()) {
+                cut = 1;
+                break;
+            }
+            place_stone(rx, ry, def);
+            int sub = check_win(def) ? 0 : vct_attack(att, depth - 1, ply + 1);
+            board_undo();
+
+            tried++;
+            if (!sub) {
+                worst = 0;
+                break;
+            }
+            if (sub > worst) worst = sub;
+        }
+        board_undo();
+
+        if (!cut && tried > 0 && worst > 0) {
+            record(ply, x, y);
+            return worst + 1;
+        }
+        if (stopped) return 0;
+    }
+    return 0;
+}
+
+static int run(int (*attack)(int, int, int), int player, int max_depth, long max_nodes,
+               vcf_result_t *res) {
+    vcf_result_t dummy;
+    result = res ? res : &dummy;
+    result->x = result->y = -1;
+    nodes = 0;
+    node_limit = max_nodes;
+    stopped = aborted;
+    if (deadline_ms && timer_now_ms() >= deadline_ms) stopped = 1;
+
+    int depth = 0;
+    if (board_get_win_len() == WIN_LEN) depth = attack(player, max_depth, 0);
+
+    result->depth = depth;
+    result->nodes = nodes;
+    if (!depth) result->x = result->y = -1;
+    return depth > 0;
+}
+
+int vcf_search(int player, int max_depth, long max_nodes, vcf_result_t *res) {
+    return run(vcf_attack, player, max_depth, max_nodes, res);
+}
+
+int vct_search(int player, int max_depth, long max_nodes, vcf_result_t *res) {
+    return run(vct_attack, player, max_depth, max_nodes, res);
+}
@@ -0,0 +1,264 @@
+// 경로: src/wal.c
+// 역할: 선행 기록 로그와 스냅샷 구현.
+//       - 로그(omok.wal): wal_rec_t를 이어 붙인 파일 (O_APPEND)
+//       - 스냅샷(omok.snap): 머리 레코드(WAL_SNAP_HEADER, arg[0] = 레코드 수, lsn = 스냅샷 시점) 뒤에
+//         살아 있는 게임을 다시 만드는 레코드들. 머리의 lsn 이하인 로그 레코드는 이미 반영된 것
+//       - 스냅샷 교체 순서: 임시 파일 쓰기 → fsync → rename → 디렉토리 fsync → 로그 비우기
+//         (어디서 죽어도 "옛 스냅샷 + 로그" 또는 "새 스냅샷 + lsn으로 걸러지는 로그"가 남음)
+
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <limits.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include "wal.h"
+
+#define WAL_FILE  "omok.wal"
+#define SNAP_FILE "omok.snap"
+#define WAL_BUF_RECS 64            // 커밋 전 메모리에 쌓아 두는 레코드 수 (차면 바로 커밋)
+#define WAL_SNAP_HEADER 0x5353     // 스냅샷 머리 레코드 종류 (로그에는 나오지 않음)
+#define WAL_SNAP_MAGIC "OMOKSNAP1"
+
+static int wal_fd = -1;
+static char dir_path[PATH_MAX];
+static char wal_path[PATH_MAX];
+static char snap_path[PATH_MAX];
+static char tmp_path[PATH_MAX];
+
+static wal_rec_t pending[WAL_BUF_RECS];
+static int pending_n = 0;
+static off_t committed = 0;        // 로그에서 온전한 레코드가 끝나는 위치 (실패한 쓰기는 여기로 되돌림)
+static int torn = 0;               // 1이면 committed 뒤에 쓰다 만 데이터가 남아 있음
+static uint64_t last_lsn = 0;
+static long since_snapshot = 0;
+static wal_stats_t stats;
+
+// CRC-32 (IEEE, 표는 처음 쓸 때 만듦)
+static uint32_t crc_table[256];
+static int crc_ready = 0;
+
+static uint32_t crc32(const void *data, size_t len) {
+    if (!crc_ready) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            crc_table[i] = c;
+        }
+        crc_ready = 1;
+    }
+    const unsigned char *p = data;
+    uint32_t c = 0xFFFFFFFFu;
+    for (size_t i = 0; i < len; i++) c = crc_table[(c ^ p[i]) & 0xFF] ^ (c >> 8);
+    return c ^ 0xFFFFFFFFu;
+}
+
+static uint32_t rec_crc(const wal_rec_t *r) {
+    return crc32((const char *)r + offsetof(wal_rec_t, type),
+                 sizeof(wal_rec_t) - offsetof(wal_rec_t, type));
+}
+
+// len 바이트를 끝까지 씀 (실패 시 0)
+static int write_all(int fd, const void *data, size_t len) {
+    const char *p = data;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return 0;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 1;
+}
+
+// 레코드 하나를 읽음 (1: 온전한 레코드, 0: 파일 끝이거나 잘린/깨진 레코드)
+static int read_rec(int fd, wal_rec_t *r) {
+    size_t got = 0;
+    while (got < sizeof(*r)) {
+        ssize_t n = read(fd, (char *)r + got, sizeof(*r) - got);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return 0;
+        got += (size_t)n;
+    }
+    return r->crc == rec_crc(r);
+}
+
+int wal_open(const char *dir) {
+    if (snprintf(dir_path, sizeof(dir_path), "%s", dir) >= (int)sizeof(dir_path) ||
+        snprintf(wal_path, sizeof(wal_path), "%s/" WAL_FILE, dir) >= (int)sizeof(wal_path) ||
+        snprintf(snap_path, sizeof(snap_path), "%s/" SNAP_FILE, dir) >= (int)sizeof(snap_path) ||
+        snprintf(tmp_path, sizeof(tmp_path), "%s/" SNAP_FILE ".tmp", dir) >= (int)sizeof(tmp_path)) {
+        return 0;
+    }
+    if (mkdir(dir, 0755) == -1 && errno != EEXIST) return 0;
+
+    wal_fd = open(wal_path, O_RDWR | O_CREAT | O_APPEND, 0644);
+    if (wal_fd == -1) return 0;
+    memset(&stats, 0, sizeof(stats));
+    pending_n = 0;
+    committed = lseek(wal_fd, 0, SEEK_END);
+    torn = 0;
+    last_lsn = 0;
+    since_snapshot = 0;
+    return 1;
+}
+
+// 스냅샷 적용 (머리와 레코드 수, CRC가 모두 맞을 때만). 반환: 스냅샷 lsn (없거나 깨졌으면 0)
+// 깨진 스냅샷은 통째로 건너뛰므로 apply는 검사를 모두 통과한 뒤에만 부름
+static uint64_t load_snapshot(void (*apply)(const wal_rec_t *r), long *applied) {
+    int fd = open(snap_path, O_RDONLY);
+    if (fd == -1) return 0;
+
+    wal_rec_t head;
+    uint64_t lsn = 0;
+    if (read_rec(fd, &head) && head.type == WAL_SNAP_HEADER &&
+        strncmp(head.text, WAL_SNAP_MAGIC, WAL_TEXT) == 0 && head.arg[0] >= 0) {
+        long count = (long)head.arg[0];
+        wal_rec_t r;
+        long ok = 0;
+        while (ok < count && read_rec(fd, &r)) ok++;
+        if (ok == count && lseek(fd, sizeof(wal_rec_t), SEEK_SET) != -1) {
+            for (long k = 0; k < count && apply && read_rec(fd, &r); k++) {
+                apply(&r);
+                (*applied)++;
+            }
+            lsn = head.lsn;
+        }
+    }
+    close(fd);
+    return lsn;
+}
+
+long wal_recover(void (*apply)(const wal_rec_t *r)) {
+    if (wal_fd == -1) return 0;
+
+    long applied = 0;
+    uint64_t snap_lsn = load_snapshot(apply, &applied);
+    last_lsn = snap_lsn;
+
+    // 로그 꼬리 재생: 스냅샷 이후 레코드만 적용, 처음으로 깨진 레코드에서 멈추고 그 뒤를 잘라냄
+    if (lseek(wal_fd, 0, SEEK_SET) == -1) return applied;
+    off_t good = 0;
+    wal_rec_t r;
+    while (read_rec(wal_fd, &r)) {
+        if (r.lsn <= last_lsn && r.lsn > snap_lsn) break;   // 순번이 거꾸로 가면 깨진 것으로 봄
+        good += sizeof(r);
+        if (r.lsn <= snap_lsn) continue;
+        if (apply) {
+            apply(&r);
+            applied++;
+        }
+        last_lsn = r.lsn;
+    }
+    off_t end = lseek(wal_fd, 0, SEEK_END);
+    if (end > good && ftruncate(wal_fd, good) == 0) fsync(wal_fd);
+    committed = good;
+
+    stats.recovered = applied;
+    stats.lsn = last_lsn;
+    since_snapshot = (long)(good / (off_t)sizeof(wal_rec_t));
+    return applied;
+}
+
+int wal_append(wal_rec_t *r) {
+    if (wal_fd == -1) return 1;
+    if (pending_n == WAL_BUF_RECS && !wal_commit()) {
+        stats.dropped++;
+        return 0;
+    }
+
+    r->reserved = 0;
+    r->lsn = ++last_lsn;
+    r->crc = rec_crc(r);
+    pending[pending_n++] = *r;
+    stats.records++;
+    stats.lsn = last_lsn;
+    since_snapshot++;
+    return 1;
+}
+
+int wal_commit() {
+    if (wal_fd == -1 || pending_n == 0) return 1;
+
+    // 지난번 실패로 남은 조각을 먼저 치움 (그 뒤에 덧붙이면 복구 때 함께 잘려 나감)
+    if (torn) {
+        if (ftruncate(wal_fd, committed) != 0) return 0;
+        torn = 0;
+    }
+
+    size_t len = (size_t)pending_n * sizeof(wal_rec_t);
+    stats.commits++;
+    if (!write_all(wal_fd, pending, len) || fdatasync(wal_fd) != 0) {
+        // 레코드는 버퍼에 남겨 두고 다음 커밋에서 통째로 다시 씀
+        stats.failures++;
+        torn = ftruncate(wal_fd, committed) != 0;
+        return 0;
+    }
+    committed += (off_t)len;
+    pending_n = 0;
+    return 1;
+}
+
+int wal_snapshot_due() {
+    return wal_fd != -1 && since_snapshot >= WAL_SNAPSHOT_EVERY;
+}
+
+int wal_snapshot(const wal_rec_t *recs, int n) {
+    if (wal_fd == -1) return 0;
+    if (!wal_commit()) return 0;
+
+    int fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd == -1) return 0;
+
+    wal_rec_t head;
+    memset(&head, 0, sizeof(head));
+    head.type = WAL_SNAP_HEADER;
+    head.lsn = last_lsn;
+    head.arg[0] = n;
+    strncpy(head.text, WAL_SNAP_MAGIC, WAL_TEXT - 1);
+    head.crc = rec_crc(&head);
+
+    int ok = write_all(fd, &head, sizeof(head));
+    for (int k = 0; k < n && ok; k++) {
+        wal_rec_t r = recs[k];
+        r.reserved = 0;
+        r.lsn = last_lsn;
+        r.crc = rec_crc(&r);
+        ok = write_all(fd, &r, sizeof(r));
+    }
+    if (ok) ok = fsync(fd) == 0;
+    close(fd);
+    if (!ok || rename(tmp_path, snap_path) == -1) {
+        unlink(tmp_path);
+        return 0;
+    }
+
+    // rename이 디스크에 남아야 로그를 비워도 안전
+    int dfd = open(dir_path, O_RDONLY);
+    if (dfd != -1) {
+        fsync(dfd);
+        close(dfd);
+    }
+    if (ftruncate(wal_fd, 0) == 0) fsync(wal_fd);
+    committed = 0;
+    torn = 0;
+
+    since_snapshot = 0;
+    stats.snapshots++;
+    return 1;
+}
+
+void wal_get_stats(wal_stats_t *out) {
+    *out = stats;
+}
+
+void wal_close() {
+    if (wal_fd == -1) return;
+    wal_commit();
+    close(wal_fd);
+    wal_fd = -1;
+}
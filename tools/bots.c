@@ -0,0 +1,312 @@
+// 경로: tools/bots.c
+// 역할: 한 프로세스에서 봇 세션 여러 개를 돌리는 부하/AI 시험 도구 (클라이언트 라이브러리 사용).
+//       사용법: ./bots [-n 세션 수] [-g 게임 수] [-m 모드] [-l 레벨] [-s] [-a 분석 비율] [-S 시드] [-p 소켓 경로]
+//       - 세션마다 client_t 하나, 전체를 poll 한 번으로 기다림 (프로세스/스레드를 세션마다 띄우지 않음)
+//       - 서버는 판 하나만 두므로 앞 세션이 플레이어(모드 1: 봇 vs 서버 AI, 모드 2: 봇끼리),
+//         나머지는 관전자로 붙어 방송을 받음
+//       - 플레이어 봇은 마지막 수 근처의 빈칸에 무작위로 두고, 판이 끝나면 RESTART로 -g판까지 반복
+//       - -s: 플레이어 세션은 공유 메모리 전송으로 전환 (서버가 허용한 만큼)
+//       - -a: 관전자 세션이 방송된 수마다 이 확률(%)로 현재 국면의 ANALYZE를 보냄 (분석 캐시 부하)
+//       - ERR RATE_LIMITED를 받으면 잠시 쉬었다가 다시 보냄 (최대 처리량을 재려면 서버를 -L off로)
+//       - 서버가 과부하로 JOIN/MODE를 BUSY <초>로 거절하면 그만큼 기다렸다가 같은 명령을 다시 보냄
+//       - 끝나면 수 왕복 시간(MOVE 전송 → 내 MOVE 방송 수신)과 받은 줄 수를 출력
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include "client.h"
+
+#define DEFAULT_SESSIONS 100
+#define DEFAULT_GAMES    10
+#define DEFAULT_LEVEL    1
+#define NEAR_RADIUS      2     // 무작위 수는 마지막 수에서 이 거리(칸) 이내
+#define CONNECT_BATCH    64    // 한 바퀴에 새로 여는 연결 수 (서버 접속 대기열이 넘치지 않도록)
+#define RATE_BACKOFF_US  1000000  // 속도 제한에 걸리면 이만큼 쉬었다가 다시 보냄 (버킷이 다시 참)
+
+typedef struct bot {
+    client_t c;
+    int  player;              // 플레이어 세션이면 1
+    int  started;             // 연결을 시작했는지
+    int  rejected;            // 서버가 자리 없음으로 끊음
+    unsigned rs;              // 난수 상태
+    long lines;               // 받은 줄 수
+    long long sent_us;        // 마지막 MOVE를 보낸 시각 (0: 기다리는 수 없음)
+    long long retry_us;       // 속도 제한/BUSY로 이 시각 이후에 다시 보냄 (0: 없음)
+    char retry_cmd[64];       // 다시 보낼 명령 (비어 있으면 MOVE)
+} bot_t;
+
+static int games_target = DEFAULT_GAMES;
+static int mode = 1;
+static int level = DEFAULT_LEVEL;
+static int use_shm = 0;
+static int analyze_pct = 0;
+static long analyze_sent = 0, analyze_replies = 0, analyze_cached = 0;
+static long rate_limited = 0;
+static long busy_replies = 0;
+static int games_done = 0;
+static long moves_sent = 0;
+static long long rtt_sum_us = 0, rtt_max_us = 0;
+static long rtt_count = 0;
+
+static long long now_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+// 마지막 수 근처의 빈칸 하나 (못 찾으면 왼쪽 위부터 첫 빈칸). 빈칸이 없으면 0
+static int pick_move(bot_t *b, int *x, int *y) {
+    client_t *c = &b->c;
+    int n = c->size;
+    int cx = c->last_x >= 0 ? c->last_x : n / 2;
+    int cy = c->last_y >= 0 ? c->last_y : n / 2;
+    for (int tries = 0; tries < 32; tries++) {
+        int tx = cx - NEAR_RADIUS + rand_r(&b->rs) % (2 * NEAR_RADIUS + 1);
+        int ty = cy - NEAR_RADIUS + rand_r(&b->rs) % (2 * NEAR_RADIUS + 1);
+        if (tx < 0 || tx >= n || ty < 0 || ty >= n || c->board[tx][ty] != 0) continue;
+        *x = tx;
+        *y = ty;
+        return 1;
+    }
+    for (int tx = 0; tx < n; tx++) {
+        for (int ty = 0; ty < n; ty++) {
+            if (c->board[tx][ty] == 0) {
+                *x = tx;
+                *y = ty;
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+static void play(bot_t *b) {
+    int x, y;
+    if (!pick_move(b, &x, &y)) return;
+    if (client_send(&b->c, "MOVE %d %d\n", x, y)) {
+        b->sent_us = now_us();
+        moves_sent++;
+    }
+}
+
+static void on_move(client_t *c, int player, int x, int y) {
+    bot_t *b = c->user;
+    (void)x; (void)y;
+    if (!b->player && analyze_pct > 0 && rand_r(&b->rs) % 100 < (unsigned)analyze_pct &&
+        now_us() >= b->retry_us && client_send(c, "ANALYZE 5\n")) {
+        analyze_sent++;
+    }
+    if (b->player && player == c->player_id && b->sent_us) {
+        long long d = now_us() - b->sent_us;
+        rtt_sum_us += d;
+        rtt_count++;
+        if (d > rtt_max_us) rtt_max_us = d;
+        b->sent_us = 0;
+    }
+}
+
+static void on_turn(client_t *c, int player) {
+    bot_t *b = c->user;
+    if (b->player && !c->game_over && player == c->player_id) play(b);
+}
+
+static void on_game_over(client_t *c, int winner) {
+    bot_t *b = c->user;
+    (void)winner;
+    if (!b->player || c->player_id != 1) return;   // 한 판은 P1 세션이 한 번만 셈
+    games_done++;
+    if (games_done < games_target) client_send(c, "RESTART\n");
+}
+
+static void on_line(client_t *c, const char *line) {
+    bot_t *b = c->user;
+    b->lines++;
+    if (strncmp(line, "ANALYSIS ", 9) == 0) {
+        analyze_replies++;
+        if (line[9] == '1') analyze_cached++;
+    }
+    if (strcmp(line, "ERR RATE_LIMITED") == 0) {
+        rate_limited++;
+        if (!b->player) b->retry_us = now_us() + RATE_BACKOFF_US;
+        else if (b->sent_us) {
+            b->sent_us = 0;
+            b->retry_us = now_us() + RATE_BACKOFF_US;
+        }
+        return;
+    }
+    if (!b->player) return;
+    if (strncmp(line, "BUSY", 4) == 0) {
+        int sec = 1;
+        sscanf(line + 4, "%d", &sec);
+        busy_replies++;
+        if (c->player_id == 0) snprintf(b->retry_cmd, sizeof(b->retry_cmd), "JOIN bot\n");
+        else snprintf(b->retry_cmd, sizeof(b->retry_cmd), "MODE %d %d %d %d %d\n",
+                      mode, BOARD_SIZE, WIN_LEN, 0, level);
+        b->retry_us = now_us() + (long long)sec * 1000000;
+    } else if (strcmp(line, "MODE_SELECT") == 0) {
+        client_send(c, "MODE %d %d %d %d %d\n", mode, BOARD_SIZE, WIN_LEN, 0, level);
+    } else if (strncmp(line, "OK PLAYER", 9) == 0) {
+        if (use_shm) client_request_shm(c);
+    } else if (strcmp(line, "ERR INVALID_MOVE") == 0 || strcmp(line, "ERR FORBIDDEN_MOVE") == 0) {
+        b->sent_us = 0;
+        if (!c->game_over && c->turn == c->player_id) play(b);
+    } else if (strcmp(line, "ERR SERVER_FULL") == 0) {
+        b->rejected = 1;
+    }
+}
+
+static const client_callbacks_t bot_callbacks = { on_move, on_turn, on_game_over, on_line };
+
+// 세션 하나의 연결 시작 (서버 대기열이 차 있으면 0: 다음 바퀴에 다시)
+static int start_bot(bot_t *b, const char *path) {
+    if (!client_connect(&b->c, path)) {
+        if (errno == EAGAIN) return 0;
+        b->started = 1;
+        b->rejected = 1;
+        return 1;
+    }
+    b->started = 1;
+    client_send(&b->c, b->player ? "JOIN bot\n" : "SPECTATE\n");
+    return 1;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [-n sessions] [-g games] [-m mode(1: vs AI, 2: bot vs bot)] [-l level]\n"
+                    "       [-s] [-a analyze_pct] [-S seed] [-p socket_path]\n", prog);
+    exit(1);
+}
+
+int main(int argc, char *argv[]) {
+    int sessions = DEFAULT_SESSIONS;
+    unsigned seed = (unsigned)time(NULL);
+    const char *path = CLIENT_SOCK_PATH;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:g:m:l:sa:S:p:")) != -1) {
+        if (opt == 'n') sessions = atoi(optarg);
+        else if (opt == 'g') games_target = atoi(optarg);
+        else if (opt == 'm') mode = atoi(optarg);
+        else if (opt == 'l') level = atoi(optarg);
+        else if (opt == 's') use_shm = 1;
+        else if (opt == 'a') analyze_pct = atoi(optarg);
+        else if (opt == 'S') seed = (unsigned)strtoul(optarg, NULL, 10);
+        else if (opt == 'p') path = optarg;
+        else usage(argv[0]);
+    }
+    int players = (mode == 2) ? 2 : 1;
+    if (mode < 1 || mode > 2 || games_target <= 0 || sessions < players) usage(argv[0]);
+
+    // 세션마다 소켓 하나 (공유 메모리면 eventfd 둘 더): 열 수 있는 fd 수를 하드 한도까지 올림
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+
+    bot_t *bots = calloc(sessions, sizeof(bot_t));
+    struct pollfd *pfd = calloc((size_t)sessions * CLIENT_POLLFDS, sizeof(struct pollfd));
+    int *pcount = calloc(sessions, sizeof(int));
+    if (!bots || !pfd || !pcount) {
+        perror("calloc");
+        return 1;
+    }
+    for (int k = 0; k < sessions; k++) {
+        client_init(&bots[k].c, &bot_callbacks, &bots[k]);
+        bots[k].player = k < players;
+        bots[k].rs = seed + (unsigned)k;
+    }
+
+    // 플레이어 세션부터 연결 (서버는 먼저 들어온 연결에 플레이어 자리를 줌)
+    for (int k = 0; k < players; k++) {
+        if (!start_bot(&bots[k], path) || bots[k].rejected) {
+            perror("connect");
+            return 1;
+        }
+    }
+
+    long long t0 = now_us();
+    int next = players;
+    while (games_done < games_target) {
+        for (int started = 0; next < sessions && started < CONNECT_BATCH; started++) {
+            if (!start_bot(&bots[next], path)) break;
+            next++;
+        }
+
+        int total = 0, pending = 0, alive_players = 0, retrying = 0;
+        long long now = now_us();
+        for (int k = 0; k < players; k++) {
+            bot_t *b = &bots[k];
+            if (!b->retry_us) continue;
+            if (now < b->retry_us) {
+                retrying = 1;
+                continue;
+            }
+            b->retry_us = 0;
+            if (b->retry_cmd[0]) {
+                client_send(&b->c, "%s", b->retry_cmd);
+                b->retry_cmd[0] = '\0';
+            } else if (!b->c.game_over && b->c.turn == b->c.player_id) {
+                play(b);
+            }
+        }
+        for (int k = 0; k < next; k++) {
+            pcount[k] = client_pollfds(&bots[k].c, pfd + total);
+            total += pcount[k];
+            if (client_pending(&bots[k].c)) pending = 1;
+            if (bots[k].player && bots[k].c.state != CLIENT_CLOSED) alive_players++;
+        }
+        if (alive_players < players) {
+            fprintf(stderr, "player session closed by server\n");
+            break;
+        }
+
+        int wait_ms = pending ? 0 : (next < sessions || retrying ? 10 : 1000);
+        if (poll(pfd, total, wait_ms) < 0 && errno != EINTR) {
+            perror("poll");
+            break;
+        }
+        for (int k = 0, off = 0; k < next; off += pcount[k], k++) {
+            if (bots[k].c.state == CLIENT_CLOSED) continue;
+            if (!client_handle(&bots[k].c, pfd + off, pcount[k]) && !bots[k].player) bots[k].rejected = 1;
+        }
+    }
+    long long elapsed = now_us() - t0;
+
+    long spec_lines = 0;
+    int spec_ok = 0, rejected = 0;
+    for (int k = 0; k < sessions; k++) {
+        if (bots[k].rejected) rejected++;
+        else if (!bots[k].player) {
+            spec_ok++;
+            spec_lines += bots[k].lines;
+        }
+        if (bots[k].player && bots[k].c.state != CLIENT_CLOSED) client_send(&bots[k].c, "EXIT\n");
+        client_close(&bots[k].c);
+    }
+
+    printf("sessions %d (players %d, spectators %d, rejected %d)%s\n",
+           sessions, players, spec_ok, rejected, use_shm ? " shm" : "");
+    printf("games %d, moves %ld in %.2f s (%.0f moves/s)\n", games_done, moves_sent,
+           elapsed / 1e6, elapsed > 0 ? moves_sent * 1e6 / elapsed : 0.0);
+    if (rtt_count > 0) {
+        printf("move rtt avg %lld us, max %lld us (%ld samples)\n",
+               rtt_sum_us / rtt_count, rtt_max_us, rtt_count);
+    }
+    printf("spectator lines %ld (%.1f per spectator)\n", spec_lines,
+           spec_ok > 0 ? (double)spec_lines / spec_ok : 0.0);
+    if (rate_limited > 0) printf("rate limited %ld\n", rate_limited);
+    if (busy_replies > 0) printf("busy replies %ld\n", busy_replies);
+    if (analyze_pct > 0) {
+        printf("analyze sent %ld, replies %ld (%ld cached)\n",
+               analyze_sent, analyze_replies, analyze_cached);
+    }
+
+    free(bots);
+    free(pfd);
+    free(pcount);
+    return 0;
+}
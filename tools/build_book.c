@@ -0,0 +1,164 @@
+// 경로: tools/build_book.c
+// 역할: 기록된 게임으로 오프닝 북 파일을 만드는 도구.
+//       사용법: ./build_book [-p 최대 수순] [-m 최소 승수] 북파일 기록파일...
+//       - 각 게임의 앞 수순을 다시 두어 보며, 이긴 쪽이 둔 수를 (국면 해시, 수)로 셈
+//       - 판의 대칭 8가지로 돌려 같은 게임을 8번 넣으므로 회전/뒤집힌 국면도 찾을 수 있음
+//       - 국면마다 가장 많이 이긴 수 하나만 남기고 해시 순으로 정렬해 기록
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "board.h"
+#include "book.h"
+
+#define DEFAULT_MAX_PLY    12
+#define DEFAULT_MIN_WEIGHT 1
+
+static book_entry_t *items = NULL;
+static size_t item_count = 0, item_cap = 0;
+
+static void add_item(uint64_t hash, int x, int y) {
+    if (item_count == item_cap) {
+        item_cap = item_cap ? item_cap * 2 : 4096;
+        items = realloc(items, item_cap * sizeof(*items));
+        if (!items) {
+            perror("realloc");
+            exit(EXIT_FAILURE);
+        }
+    }
+    book_entry_t *e = &items[item_count++];
+    memset(e, 0, sizeof(*e));
+    e->hash = hash;
+    e->x = (uint8_t)x;
+    e->y = (uint8_t)y;
+    e->weight = 1;
+}
+
+// 대칭 변환 sym(0..7): bit0 x/y 맞바꿈, bit1 x 뒤집기, bit2 y 뒤집기
+static void transform(int sym, int n, int x, int y, int *tx, int *ty) {
+    if (sym & 1) { int t = x; x = y; y = t; }
+    if (sym & 2) x = n - 1 - x;
+    if (sym & 4) y = n - 1 - y;
+    *tx = x;
+    *ty = y;
+}
+
+// 기록 한 줄 처리 (형식이 맞지 않으면 0)
+static int add_game(char *line, int max_ply) {
+    int size, win, rule, winner, off;
+    if (sscanf(line, BOOK_RECORD_PREFIX " %d %d %d %d%n", &size, &win, &rule, &winner, &off) != 4) return 0;
+    if (winner != 1 && winner != 2) return 1;   // 무승부는 배울 수가 없음
+
+    int variant = board_find_variant(size, win);
+    if (variant < 0) return 0;
+
+    int moves[BOARD_MAX * BOARD_MAX][2];
+    int nmoves = 0;
+    for (char *tok = strtok(line + off, " \t\r\n"); tok && nmoves < max_ply;
+         tok = strtok(NULL, " \t\r\n")) {
+        if (sscanf(tok, "%d,%d", &moves[nmoves][0], &moves[nmoves][1]) != 2) return 0;
+        nmoves++;
+    }
+
+    for (int sym = 0; sym < 8; sym++) {
+        board_set_variant(variant);
+        if (!board_set_rule(rule)) return 0;
+        init_board();
+
+        for (int i = 0; i < nmoves; i++) {
+            int player = (i % 2 == 0) ? 1 : 2;
+            int x, y;
+            transform(sym, size, moves[i][0], moves[i][1], &x, &y);
+            if (player == winner) add_item(board_hash(), x, y);
+            if (!place_stone(x, y, player)) return 0;
+        }
+    }
+    return 1;
+}
+
+static int cmp_item(const void *a, const void *b) {
+    const book_entry_t *p = a, *q = b;
+    if (p->hash != q->hash) return p->hash < q->hash ? -1 : 1;
+    if (p->y != q->y) return p->y - q->y;
+    return p->x - q->x;
+}
+
+// 같은 (해시, 수)를 합치고, 해시마다 승수가 가장 큰 수 하나만 남김
+static size_t reduce(uint32_t min_weight) {
+    qsort(items, item_count, sizeof(*items), cmp_item);
+
+    size_t out = 0;
+    size_t i = 0;
+    while (i < item_count) {
+        book_entry_t best = items[i];
+        best.weight = 0;
+        size_t j = i;
+        while (j < item_count && items[j].hash == items[i].hash) {
+            book_entry_t cur = items[j];
+            cur.weight = 0;
+            while (j < item_count && cmp_item(&items[j], &cur) == 0) {
+                cur.weight += items[j].weight;
+                j++;
+            }
+            if (cur.weight > best.weight) best = cur;
+        }
+        if (best.weight >= min_weight) items[out++] = best;
+        i = j;
+    }
+    return out;
+}
+
+int main(int argc, char *argv[]) {
+    int max_ply = DEFAULT_MAX_PLY;
+    int min_weight = DEFAULT_MIN_WEIGHT;
+    int opt;
+    while ((opt = getopt(argc, argv, "p:m:")) != -1) {
+        if (opt == 'p') max_ply = atoi(optarg);
+        else if (opt == 'm') min_weight = atoi(optarg);
+        else break;
+    }
+    if (argc - optind < 2 || max_ply <= 0 || min_weight <= 0) {
+        fprintf(stderr, "Usage: %s [-p max_ply] [-m min_weight] book_file record_file...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (max_ply > BOARD_MAX * BOARD_MAX) max_ply = BOARD_MAX * BOARD_MAX;
+
+    int games = 0, bad = 0;
+    for (int a = optind + 1; a < argc; a++) {
+        FILE *fp = fopen(argv[a], "r");
+        if (!fp) {
+            perror(argv[a]);
+            return EXIT_FAILURE;
+        }
+        char line[8192];
+        while (fgets(line, sizeof(line), fp)) {
+            if (strncmp(line, BOOK_RECORD_PREFIX, strlen(BOOK_RECORD_PREFIX)) != 0) continue;
+            if (add_game(line, max_ply)) games++;
+            else bad++;
+        }
+        fclose(fp);
+    }
+
+    size_t count = reduce((uint32_t)min_weight);
+
+    FILE *out = fopen(argv[optind], "wb");
+    if (!out) {
+        perror(argv[optind]);
+        return EXIT_FAILURE;
+    }
+    book_header_t h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, BOOK_MAGIC, sizeof(h.magic));
+    h.version = BOOK_VERSION;
+    h.count = (uint32_t)count;
+    if (fwrite(&h, sizeof(h), 1, out) != 1 ||
+        fwrite(items, sizeof(*items), count, out) != count || fclose(out) != 0) {
+        perror(argv[optind]);
+        return EXIT_FAILURE;
+    }
+
+    printf("%d games (%d skipped), %zu positions -> %s\n", games, bad, count, argv[optind]);
+    free(items);
+    return 0;
+}
@@ -0,0 +1,31 @@
+// 경로: tools/gen_patterns.c
+// 역할: 라인 패턴 표를 계산해 C 소스(src/pattern_table.c)로 출력하는 빌드용 생성기.
+//       사용법: ./gen_patterns > src/pattern_table.c
+
+#include <stdio.h>
+#include "pattern.h"
+
+static unsigned char table_free[PAT_TABLE_SIZE];
+static unsigned char table_exact[PAT_TABLE_SIZE];
+
+// 문자열 리터럴(8진 이스케이프)로 출력: 숫자 배열 초기화보다 컴파일이 훨씬 빠름
+// 배열 크기가 리터럴 길이와 같으므로 끝의 NUL은 들어가지 않음 (C에서 허용)
+static void emit(const char *name, const unsigned char *table) {
+    printf("const unsigned char %s[PAT_TABLE_SIZE] =\n\"", name);
+    for (int i = 0; i < PAT_TABLE_SIZE; i++) {
+        printf("\\%o", table[i]);
+        if (i % 64 == 63 && i + 1 < PAT_TABLE_SIZE) printf("\"\n\"");
+    }
+    printf("\";\n\n");
+}
+
+int main() {
+    pattern_build(table_free, 0);
+    pattern_build(table_exact, 1);
+
+    printf("// 자동 생성 파일 (tools/gen_patterns.c) - 직접 수정하지 말 것\n\n");
+    printf("#include \"pattern.h\"\n\n");
+    emit("pattern_free", table_free);
+    emit("pattern_exact", table_exact);
+    return 0;
+}
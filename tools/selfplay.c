@@ -0,0 +1,315 @@
+// 경로: tools/selfplay.c
+// 역할: AI끼리 두는 대량 자기 대국 도구 (평가 가중치 조정과 강도/속도 회귀 확인용).
+//       사용법: ./selfplay [-n 게임 수] [-j 프로세스 수] [-l 레벨] [-s 판 크기] [-w 승리 길이]
+//                          [-r 규칙] [-x 무작위 시작 수] [-S 시드] [-A 가중치] [-B 가중치] [-o 기록 파일]
+//                 ./selfplay -K 판 수 [-s 판 크기] [-S 시드]   (위협 스캔 커널 검증, make check)
+//       - 판 모듈(board.c)은 전역 상태 하나뿐이므로 프로세스를 -j개 띄워 각자 자기 판으로 둠
+//       - 두 게임씩 같은 무작위 시작 수로 A/B의 흑백만 바꿔 두어 선후 유불리를 상쇄
+//       - 가중치는 "키=값,..." 형식으로 기본값(ai_eval_default)의 일부만 바꿈 (ai.h 참고)
+//       - 기록은 서버 -r과 같은 형식이라 build_book의 입력으로도 쓸 수 있음
+//       - -K: 무작위 판마다 이 CPU에서 쓸 수 있는 위협 스캔 커널(스칼라/SSE2/AVX2)의 결과가
+//         서로 같고 패턴 표(pattern_free)의 5목/4 판정과도 같은지 확인 (다르면 실패 종료)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "ai.h"
+#include "board.h"
+#include "book.h"
+#include "pattern.h"
+#include "timer.h"
+
+#define DEFAULT_GAMES        1000
+#define DEFAULT_LEVEL        AI_LEVEL_MIN
+#define DEFAULT_OPENING      4     // 무작위로 두는 시작 수 (같은 게임만 반복되지 않도록)
+#define OPENING_RADIUS       3     // 무작위 시작 수는 중앙에서 이 거리(칸) 이내
+
+typedef struct selfplay_opts {
+    int games, jobs, level;
+    int size, win, rule;
+    int opening;
+    unsigned seed;
+    ai_eval_t eval[2];   // [0]: A, [1]: B
+} selfplay_opts_t;
+
+// 무작위 시작 수 하나 (중앙 근처 빈칸 중 player에게 금수가 아닌 곳, 못 찾으면 0)
+static int random_move(unsigned *rs, int player, int *x, int *y) {
+    int n = board_get_size();
+    int c = (n - 1) / 2;
+    for (int tries = 0; tries < 64; tries++) {
+        int tx = c - OPENING_RADIUS + rand_r(rs) % (2 * OPENING_RADIUS + 1);
+        int ty = c - OPENING_RADIUS + rand_r(rs) % (2 * OPENING_RADIUS + 1);
+        if (get_stone(tx, ty) != 0 || board_is_forbidden(tx, ty, player)) continue;
+        *x = tx;
+        *y = ty;
+        return 1;
+    }
+    return 0;
+}
+
+// 게임 g 한 판을 두고 기록 한 줄을 line에 씀 ("<A의 플레이어> GAME ...\n")
+// 반환: 줄 길이
+static int play_game(const selfplay_opts_t *o, int g, char *line, size_t cap) {
+    int a_player = (g % 2 == 0) ? 1 : 2;
+    unsigned rs = o->seed + (unsigned)(g / 2);
+
+    board_set_variant(board_find_variant(o->size, o->win));
+    board_set_rule(o->rule);
+    init_board();
+
+    int n = board_get_size();
+    int winner = 0, hx = -1, hy = -1;
+    for (int ply = 0; ply < n * n; ply++) {
+        int p = (ply % 2 == 0) ? 1 : 2;
+        int x = -1, y = -1;
+        if (ply >= o->opening || !random_move(&rs, p, &x, &y)) {
+            const ai_eval_t *E = &o->eval[p == a_player ? 0 : 1];
+            ai_choose_move(&ai_levels[o->level], E, p, hx, hy, &x, &y);
+        }
+        // 렌주룰의 흑 금수는 place_stone이 막지 않으므로 서버의 MOVE처럼 먼저 거절
+        if (board_is_forbidden(x, y, p) || !place_stone(x, y, p)) {
+            // 고른 수가 잘못된 경우: 왼쪽 위부터 둘 수 있는 첫 칸 (서버의 안전 장치와 같음)
+            int placed = 0;
+            for (int yy = 0; yy < n && !placed; yy++) {
+                for (int xx = 0; xx < n && !placed; xx++) {
+                    if (!board_is_forbidden(xx, yy, p) && place_stone(xx, yy, p)) {
+                        x = xx;
+                        y = yy;
+                        placed = 1;
+                    }
+                }
+            }
+            if (!placed) break;
+        }
+        hx = x;
+        hy = y;
+        if (check_win(p)) {
+            winner = p;
+            break;
+        }
+    }
+
+    int len = snprintf(line, cap, "%d " BOOK_RECORD_PREFIX " %d %d %d %d",
+                       a_player, o->size, o->win, o->rule, winner);
+    int x, y, p;
+    for (int k = 0; board_get_move(k, &x, &y, &p) && len < (int)cap; k++) {
+        len += snprintf(line + len, cap - len, " %d,%d", x, y);
+    }
+    if (len >= (int)cap - 1) return 0;   // 판이 커서 한 줄에 담지 못한 게임은 버림
+    line[len++] = '\n';
+    return len;
+}
+
+// 작업 프로세스: 게임 번호 w, w+jobs, ... 를 두고 한 줄씩 파이프에 씀
+// (PIPE_BUF 이하 write는 원자적이라 여러 프로세스의 줄이 섞이지 않음)
+static void worker(const selfplay_opts_t *o, int w, int fd) {
+    char line[PIPE_BUF];
+    for (int g = w; g < o->games; g += o->jobs) {
+        int len = play_game(o, g, line, sizeof(line));
+        if (len > 0 && write(fd, line, len) != len) break;
+    }
+    close(fd);
+    _exit(0);
+}
+
+// 위협 스캔 결과를 패턴 표와 비교 (표의 5목 → five 비트, 4/열린 4 → four 비트, 돌이 있는 칸은 0)
+// 반환: 어긋난 칸 수 (처음 몇 개는 출력)
+static long check_against_table(const threat_map_t *m, int player, long reported) {
+    int n = board_get_size();
+    long bad = 0;
+    for (int y = 0; y < n; y++) {
+        for (int x = 0; x < n; x++) {
+            int five = 0, four = 0;
+            if (get_stone(x, y) == 0) {
+                for (int d = 0; d < 4; d++) {
+                    int t = pattern_free[board_line_index(x, y, d, player)] & PAT_TYPE_MASK;
+                    if (t == PAT_FIVE) five |= 1 << d;
+                    else if (t == PAT_FOUR || t == PAT_OPEN_FOUR) four |= 1 << d;
+                }
+            }
+            if (m->five[y][x] == five && m->four[y][x] == four) continue;
+            if (reported + bad < 10) {
+                fprintf(stderr, "table mismatch: P%d (%d,%d) five %x/%x four %x/%x\n",
+                        player, x, y, m->five[y][x], five, m->four[y][x], four);
+            }
+            bad++;
+        }
+    }
+    return bad;
+}
+
+// -K: 무작위 판 boards개로 위협 스캔 커널 검증 (성공 0, 어긋나면 EXIT_FAILURE)
+static int check_threat_kernels(int boards, int size, unsigned seed) {
+    static const char *names[] = { "scalar", "sse2", "avx2" };
+    int variant = board_find_variant(size, WIN_LEN);
+    if (variant < 0) {
+        fprintf(stderr, "Threat scan needs a %d-in-a-row variant: %dx%d\n", WIN_LEN, size, size);
+        return EXIT_FAILURE;
+    }
+
+    int impls[3], nimpl = 0;
+    for (int i = THREAT_IMPL_SCALAR; i <= THREAT_IMPL_AVX2; i++) {
+        if (board_threat_set_impl(i)) impls[nimpl++] = i;
+    }
+
+    unsigned rs = seed;
+    long cells = 0, bad = 0;
+    for (int b = 0; b < boards; b++) {
+        board_set_variant(variant);
+        board_set_rule(RULE_FREESTYLE);
+        init_board();
+        int n = board_get_size();
+        int stones = rand_r(&rs) % (n * n / 2 + 1);
+        for (int k = 0; k < stones; k++) {
+            place_stone(rand_r(&rs) % n, rand_r(&rs) % n, 1 + rand_r(&rs) % 2);
+        }
+
+        for (int p = 1; p <= 2; p++) {
+            threat_map_t ref, m;
+            board_threat_set_impl(impls[0]);
+            board_threat_scan(p, &ref);
+            bad += check_against_table(&ref, p, bad);
+            for (int i = 1; i < nimpl; i++) {
+                board_threat_set_impl(impls[i]);
+                board_threat_scan(p, &m);
+                if (memcmp(&m, &ref, sizeof(m)) == 0) continue;
+                if (bad < 10) fprintf(stderr, "kernel mismatch: %s vs %s, board %d P%d\n",
+                                      names[impls[i]], names[impls[0]], b, p);
+                bad++;
+            }
+            cells += n * n;
+        }
+    }
+
+    printf("threat scan check: %d boards %dx%d, kernels", boards, size, size);
+    for (int i = 0; i < nimpl; i++) printf(" %s", names[impls[i]]);
+    printf(", %ld cells: %ld mismatches\n", cells, bad);
+    return bad == 0 ? 0 : EXIT_FAILURE;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [-n games] [-j jobs] [-l level] [-s size] [-w win_len] [-r rule]\n"
+                    "       [-x opening_plies] [-S seed] [-A eval] [-B eval] [-o record_file]\n"
+                    "       %s -K boards [-s size] [-S seed]   (threat scan kernel check)\n"
+                    "  eval: key=value,... (two open_two three open_three four open_four\n"
+                    "        combo_four combo_three block center near)\n", prog, prog);
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char *argv[]) {
+    selfplay_opts_t o;
+    o.games = DEFAULT_GAMES;
+    o.jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    o.level = DEFAULT_LEVEL;
+    o.size = BOARD_SIZE;
+    o.win = WIN_LEN;
+    o.rule = RULE_FREESTYLE;
+    o.opening = DEFAULT_OPENING;
+    o.seed = 1;
+    o.eval[0] = o.eval[1] = ai_eval_default;
+    const char *record_path = NULL;
+    int check_boards = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:j:l:s:w:r:x:S:A:B:o:K:")) != -1) {
+        if (opt == 'n') o.games = atoi(optarg);
+        else if (opt == 'j') o.jobs = atoi(optarg);
+        else if (opt == 'l') o.level = atoi(optarg);
+        else if (opt == 's') o.size = atoi(optarg);
+        else if (opt == 'w') o.win = atoi(optarg);
+        else if (opt == 'r') o.rule = atoi(optarg);
+        else if (opt == 'x') o.opening = atoi(optarg);
+        else if (opt == 'S') o.seed = (unsigned)strtoul(optarg, NULL, 10);
+        else if (opt == 'A' || opt == 'B') {
+            if (!ai_eval_parse(&o.eval[opt == 'A' ? 0 : 1], optarg)) {
+                fprintf(stderr, "Bad eval spec: %s\n", optarg);
+                usage(argv[0]);
+            }
+        } else if (opt == 'o') record_path = optarg;
+        else if (opt == 'K') {
+            check_boards = atoi(optarg);
+            if (check_boards <= 0) usage(argv[0]);
+        } else usage(argv[0]);
+    }
+    if (check_boards > 0) return check_threat_kernels(check_boards, o.size, o.seed);
+    if (o.games <= 0 || o.opening < 0 || o.level < AI_LEVEL_MIN || o.level > AI_LEVEL_MAX) usage(argv[0]);
+    if (o.jobs <= 0) o.jobs = 1;
+    if (o.jobs > o.games) o.jobs = o.games;
+
+    int variant = board_find_variant(o.size, o.win);
+    if (variant < 0 || !board_set_variant(variant) || !board_set_rule(o.rule)) {
+        fprintf(stderr, "Unsupported variant/rule: %dx%d/%d rule %d\n", o.size, o.size, o.win, o.rule);
+        return EXIT_FAILURE;
+    }
+
+    FILE *rec = NULL;
+    if (record_path) {
+        rec = fopen(record_path, "w");
+        if (!rec) {
+            perror(record_path);
+            return EXIT_FAILURE;
+        }
+    }
+
+    int pfd[2];
+    if (pipe(pfd) < 0) {
+        perror("pipe");
+        return EXIT_FAILURE;
+    }
+
+    uint64_t start = timer_now_ms();
+    for (int w = 0; w < o.jobs; w++) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            return EXIT_FAILURE;
+        }
+        if (pid == 0) {
+            close(pfd[0]);
+            worker(&o, w, pfd[1]);
+        }
+    }
+    close(pfd[1]);
+
+    // 결과 집계: [A의 플레이어 - 1][승자(0: 무승부, 1: A, 2: B)]
+    long tally[2][3] = { { 0 } };
+    long games = 0, plies = 0;
+    FILE *in = fdopen(pfd[0], "r");
+    char line[PIPE_BUF + 1];
+    while (in && fgets(line, sizeof(line), in)) {
+        int a_player, size, win, rule, winner, off;
+        if (sscanf(line, "%d " BOOK_RECORD_PREFIX " %d %d %d %d%n",
+                   &a_player, &size, &win, &rule, &winner, &off) != 5 ||
+            (a_player != 1 && a_player != 2)) {
+            continue;
+        }
+        int result = winner == 0 ? 0 : (winner == a_player ? 1 : 2);
+        tally[a_player - 1][result]++;
+        games++;
+        for (char *c = line + off; *c; c++) plies += (*c == ',');
+        if (rec) fputs(strchr(line, ' ') + 1, rec);
+    }
+    if (in) fclose(in);
+    while (wait(NULL) > 0) {}
+    if (rec) fclose(rec);
+
+    double sec = (double)(timer_now_ms() - start) / 1000.0;
+    if (sec <= 0) sec = 0.001;
+    long a_wins = tally[0][1] + tally[1][1];
+    long b_wins = tally[0][2] + tally[1][2];
+    long draws  = tally[0][0] + tally[1][0];
+
+    printf("%ld games, %d jobs, level %s, %dx%d/%d rule %d: %.2f s (%.1f games/s, %.0f moves/s)\n",
+           games, o.jobs, ai_levels[o.level].name, o.size, o.size, o.win, o.rule,
+           sec, games / sec, plies / sec);
+    if (games > 0) {
+        printf("A wins %ld (%.1f%%), B wins %ld (%.1f%%), draws %ld\n",
+               a_wins, 100.0 * a_wins / games, b_wins, 100.0 * b_wins / games, draws);
+        printf("A as P1: %ld-%ld-%ld, A as P2: %ld-%ld-%ld (W-L-D)\n",
+               tally[0][1], tally[0][2], tally[0][0], tally[1][1], tally[1][2], tally[1][0]);
+    }
+    return games == o.games ? 0 : EXIT_FAILURE;
+}